@@ -23,6 +23,7 @@ JPG_LIBRARY_PATH := external/jpeg
 # Enable this if you want to support loading JPEG-XL images
 # The library path should be a relative path to this directory.
 SUPPORT_JXL ?= false
+SUPPORT_SAVE_JXL ?= false
 JXL_LIBRARY_PATH := external/libjxl
 
 # Enable this if you want to support loading PNG images using libpng
@@ -142,6 +143,11 @@ ifeq ($(SUPPORT_JXL),true)
                         $(LOCAL_PATH)/$(JXL_LIBRARY_PATH)/android
     LOCAL_CFLAGS += -DLOAD_JXL
     LOCAL_STATIC_LIBRARIES += jxl
+ifeq ($(SUPPORT_SAVE_JXL),true)
+    LOCAL_CFLAGS += -DSAVE_JXL=1
+else
+    LOCAL_CFLAGS += -DSAVE_JXL=0
+endif
 endif
 
 ifeq ($(SUPPORT_PNG),true)
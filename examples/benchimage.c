@@ -0,0 +1,401 @@
+/*
+  benchimage:  A benchmark program for the SDL image loading library.
+  Copyright (C) 1997-2026 Sam Lantinga <slouken@libsdl.org>
+
+  This software is provided 'as-is', without any express or implied
+  warranty.  In no event will the authors be held liable for any damages
+  arising from the use of this software.
+
+  Permission is granted to anyone to use this software for any purpose,
+  including commercial applications, and to alter it and redistribute it
+  freely, subject to the following restrictions:
+
+  1. The origin of this software must not be misrepresented; you must not
+     claim that you wrote the original software. If you use this software
+     in a product, an acknowledgment in the product documentation would be
+     appreciated but is not required.
+  2. Altered source versions must be plainly marked as such, and must not be
+     misrepresented as being the original software.
+  3. This notice may not be removed or altered from any source distribution.
+*/
+
+#include <SDL3/SDL.h>
+#include <SDL3/SDL_main.h>
+#include <SDL3_image/SDL_image.h>
+
+/* The image file is read into memory once, so only decoding is measured.
+ * The save modes load it once into a surface and save that to memory.
+ */
+typedef struct
+{
+    const void *data;
+    size_t size;
+    int width;
+    int height;
+    int threads;
+    int quality;
+    IMG_SVGDocument *document;
+    SDL_Surface *surface;
+    Sint64 saved_size;
+    Uint64 best_time;
+} BenchContext;
+
+typedef bool (*BenchFunction)(BenchContext *ctx);
+
+/* Run a function repeatedly and log the fastest and the average time.
+ * The fastest time is also kept in the context, in nanoseconds.
+ */
+static bool run_timed(const char *name, BenchFunction func, BenchContext *ctx, int iterations)
+{
+    Uint64 best = ~(Uint64)0;
+    Uint64 total = 0;
+    int i;
+
+    for (i = 0; i < iterations; ++i) {
+        Uint64 start = SDL_GetTicksNS();
+        Uint64 elapsed;
+
+        if (!func(ctx)) {
+            SDL_Log("%s failed: %s\n", name, SDL_GetError());
+            return false;
+        }
+        elapsed = SDL_GetTicksNS() - start;
+        total += elapsed;
+        if (elapsed < best) {
+            best = elapsed;
+        }
+    }
+    SDL_Log("%-28s best %9.3f ms, average %9.3f ms\n", name,
+            (double)best / SDL_NS_PER_MS, (double)total / iterations / SDL_NS_PER_MS);
+    ctx->best_time = best;
+    return true;
+}
+
+static bool load_image(BenchContext *ctx)
+{
+    SDL_PropertiesID props = SDL_CreateProperties();
+    SDL_Surface *surface;
+
+    if (!props) {
+        return false;
+    }
+    SDL_SetPointerProperty(props, IMG_PROP_LOAD_IOSTREAM_POINTER, SDL_IOFromConstMem(ctx->data, ctx->size));
+    SDL_SetBooleanProperty(props, IMG_PROP_LOAD_IOSTREAM_AUTOCLOSE_BOOLEAN, true);
+    if (ctx->width > 0) {
+        SDL_SetNumberProperty(props, IMG_PROP_LOAD_WIDTH_NUMBER, ctx->width);
+    }
+    if (ctx->height > 0) {
+        SDL_SetNumberProperty(props, IMG_PROP_LOAD_HEIGHT_NUMBER, ctx->height);
+    }
+    if (ctx->threads > 0) {
+        SDL_SetNumberProperty(props, IMG_PROP_LOAD_MAX_THREADS_NUMBER, ctx->threads);
+    }
+    surface = IMG_LoadWithProperties(props);
+    SDL_DestroyProperties(props);
+    if (!surface) {
+        return false;
+    }
+    SDL_DestroySurface(surface);
+    return true;
+}
+
+/* Load the image file as the surface for the save modes, converted to the given format */
+static bool load_source_surface(BenchContext *ctx, SDL_PixelFormat format)
+{
+    SDL_Surface *surface = IMG_Load_IO(SDL_IOFromConstMem(ctx->data, ctx->size), true);
+
+    if (!surface) {
+        SDL_Log("Couldn't load image: %s\n", SDL_GetError());
+        return false;
+    }
+    if (format != SDL_PIXELFORMAT_UNKNOWN && surface->format != format) {
+        SDL_Surface *converted = SDL_ConvertSurface(surface, format);
+
+        SDL_DestroySurface(surface);
+        if (!converted) {
+            SDL_Log("Couldn't convert image to %s: %s\n", SDL_GetPixelFormatName(format), SDL_GetError());
+            return false;
+        }
+        surface = converted;
+    }
+    SDL_DestroySurface(ctx->surface);
+    ctx->surface = surface;
+    return true;
+}
+
+static bool save_image(BenchContext *ctx, const char *type)
+{
+    SDL_PropertiesID props = SDL_CreateProperties();
+    SDL_IOStream *dst = SDL_IOFromDynamicMem();
+    bool result = false;
+
+    if (props && dst) {
+        SDL_SetPointerProperty(props, IMG_PROP_SAVE_IOSTREAM_POINTER, dst);
+        SDL_SetStringProperty(props, IMG_PROP_SAVE_TYPE_STRING, type);
+        SDL_SetNumberProperty(props, IMG_PROP_SAVE_QUALITY_NUMBER, ctx->quality);
+        if (ctx->threads > 0) {
+            SDL_SetNumberProperty(props, IMG_PROP_SAVE_MAX_THREADS_NUMBER, ctx->threads);
+        }
+        result = IMG_SaveWithProperties(ctx->surface, props);
+        ctx->saved_size = SDL_TellIO(dst);
+    }
+    if (dst) {
+        SDL_CloseIO(dst);
+    }
+    SDL_DestroyProperties(props);
+    return result;
+}
+
+static bool save_jpg(BenchContext *ctx)
+{
+    return save_image(ctx, "jpg");
+}
+
+/* Saving a JPG image from 24-bit and from 32-bit RGB. This measures the tinyjpeg
+ * encoder unless SDL_image was built with a hard dependency on libjpeg.
+ */
+static bool bench_jpg_save(BenchContext *ctx, int iterations)
+{
+    static const SDL_PixelFormat formats[] = { SDL_PIXELFORMAT_RGB24, SDL_PIXELFORMAT_XRGB8888 };
+    char name[64];
+    size_t i;
+
+    for (i = 0; i < SDL_arraysize(formats); ++i) {
+        if (!load_source_surface(ctx, formats[i])) {
+            return false;
+        }
+        SDL_snprintf(name, sizeof(name), "save JPG from %s", SDL_GetPixelFormatName(formats[i]) + SDL_strlen("SDL_PIXELFORMAT_"));
+        if (!run_timed(name, save_jpg, ctx, iterations)) {
+            return false;
+        }
+        SDL_Log("%-28s %d x %d pixels, %" SDL_PRIs64 " bytes\n", "", ctx->surface->w, ctx->surface->h, ctx->saved_size);
+    }
+    return true;
+}
+
+static bool save_avif(BenchContext *ctx)
+{
+    return save_image(ctx, "avif");
+}
+
+/* Saving an AVIF image as loaded. With -threads the encoder may also split it into more tiles. */
+static bool bench_avif_save(BenchContext *ctx, int iterations)
+{
+    if (!load_source_surface(ctx, SDL_PIXELFORMAT_UNKNOWN) ||
+        !run_timed("save AVIF", save_avif, ctx, iterations)) {
+        return false;
+    }
+    SDL_Log("%-28s %d x %d pixels, quality %d, %" SDL_PRIs64 " bytes\n", "", ctx->surface->w, ctx->surface->h, ctx->quality, ctx->saved_size);
+    return true;
+}
+
+/* Saving an AVIF image from RGB, which libavif converts to YUV, and from a YUV 4:2:0
+ * surface, which is handed to libavif without conversion. The difference between the
+ * two is the cost of the RGB to YUV step.
+ */
+static bool bench_avif_yuv(BenchContext *ctx, int iterations)
+{
+    Uint64 rgb_time;
+    Uint64 yuv_time;
+
+    if (!load_source_surface(ctx, SDL_PIXELFORMAT_RGBX32) ||
+        !run_timed("save AVIF from RGBX32", save_avif, ctx, iterations)) {
+        return false;
+    }
+    rgb_time = ctx->best_time;
+    SDL_Log("%-28s %.2f fps, %" SDL_PRIs64 " bytes\n", "", (double)SDL_NS_PER_SECOND / rgb_time, ctx->saved_size);
+
+    if (!load_source_surface(ctx, SDL_PIXELFORMAT_IYUV) ||
+        !run_timed("save AVIF from IYUV", save_avif, ctx, iterations)) {
+        return false;
+    }
+    yuv_time = ctx->best_time;
+    SDL_Log("%-28s %.2f fps, %" SDL_PRIs64 " bytes\n", "", (double)SDL_NS_PER_SECOND / yuv_time, ctx->saved_size);
+
+    SDL_Log("%-28s %9.3f ms per frame\n", "RGB to YUV conversion", ((double)rgb_time - (double)yuv_time) / SDL_NS_PER_MS);
+    return true;
+}
+
+/* Loading an image of any format, e.g. XCF images with their tiles decoded on several threads */
+static bool bench_load(BenchContext *ctx, int iterations)
+{
+    return run_timed("load image", load_image, ctx, iterations);
+}
+
+static bool load_sized_svg(BenchContext *ctx)
+{
+    SDL_IOStream *src = SDL_IOFromConstMem(ctx->data, ctx->size);
+    SDL_Surface *surface;
+
+    if (!src) {
+        return false;
+    }
+    surface = IMG_LoadSizedSVG_IO(src, ctx->width, ctx->height);
+    SDL_CloseIO(src);
+    if (!surface) {
+        return false;
+    }
+    SDL_DestroySurface(surface);
+    return true;
+}
+
+static bool rasterize_svg_document(BenchContext *ctx)
+{
+    SDL_Surface *surface = IMG_RasterizeSVG(ctx->document, ctx->width, ctx->height);
+
+    if (!surface) {
+        return false;
+    }
+    SDL_DestroySurface(surface);
+    return true;
+}
+
+static bool parse_svg_document(BenchContext *ctx)
+{
+    ctx->document = IMG_LoadSVGDocument_IO(SDL_IOFromConstMem(ctx->data, ctx->size), true);
+    return ctx->document != NULL;
+}
+
+static bool parse_and_free_svg_document(BenchContext *ctx)
+{
+    if (!parse_svg_document(ctx)) {
+        return false;
+    }
+    IMG_FreeSVGDocument(ctx->document);
+    ctx->document = NULL;
+    return true;
+}
+
+/* Parsing an SVG document without rasterizing it */
+static bool bench_svg_parse(BenchContext *ctx, int iterations)
+{
+    return run_timed("parse SVG", parse_and_free_svg_document, ctx, iterations);
+}
+
+/* Loading an SVG image for each size, compared to parsing it once and rasterizing the document */
+static bool bench_svg_document(BenchContext *ctx, int iterations)
+{
+    bool result;
+
+    if (!run_timed("load sized SVG", load_sized_svg, ctx, iterations)) {
+        return false;
+    }
+
+    if (!parse_svg_document(ctx)) {
+        SDL_Log("Couldn't parse SVG document: %s\n", SDL_GetError());
+        return false;
+    }
+    result = run_timed("rasterize parsed document", rasterize_svg_document, ctx, iterations);
+    IMG_FreeSVGDocument(ctx->document);
+    ctx->document = NULL;
+    return result;
+}
+
+/* Rasterizing a parsed SVG document, which is where the rasterizer span kernels run */
+static bool bench_svg_raster(BenchContext *ctx, int iterations)
+{
+    bool result;
+
+    if (!parse_svg_document(ctx)) {
+        SDL_Log("Couldn't parse SVG document: %s\n", SDL_GetError());
+        return false;
+    }
+    result = run_timed("rasterize SVG", rasterize_svg_document, ctx, iterations);
+    IMG_FreeSVGDocument(ctx->document);
+    ctx->document = NULL;
+    return result;
+}
+
+static const struct
+{
+    const char *name;
+    const char *description;
+    bool (*run)(BenchContext *ctx, int iterations);
+} modes[] = {
+    { "avif-save", "save an image as AVIF with IMG_SaveWithProperties()", bench_avif_save },
+    { "avif-yuv", "save an image as AVIF from RGB and from YUV 4:2:0", bench_avif_yuv },
+    { "jpg-save", "save an image as JPG from 24-bit and 32-bit RGB", bench_jpg_save },
+    { "load", "load an image with IMG_LoadWithProperties()", bench_load },
+    { "svg-document", "load an SVG image each time, then rasterize a parsed document", bench_svg_document },
+    { "svg-parse", "parse an SVG document", bench_svg_parse },
+    { "svg-raster", "rasterize a parsed SVG document", bench_svg_raster },
+};
+
+static void usage(const char *argv0)
+{
+    size_t i;
+
+    SDL_Log("Usage: %s [-iterations N] [-width N] [-height N] [-threads N] [-quality N] <mode> <image_file>\n", argv0);
+    SDL_Log("Modes:\n");
+    for (i = 0; i < SDL_arraysize(modes); ++i) {
+        SDL_Log("    %-14s %s\n", modes[i].name, modes[i].description);
+    }
+    SDL_Log("Set SDL_CPU_FEATURE_MASK=-all in the environment to measure without SIMD.\n");
+}
+
+int main(int argc, char *argv[])
+{
+    BenchContext ctx;
+    const char *mode = NULL;
+    const char *file = NULL;
+    void *data = NULL;
+    int iterations = 10;
+    int i;
+    size_t m;
+    int result = 0;
+
+    SDL_zero(ctx);
+    ctx.quality = 90;
+
+    for (i = 1; i < argc; ++i) {
+        if (SDL_strcmp(argv[i], "-iterations") == 0 && argv[i + 1]) {
+            iterations = SDL_atoi(argv[++i]);
+        } else if (SDL_strcmp(argv[i], "-width") == 0 && argv[i + 1]) {
+            ctx.width = SDL_atoi(argv[++i]);
+        } else if (SDL_strcmp(argv[i], "-height") == 0 && argv[i + 1]) {
+            ctx.height = SDL_atoi(argv[++i]);
+        } else if (SDL_strcmp(argv[i], "-threads") == 0 && argv[i + 1]) {
+            ctx.threads = SDL_atoi(argv[++i]);
+        } else if (SDL_strcmp(argv[i], "-quality") == 0 && argv[i + 1]) {
+            ctx.quality = SDL_atoi(argv[++i]);
+        } else if (!mode) {
+            mode = argv[i];
+        } else if (!file) {
+            file = argv[i];
+        } else {
+            break;
+        }
+    }
+    if (!mode || !file || i < argc || iterations <= 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    for (m = 0; m < SDL_arraysize(modes); ++m) {
+        if (SDL_strcmp(mode, modes[m].name) == 0) {
+            break;
+        }
+    }
+    if (m == SDL_arraysize(modes)) {
+        SDL_Log("Unknown mode %s\n", mode);
+        usage(argv[0]);
+        return 1;
+    }
+
+    data = SDL_LoadFile(file, &ctx.size);
+    if (!data) {
+        SDL_Log("Couldn't read %s: %s\n", file, SDL_GetError());
+        return 2;
+    }
+    ctx.data = data;
+
+    SDL_Log("%s: %s, %d iterations\n", mode, file, iterations);
+    if (!modes[m].run(&ctx, iterations)) {
+        result = 3;
+    }
+
+    SDL_DestroySurface(ctx.surface);
+    SDL_free(data);
+    SDL_Quit();
+    return result;
+}
@@ -225,9 +225,128 @@ extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_Load_IO(SDL_IOStream *src, bool cl
  *
  * \sa IMG_Load
  * \sa IMG_Load_IO
+ * \sa IMG_LoadWithProperties
  */
 extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadTyped_IO(SDL_IOStream *src, bool closeio, const char *type);
 
+/**
+ * A callback that receives the partially decoded image during a progressive
+ * load.
+ *
+ * The surface holds the whole image at the quality decoded so far and is
+ * owned by SDL_image: it is only valid until the callback returns, so copy it
+ * if it is needed afterwards. The finished image is never passed to the
+ * callback, it is returned by IMG_LoadWithProperties().
+ *
+ * \param userdata the `IMG_PROP_LOAD_PROGRESS_USERDATA_POINTER` property.
+ * \param surface the image as refined so far.
+ * \param pass the number of the refinement, starting at 1.
+ * \returns true to continue decoding, or false to stop and have
+ *          IMG_LoadWithProperties() return the image at its current quality.
+ *
+ * \since This datatype is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_LoadWithProperties
+ */
+typedef bool (SDLCALL *IMG_ProgressCallback)(void *userdata, SDL_Surface *surface, int pass);
+
+/**
+ * Load an image into a software surface with the specified properties.
+ *
+ * This works like IMG_LoadTyped_IO(), but accepts additional options that
+ * control how the image is decoded. Options that a particular image format
+ * can't honor are ignored.
+ *
+ * These are the supported properties:
+ *
+ * - `IMG_PROP_LOAD_FILENAME_STRING`: the file to load, if an SDL_IOStream
+ *   isn't being used. This is required if `IMG_PROP_LOAD_IOSTREAM_POINTER`
+ *   isn't set.
+ * - `IMG_PROP_LOAD_IOSTREAM_POINTER`: an SDL_IOStream containing the image
+ *   data. This is required if `IMG_PROP_LOAD_FILENAME_STRING` isn't set.
+ * - `IMG_PROP_LOAD_IOSTREAM_AUTOCLOSE_BOOLEAN`: true if the SDL_IOStream
+ *   should be closed before this function returns, whether it succeeds or
+ *   not.
+ * - `IMG_PROP_LOAD_TYPE_STRING`: the input file type, e.g. "jpg", defaults to
+ *   the file extension if `IMG_PROP_LOAD_FILENAME_STRING` is set.
+ * - `IMG_PROP_LOAD_WIDTH_NUMBER`: the desired width of the image, in pixels.
+ *   JPEG images will be decoded at the smallest reduced scale (1/2, 1/4 or
+ *   1/8) that is at least this wide, which is much faster than decoding at
+ *   full size and scaling afterwards. SVG images will be rendered at this
+ *   width, and WebP images are scaled to this width while decoding. If both
+ *   the width and height are set, SVG and WebP images are fit within them,
+ *   keeping their aspect ratio. Defaults to 0, meaning the natural size of
+ *   the image.
+ * - `IMG_PROP_LOAD_HEIGHT_NUMBER`: the desired height of the image, in pixels,
+ *   handled the same way as `IMG_PROP_LOAD_WIDTH_NUMBER`.
+ * - `IMG_PROP_LOAD_CROP_X_NUMBER`, `IMG_PROP_LOAD_CROP_Y_NUMBER`,
+ *   `IMG_PROP_LOAD_CROP_WIDTH_NUMBER`, `IMG_PROP_LOAD_CROP_HEIGHT_NUMBER`: a
+ *   rectangle of the image to load, in pixels of the original image. Only
+ *   this part of a WebP image is decoded, before it is scaled to
+ *   `IMG_PROP_LOAD_WIDTH_NUMBER` and `IMG_PROP_LOAD_HEIGHT_NUMBER`. AVIF
+ *   images are decoded in full, but only this part is converted and
+ *   returned. The rectangle is clipped to the image, and the top left corner
+ *   of chroma subsampled images may be rounded down to even coordinates.
+ *   Defaults to an empty rectangle, meaning the whole image.
+ * - `IMG_PROP_LOAD_PIXEL_FORMAT_NUMBER`: the preferred SDL_PixelFormat of the
+ *   returned surface. JPEG images can be decoded directly to
+ *   SDL_PIXELFORMAT_RGBA32, SDL_PIXELFORMAT_BGRA32, SDL_PIXELFORMAT_ARGB32,
+ *   SDL_PIXELFORMAT_ABGR32 and the matching 32-bit formats without alpha,
+ *   which avoids converting the surface afterwards. This requires
+ *   libjpeg-turbo; other decoders return their usual format, so check the
+ *   format of the returned surface. JPEG, WebP and AVIF images can also be
+ *   decoded to the planar YUV formats SDL_PIXELFORMAT_IYUV,
+ *   SDL_PIXELFORMAT_YV12, SDL_PIXELFORMAT_NV12 and SDL_PIXELFORMAT_NV21,
+ *   skipping the YUV to RGB conversion entirely. This is done for opaque
+ *   8-bit images with 4:2:0 chroma subsampling at their natural size, and
+ *   the colorspace of the surface is set to match the image.
+ * - `IMG_PROP_LOAD_MAX_THREADS_NUMBER`: the maximum number of threads to use
+ *   while decoding the image. AVIF images use them for AV1 decoding and for
+ *   the YUV to RGB conversion. JXL images are decoded on a pool of this many
+ *   threads. 8-bit gray, RGB and RGBA TIFF images have their strips or tiles
+ *   decoded in parallel, large SVG images are rasterized in horizontal bands
+ *   on this many threads, and the tiles of large XCF layers are decoded and
+ *   blended in parallel. Defaults to 0, meaning half the number of logical
+ *   CPU cores.
+ * - `IMG_PROP_LOAD_PROGRESS_CALLBACK_POINTER`: an IMG_ProgressCallback that is
+ *   called each time a progressive image has been refined, so a preview can
+ *   be shown before the rest of the data is read. This is supported for
+ *   progressive JPEG images, which are output once per scan, and for JXL
+ *   images, which are output once per progressive pass. Returning false from
+ *   the callback stops decoding early and the image is returned at the
+ *   quality reached so far. Other images are loaded as usual, without calling
+ *   it.
+ * - `IMG_PROP_LOAD_PROGRESS_USERDATA_POINTER`: a pointer that is passed to the
+ *   progress callback.
+ *
+ * When done with the returned surface, the app should dispose of it with a
+ * call to SDL_DestroySurface().
+ *
+ * \param props the properties to use when loading the image.
+ * \returns a new SDL surface, or NULL on error.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_Load
+ * \sa IMG_LoadTyped_IO
+ */
+extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadWithProperties(SDL_PropertiesID props);
+
+#define IMG_PROP_LOAD_FILENAME_STRING               "SDL_image.load.filename"
+#define IMG_PROP_LOAD_IOSTREAM_POINTER              "SDL_image.load.iostream"
+#define IMG_PROP_LOAD_IOSTREAM_AUTOCLOSE_BOOLEAN    "SDL_image.load.iostream.autoclose"
+#define IMG_PROP_LOAD_TYPE_STRING                   "SDL_image.load.type"
+#define IMG_PROP_LOAD_WIDTH_NUMBER                  "SDL_image.load.width"
+#define IMG_PROP_LOAD_HEIGHT_NUMBER                 "SDL_image.load.height"
+#define IMG_PROP_LOAD_CROP_X_NUMBER                 "SDL_image.load.crop.x"
+#define IMG_PROP_LOAD_CROP_Y_NUMBER                 "SDL_image.load.crop.y"
+#define IMG_PROP_LOAD_CROP_WIDTH_NUMBER             "SDL_image.load.crop.width"
+#define IMG_PROP_LOAD_CROP_HEIGHT_NUMBER            "SDL_image.load.crop.height"
+#define IMG_PROP_LOAD_PIXEL_FORMAT_NUMBER           "SDL_image.load.pixel_format"
+#define IMG_PROP_LOAD_MAX_THREADS_NUMBER            "SDL_image.load.max_threads"
+#define IMG_PROP_LOAD_PROGRESS_CALLBACK_POINTER     "SDL_image.load.progress_callback"
+#define IMG_PROP_LOAD_PROGRESS_USERDATA_POINTER     "SDL_image.load.progress_userdata"
+
 /**
  * Load an image from a filesystem path into a texture.
  *
@@ -363,6 +482,29 @@ extern SDL_DECLSPEC SDL_Texture * SDLCALL IMG_LoadTexture_IO(SDL_Renderer *rende
  */
 extern SDL_DECLSPEC SDL_Texture * SDLCALL IMG_LoadTextureTyped_IO(SDL_Renderer *renderer, SDL_IOStream *src, bool closeio, const char *type);
 
+/**
+ * Load an image into a GPU texture with the specified properties.
+ *
+ * This takes the same properties as IMG_LoadWithProperties(). If
+ * `IMG_PROP_LOAD_PIXEL_FORMAT_NUMBER` requests a planar YUV format and the
+ * image can be decoded that way, the YUV planes are uploaded to a YUV texture
+ * as-is and the renderer does the color conversion when drawing, which is
+ * much faster than converting to RGB on the CPU.
+ *
+ * When done with the returned texture, the app should dispose of it with a
+ * call to SDL_DestroyTexture().
+ *
+ * \param renderer the SDL_Renderer to use to create the texture.
+ * \param props the properties to use when loading the image.
+ * \returns a new texture, or NULL on error.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_LoadTexture
+ * \sa IMG_LoadWithProperties
+ */
+extern SDL_DECLSPEC SDL_Texture * SDLCALL IMG_LoadTextureWithProperties(SDL_Renderer *renderer, SDL_PropertiesID props);
+
 /**
  * Load an image from a filesystem path into a GPU texture.
  *
@@ -1544,6 +1686,32 @@ extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadICO_IO(SDL_IOStream *src);
  */
 extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadJPG_IO(SDL_IOStream *src);
 
+/**
+ * Load the thumbnail embedded in the EXIF data of a JPG image.
+ *
+ * Digital cameras usually store a small JPEG preview in the EXIF metadata of
+ * the photos they take. This function finds that preview and decodes it
+ * without decoding the main image, which is much faster when only a preview
+ * is needed. The thumbnail is rotated to match the EXIF orientation of the
+ * main image.
+ *
+ * If the image doesn't have an EXIF thumbnail, this function returns NULL and
+ * you can fall back to decoding the image at a reduced size with
+ * IMG_LoadWithProperties() instead.
+ *
+ * The stream position is left unchanged.
+ *
+ * \param src an SDL_IOStream to load image data from.
+ * \returns SDL surface, or NULL if the image has no thumbnail or on error;
+ *          call SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_LoadJPG_IO
+ * \sa IMG_LoadWithProperties
+ */
+extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadJPGThumbnail_IO(SDL_IOStream *src);
+
 /**
  * Load a JXL image directly.
  *
@@ -1772,6 +1940,141 @@ extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadSVG_IO(SDL_IOStream *src);
  */
 extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadSizedSVG_IO(SDL_IOStream *src, int width, int height);
 
+/**
+ * A parsed SVG image that can be rasterized at any size.
+ *
+ * \since This struct is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_LoadSVGDocument_IO
+ * \sa IMG_RasterizeSVG
+ * \sa IMG_RasterizeSVGRegion
+ * \sa IMG_FreeSVGDocument
+ */
+typedef struct IMG_SVGDocument IMG_SVGDocument;
+
+/**
+ * Parse an SVG image so it can be rasterized at several sizes.
+ *
+ * IMG_LoadSizedSVG_IO() parses the SVG data every time it is called. When the
+ * same image is needed at several sizes, for example an icon shown at
+ * different display scales, it's faster to parse it once with this function
+ * and call IMG_RasterizeSVG() for each size.
+ *
+ * If `closeio` is true, `src` will be closed before returning, whether this
+ * function succeeds or not.
+ *
+ * \param src an SDL_IOStream to load SVG data from.
+ * \param closeio true to close the SDL_IOStream when done, false to leave it
+ *                open.
+ * \returns a new SVG document, or NULL on error; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_GetSVGDocumentSize
+ * \sa IMG_RasterizeSVG
+ * \sa IMG_FreeSVGDocument
+ */
+extern SDL_DECLSPEC IMG_SVGDocument * SDLCALL IMG_LoadSVGDocument_IO(SDL_IOStream *src, bool closeio);
+
+/**
+ * Get the intrinsic size of a parsed SVG image.
+ *
+ * This is the size the image is rasterized at when IMG_RasterizeSVG() is
+ * called with a width and height of 0, in pixels at 96 DPI.
+ *
+ * \param document the SVG document to query.
+ * \param width a pointer filled in with the width of the image, may be NULL.
+ * \param height a pointer filled in with the height of the image, may be
+ *               NULL.
+ * \returns true on success or false on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_LoadSVGDocument_IO
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_GetSVGDocumentSize(IMG_SVGDocument *document, float *width, float *height);
+
+/**
+ * Rasterize a parsed SVG image at a specific size.
+ *
+ * The size works the same way as in IMG_LoadSizedSVG_IO(): either width or
+ * height may be 0 and the image will be auto-sized to preserve aspect ratio.
+ *
+ * Each thread keeps its own rasterizer, which is reused by later calls on
+ * that thread, so the same document may be rasterized on several threads at
+ * once. Large images are split into horizontal bands that are rasterized on
+ * half the logical CPU cores, with exactly the same result as a single
+ * thread.
+ *
+ * When done with the returned surface, the app should dispose of it with a
+ * call to SDL_DestroySurface().
+ *
+ * \param document the SVG document to rasterize.
+ * \param width desired width of the generated surface, in pixels.
+ * \param height desired height of the generated surface, in pixels.
+ * \returns a new SDL surface, or NULL on error; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_LoadSVGDocument_IO
+ * \sa IMG_GetSVGDocumentSize
+ * \sa IMG_RasterizeSVGRegion
+ */
+extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_RasterizeSVG(IMG_SVGDocument *document, int width, int height);
+
+/**
+ * Rasterize a region of a parsed SVG image at a specific scale.
+ *
+ * The top left pixel of the returned surface shows the point (`x`, `y`) of
+ * the image, in the units reported by IMG_GetSVGDocumentSize(), and each of
+ * those units covers `scale` pixels. The region isn't clipped to the image,
+ * so shapes that extend past its edges are drawn there as well.
+ *
+ * This is meant for viewers that zoom into an image and draw it in tiles:
+ * only the shapes that reach into the region are rasterized, so the cost
+ * depends on the size of the surface rather than on the size of the whole
+ * image at that scale. A region at (0, 0) gives the same pixels as
+ * IMG_RasterizeSVG() at the same scale. Elsewhere, antialiased edges may
+ * differ slightly from the same pixels of a larger surface, because of
+ * floating point rounding.
+ *
+ * Large regions are rasterized on several threads, like IMG_RasterizeSVG(),
+ * and the same document may be rasterized on several threads at once.
+ *
+ * When done with the returned surface, the app should dispose of it with a
+ * call to SDL_DestroySurface().
+ *
+ * \param document the SVG document to rasterize.
+ * \param x the left edge of the region, in image units.
+ * \param y the top edge of the region, in image units.
+ * \param scale the number of pixels per image unit, greater than 0.
+ * \param width the width of the generated surface, in pixels.
+ * \param height the height of the generated surface, in pixels.
+ * \returns a new SDL surface, or NULL on error; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_LoadSVGDocument_IO
+ * \sa IMG_GetSVGDocumentSize
+ * \sa IMG_RasterizeSVG
+ */
+extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_RasterizeSVGRegion(IMG_SVGDocument *document, float x, float y, float scale, int width, int height);
+
+/**
+ * Dispose of a parsed SVG image.
+ *
+ * \param document the SVG document to dispose of, may be NULL.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_LoadSVGDocument_IO
+ */
+extern SDL_DECLSPEC void SDLCALL IMG_FreeSVGDocument(IMG_SVGDocument *document);
+
 /**
  * Load a QOI image directly.
  *
@@ -1874,6 +2177,49 @@ extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadTGA_IO(SDL_IOStream *src);
  */
 extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadTIF_IO(SDL_IOStream *src);
 
+/**
+ * Get the number of pages in a TIFF image.
+ *
+ * Multi-page TIFF files, such as scanned documents and faxes, store each page
+ * as a separate image. Only the page headers are read to count them, not the
+ * image data.
+ *
+ * The stream position is left unchanged.
+ *
+ * \param src an SDL_IOStream to load image data from.
+ * \returns the number of pages, or 0 on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_LoadTIFPage_IO
+ * \sa IMG_LoadTIFAnimation_IO
+ */
+extern SDL_DECLSPEC int SDLCALL IMG_GetTIFPageCount_IO(SDL_IOStream *src);
+
+/**
+ * Load a single page of a multi-page TIFF image.
+ *
+ * The page is found by following the chain of page headers, so earlier pages
+ * are not decoded. IMG_LoadTIF_IO() is the same as loading page 0.
+ *
+ * To read every page in turn without reopening the file, create an animation
+ * decoder of type "tif" with IMG_CreateAnimationDecoder_IO(), which returns
+ * each page as a frame.
+ *
+ * \param src an SDL_IOStream to load image data from.
+ * \param page the index of the page to load, starting at 0.
+ * \returns SDL surface, or NULL on error; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_GetTIFPageCount_IO
+ * \sa IMG_LoadTIF_IO
+ * \sa IMG_CreateAnimationDecoder_IO
+ */
+extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_LoadTIFPage_IO(SDL_IOStream *src, int page);
+
 /**
  * Load a WEBP image directly.
  *
@@ -2063,12 +2409,14 @@ extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_ReadXPMFromArrayToRGB888(char **xp
  * \since This function is available since SDL_image 3.4.0.
  *
  * \sa IMG_SaveTyped_IO
+ * \sa IMG_SaveWithProperties
  * \sa IMG_SaveAVIF
  * \sa IMG_SaveBMP
  * \sa IMG_SaveCUR
  * \sa IMG_SaveGIF
  * \sa IMG_SaveICO
  * \sa IMG_SaveJPG
+ * \sa IMG_SaveJXL
  * \sa IMG_SavePNG
  * \sa IMG_SaveTGA
  * \sa IMG_SaveWEBP
@@ -2097,23 +2445,101 @@ extern SDL_DECLSPEC bool SDLCALL IMG_Save(SDL_Surface *surface, const char *file
  * \since This function is available since SDL_image 3.4.0.
  *
  * \sa IMG_Save
+ * \sa IMG_SaveWithProperties
  * \sa IMG_SaveAVIF_IO
  * \sa IMG_SaveBMP_IO
  * \sa IMG_SaveCUR_IO
  * \sa IMG_SaveGIF_IO
  * \sa IMG_SaveICO_IO
  * \sa IMG_SaveJPG_IO
+ * \sa IMG_SaveJXL_IO
  * \sa IMG_SavePNG_IO
  * \sa IMG_SaveTGA_IO
  * \sa IMG_SaveWEBP_IO
  */
 extern SDL_DECLSPEC bool SDLCALL IMG_SaveTyped_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio, const char *type);
 
+/**
+ * Save an SDL_Surface into formatted image data with the specified
+ * properties.
+ *
+ * This works like IMG_SaveTyped_IO(), but accepts additional options that
+ * control how the image is encoded. Options that a particular image format
+ * can't honor are ignored.
+ *
+ * These are the supported properties:
+ *
+ * - `IMG_PROP_SAVE_FILENAME_STRING`: the file to write, if an SDL_IOStream
+ *   isn't being used. If the file already exists, it will be overwritten.
+ *   This is required if `IMG_PROP_SAVE_IOSTREAM_POINTER` isn't set.
+ * - `IMG_PROP_SAVE_IOSTREAM_POINTER`: an SDL_IOStream to write the image data
+ *   to. This is required if `IMG_PROP_SAVE_FILENAME_STRING` isn't set.
+ * - `IMG_PROP_SAVE_IOSTREAM_AUTOCLOSE_BOOLEAN`: true if the SDL_IOStream
+ *   should be closed before this function returns, whether it succeeds or
+ *   not.
+ * - `IMG_PROP_SAVE_TYPE_STRING`: the output file type, e.g. "avif", defaults
+ *   to the file extension if `IMG_PROP_SAVE_FILENAME_STRING` is set.
+ * - `IMG_PROP_SAVE_QUALITY_NUMBER`: the desired quality, ranging between 0
+ *   (lowest) and 100 (highest), for formats that accept a quality. Defaults
+ *   to 90.
+ * - `IMG_PROP_SAVE_MAX_THREADS_NUMBER`: the maximum number of threads to use
+ *   while encoding the image. AVIF images use them for AV1 encoding, JXL
+ *   images are encoded on a pool of this many threads, and large JPEG images
+ *   are encoded in parallel bands. Defaults to 0, meaning half the number of
+ *   logical CPU cores.
+ * - `IMG_PROP_SAVE_AVIF_SPEED_NUMBER`: the AVIF encoder speed, ranging
+ *   between 0 (slowest, smallest files) and 10 (fastest). Defaults to 10.
+ * - `IMG_PROP_SAVE_AVIF_TILE_ROWS_LOG2_NUMBER`,
+ *   `IMG_PROP_SAVE_AVIF_TILE_COLS_LOG2_NUMBER`: the base 2 logarithm of the
+ *   number of tile rows and columns to split an AVIF image into, between 0
+ *   and 6. Tiles are encoded in parallel, at a small cost in file size. By
+ *   default large images are split into roughly one tile per thread, with
+ *   tiles no smaller than 512x512 pixels.
+ * - `IMG_PROP_SAVE_JXL_EFFORT_NUMBER`: the JXL encoder effort, ranging
+ *   between 1 (fastest) and 9 (slowest, smallest files). Defaults to 7.
+ *   With libjxl 0.9 or newer, lossless images at effort 1 use its fast
+ *   lossless mode.
+ * - `IMG_PROP_SAVE_JXL_DISTANCE_FLOAT`: the Butteraugli distance of lossy JXL
+ *   images, ranging between 0 and 25, where 1 is visually lossless. Defaults
+ *   to a distance derived from `IMG_PROP_SAVE_QUALITY_NUMBER`.
+ * - `IMG_PROP_SAVE_JXL_LOSSLESS_BOOLEAN`: true to save JXL images losslessly.
+ *   Defaults to true if `IMG_PROP_SAVE_QUALITY_NUMBER` is 100.
+ *
+ * \param surface the SDL surface to save.
+ * \param props the properties to use when saving the image.
+ * \returns true on success or false on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_Save
+ * \sa IMG_SaveTyped_IO
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_SaveWithProperties(SDL_Surface *surface, SDL_PropertiesID props);
+
+#define IMG_PROP_SAVE_FILENAME_STRING               "SDL_image.save.filename"
+#define IMG_PROP_SAVE_IOSTREAM_POINTER              "SDL_image.save.iostream"
+#define IMG_PROP_SAVE_IOSTREAM_AUTOCLOSE_BOOLEAN    "SDL_image.save.iostream.autoclose"
+#define IMG_PROP_SAVE_TYPE_STRING                   "SDL_image.save.type"
+#define IMG_PROP_SAVE_QUALITY_NUMBER                "SDL_image.save.quality"
+#define IMG_PROP_SAVE_MAX_THREADS_NUMBER            "SDL_image.save.max_threads"
+#define IMG_PROP_SAVE_AVIF_SPEED_NUMBER             "SDL_image.save.avif.speed"
+#define IMG_PROP_SAVE_AVIF_TILE_ROWS_LOG2_NUMBER    "SDL_image.save.avif.tile_rows_log2"
+#define IMG_PROP_SAVE_AVIF_TILE_COLS_LOG2_NUMBER    "SDL_image.save.avif.tile_cols_log2"
+#define IMG_PROP_SAVE_JXL_EFFORT_NUMBER             "SDL_image.save.jxl.effort"
+#define IMG_PROP_SAVE_JXL_DISTANCE_FLOAT            "SDL_image.save.jxl.distance"
+#define IMG_PROP_SAVE_JXL_LOSSLESS_BOOLEAN          "SDL_image.save.jxl.lossless"
+
 /**
  * Save an SDL_Surface into a AVIF image file.
  *
  * If the file already exists, it will be overwritten.
  *
+ * 8-bit 4:2:0 YUV surfaces (SDL_PIXELFORMAT_IYUV, SDL_PIXELFORMAT_YV12,
+ * SDL_PIXELFORMAT_NV12 and SDL_PIXELFORMAT_NV21) are encoded directly from
+ * their planes, keeping the surface colorspace, without a round trip through
+ * RGB.
+ *
  * \param surface the SDL surface to save.
  * \param file path on the filesystem to write new file to.
  * \param quality the desired quality, ranging between 0 (lowest) and 100
@@ -2135,6 +2561,9 @@ extern SDL_DECLSPEC bool SDLCALL IMG_SaveAVIF(SDL_Surface *surface, const char *
  * If `closeio` is true, `dst` will be closed before returning, whether this
  * function succeeds or not.
  *
+ * 8-bit 4:2:0 YUV surfaces are encoded directly from their planes, as
+ * described in IMG_SaveAVIF().
+ *
  * \param surface the SDL surface to save.
  * \param dst the SDL_IOStream to save the image data to.
  * \param closeio true to close/free the SDL_IOStream before returning, false
@@ -2305,8 +2734,8 @@ extern SDL_DECLSPEC bool SDLCALL IMG_SaveICO_IO(SDL_Surface *surface, SDL_IOStre
  *
  * \param surface the SDL surface to save.
  * \param file path on the filesystem to write new file to.
- * \param quality [0; 33] is Lowest quality, [34; 66] is Middle quality, [67;
- *                100] is Highest quality.
+ * \param quality the desired quality, ranging between 0 (lowest) and 100
+ *                (highest).
  * \returns true on success or false on failure; call SDL_GetError() for more
  *          information.
  *
@@ -2328,8 +2757,8 @@ extern SDL_DECLSPEC bool SDLCALL IMG_SaveJPG(SDL_Surface *surface, const char *f
  * \param dst the SDL_IOStream to save the image data to.
  * \param closeio true to close/free the SDL_IOStream before returning, false
  *                to leave it open.
- * \param quality [0; 33] is Lowest quality, [34; 66] is Middle quality, [67;
- *                100] is Highest quality.
+ * \param quality the desired quality, ranging between 0 (lowest) and 100
+ *                (highest).
  * \returns true on success or false on failure; call SDL_GetError() for more
  *          information.
  *
@@ -2339,6 +2768,55 @@ extern SDL_DECLSPEC bool SDLCALL IMG_SaveJPG(SDL_Surface *surface, const char *f
  */
 extern SDL_DECLSPEC bool SDLCALL IMG_SaveJPG_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio, int quality);
 
+/**
+ * Save an SDL_Surface into a JPEG XL image file.
+ *
+ * If the file already exists, it will be overwritten.
+ *
+ * A quality of 100 saves the image losslessly. Use IMG_SaveWithProperties()
+ * to control the encoder effort, distance and thread count.
+ *
+ * JPEG XL save support is only available if SDL_image was built with the
+ * `SDLIMAGE_JXL_SAVE` option.
+ *
+ * \param surface the SDL surface to save.
+ * \param file path on the filesystem to write new file to.
+ * \param quality the desired quality, ranging between 0 (lowest) and 100
+ *                (lossless).
+ * \returns true on success or false on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_SaveJXL_IO
+ * \sa IMG_SaveWithProperties
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_SaveJXL(SDL_Surface *surface, const char *file, int quality);
+
+/**
+ * Save an SDL_Surface into JPEG XL image data, via an SDL_IOStream.
+ *
+ * If you just want to save to a filename, you can use IMG_SaveJXL() instead.
+ *
+ * If `closeio` is true, `dst` will be closed before returning, whether this
+ * function succeeds or not.
+ *
+ * \param surface the SDL surface to save.
+ * \param dst the SDL_IOStream to save the image data to.
+ * \param closeio true to close/free the SDL_IOStream before returning, false
+ *                to leave it open.
+ * \param quality the desired quality, ranging between 0 (lowest) and 100
+ *                (lossless).
+ * \returns true on success or false on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_SaveJXL
+ * \sa IMG_SaveWithProperties
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_SaveJXL_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio, int quality);
+
 /**
  * Save an SDL_Surface into a PNG image file.
  *
@@ -2667,6 +3145,52 @@ extern SDL_DECLSPEC IMG_Animation *SDLCALL IMG_LoadAVIFAnimation_IO(SDL_IOStream
  */
 extern SDL_DECLSPEC IMG_Animation * SDLCALL IMG_LoadGIFAnimation_IO(SDL_IOStream *src);
 
+/**
+ * Load a JXL animation directly.
+ *
+ * If you know you definitely have a JXL image, you can call this function,
+ * which will skip SDL_image's file format detection routines. Generally it's
+ * better to use the abstract interfaces; also, there is only an SDL_IOStream
+ * interface available here.
+ *
+ * \param src an SDL_IOStream that data will be read from.
+ * \returns a new IMG_Animation, or NULL on error.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_isJXL
+ * \sa IMG_LoadAnimation
+ * \sa IMG_LoadAnimation_IO
+ * \sa IMG_LoadAnimationTyped_IO
+ * \sa IMG_CreateAnimationDecoder_IO
+ * \sa IMG_FreeAnimation
+ */
+extern SDL_DECLSPEC IMG_Animation * SDLCALL IMG_LoadJXLAnimation_IO(SDL_IOStream *src);
+
+/**
+ * Load the pages of a multi-page TIFF image as an animation.
+ *
+ * Each page becomes a frame of the animation, with no delay between them.
+ * Every page is kept in memory, so for long documents it's better to read
+ * the pages one at a time with IMG_CreateAnimationDecoder_IO() or
+ * IMG_LoadTIFPage_IO().
+ *
+ * \param src an SDL_IOStream that data will be read from.
+ * \returns a new IMG_Animation, or NULL on error.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_isTIF
+ * \sa IMG_GetTIFPageCount_IO
+ * \sa IMG_LoadTIFPage_IO
+ * \sa IMG_LoadAnimation
+ * \sa IMG_LoadAnimation_IO
+ * \sa IMG_LoadAnimationTyped_IO
+ * \sa IMG_CreateAnimationDecoder_IO
+ * \sa IMG_FreeAnimation
+ */
+extern SDL_DECLSPEC IMG_Animation * SDLCALL IMG_LoadTIFAnimation_IO(SDL_IOStream *src);
+
 /**
  * Load a WEBP animation directly.
  *
@@ -3097,6 +3621,8 @@ typedef struct IMG_AnimationDecoder IMG_AnimationDecoder;
  * - APNG
  * - AVIFS
  * - GIF
+ * - JXL
+ * - TIFF
  * - WEBP
  *
  * The file type is determined from the file extension, e.g. "file.webp" will
@@ -3125,6 +3651,8 @@ extern SDL_DECLSPEC IMG_AnimationDecoder * SDLCALL IMG_CreateAnimationDecoder(co
  * - APNG
  * - AVIFS
  * - GIF
+ * - JXL
+ * - TIFF
  * - WEBP
  *
  * If `closeio` is true, `src` will be closed before returning if this
@@ -3157,6 +3685,8 @@ extern SDL_DECLSPEC IMG_AnimationDecoder * SDLCALL IMG_CreateAnimationDecoder_IO
  * - APNG
  * - AVIFS
  * - GIF
+ * - JXL
+ * - TIFF
  * - WEBP
  *
  * These are the supported properties:
@@ -3175,6 +3705,34 @@ extern SDL_DECLSPEC IMG_AnimationDecoder * SDLCALL IMG_CreateAnimationDecoder_IO
  *   e.g. "webp", defaults to the file extension if
  *   `IMG_PROP_ANIMATION_DECODER_CREATE_FILENAME_STRING` is set.
  *
+ * These properties are supported by the WEBP decoder:
+ *
+ * - `IMG_PROP_ANIMATION_DECODER_CREATE_WIDTH_NUMBER`,
+ *   `IMG_PROP_ANIMATION_DECODER_CREATE_HEIGHT_NUMBER`: the desired size of the
+ *   frames, in pixels. Frames are scaled while decoding to fit within this
+ *   size, keeping their aspect ratio. Defaults to 0, meaning the natural size
+ *   of the animation.
+ * - `IMG_PROP_ANIMATION_DECODER_CREATE_CROP_X_NUMBER`,
+ *   `IMG_PROP_ANIMATION_DECODER_CREATE_CROP_Y_NUMBER`,
+ *   `IMG_PROP_ANIMATION_DECODER_CREATE_CROP_WIDTH_NUMBER`,
+ *   `IMG_PROP_ANIMATION_DECODER_CREATE_CROP_HEIGHT_NUMBER`: a rectangle of the
+ *   animation to decode, before it is scaled. Defaults to an empty rectangle,
+ *   meaning the whole animation.
+ *
+ * These properties are supported by the JXL decoder:
+ *
+ * - `IMG_PROP_ANIMATION_DECODER_CREATE_JXL_MAX_THREADS_NUMBER`: the maximum
+ *   number of threads used to decode each frame. Defaults to 0, meaning half
+ *   the number of logical CPU cores.
+ *
+ * Each page of a multi-page TIFF image is a frame, read only when it is
+ * requested, and these properties are supported by the TIFF decoder:
+ *
+ * - `IMG_PROP_ANIMATION_DECODER_CREATE_TIF_MAX_THREADS_NUMBER`: the maximum
+ *   number of threads used to decode each page. This is only used for memory
+ *   streams, since other streams would have to be read into memory first.
+ *   Defaults to 0, meaning half the number of logical CPU cores.
+ *
  * \param props the properties of the animation decoder.
  * \returns a new IMG_AnimationDecoder, or NULL on failure; call
  *          SDL_GetError() for more information.
@@ -3195,10 +3753,18 @@ extern SDL_DECLSPEC IMG_AnimationDecoder * SDLCALL IMG_CreateAnimationDecoderWit
 #define IMG_PROP_ANIMATION_DECODER_CREATE_TYPE_STRING                    "SDL_image.animation_decoder.create.type"
 #define IMG_PROP_ANIMATION_DECODER_CREATE_TIMEBASE_NUMERATOR_NUMBER      "SDL_image.animation_decoder.create.timebase.numerator"
 #define IMG_PROP_ANIMATION_DECODER_CREATE_TIMEBASE_DENOMINATOR_NUMBER    "SDL_image.animation_decoder.create.timebase.denominator"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_WIDTH_NUMBER                   "SDL_image.animation_decoder.create.width"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_HEIGHT_NUMBER                  "SDL_image.animation_decoder.create.height"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_CROP_X_NUMBER                  "SDL_image.animation_decoder.create.crop.x"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_CROP_Y_NUMBER                  "SDL_image.animation_decoder.create.crop.y"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_CROP_WIDTH_NUMBER              "SDL_image.animation_decoder.create.crop.width"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_CROP_HEIGHT_NUMBER             "SDL_image.animation_decoder.create.crop.height"
 
 #define IMG_PROP_ANIMATION_DECODER_CREATE_AVIF_MAX_THREADS_NUMBER        "SDL_image.animation_decoder.create.avif.max_threads"
 #define IMG_PROP_ANIMATION_DECODER_CREATE_AVIF_ALLOW_INCREMENTAL_BOOLEAN "SDL_image.animation_decoder.create.avif.allow_incremental"
 #define IMG_PROP_ANIMATION_DECODER_CREATE_AVIF_ALLOW_PROGRESSIVE_BOOLEAN "SDL_image.animation_decoder.create.avif.allow_progressive"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_JXL_MAX_THREADS_NUMBER         "SDL_image.animation_decoder.create.jxl.max_threads"
+#define IMG_PROP_ANIMATION_DECODER_CREATE_TIF_MAX_THREADS_NUMBER         "SDL_image.animation_decoder.create.tif.max_threads"
 #define IMG_PROP_ANIMATION_DECODER_CREATE_GIF_TRANSPARENT_COLOR_INDEX_NUMBER "SDL_image.animation_encoder.create.gif.transparent_color_index"
 #define IMG_PROP_ANIMATION_DECODER_CREATE_GIF_NUM_COLORS_NUMBER          "SDL_image.animation_encoder.create.gif.num_colors"
 
@@ -3320,6 +3886,92 @@ extern SDL_DECLSPEC bool SDLCALL IMG_ResetAnimationDecoder(IMG_AnimationDecoder
  */
 extern SDL_DECLSPEC bool SDLCALL IMG_CloseAnimationDecoder(IMG_AnimationDecoder *decoder);
 
+/**
+ * An object representing an incremental WEBP decoder.
+ *
+ * \since This struct is available since SDL_image 3.6.0.
+ */
+typedef struct IMG_WEBPDecoder IMG_WEBPDecoder;
+
+/**
+ * Create a decoder that decodes a WEBP image as its data arrives.
+ *
+ * Unlike IMG_LoadWEBP_IO(), the application pushes the image data into the
+ * decoder in chunks of any size with IMG_AppendWEBPDecoderData(), and can
+ * display the rows decoded so far with IMG_GetWEBPDecoderSurface(). This is
+ * useful for images that are received over a network connection.
+ *
+ * The decoder doesn't keep a copy of the whole file, only the data that
+ * hasn't been decoded yet. Animated WEBP images are not supported, use
+ * IMG_CreateAnimationDecoder_IO() for those.
+ *
+ * \returns a new IMG_WEBPDecoder, or NULL on failure; call SDL_GetError() for
+ *          more information.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_AppendWEBPDecoderData
+ * \sa IMG_GetWEBPDecoderSurface
+ * \sa IMG_DestroyWEBPDecoder
+ */
+extern SDL_DECLSPEC IMG_WEBPDecoder * SDLCALL IMG_CreateWEBPDecoder(void);
+
+/**
+ * Feed the next chunk of WEBP data to an incremental decoder.
+ *
+ * The data is decoded as far as possible before this function returns, and
+ * may be freed by the application afterwards. Data appended after the image
+ * is complete is ignored.
+ *
+ * \param decoder the incremental WEBP decoder.
+ * \param data the next chunk of the WEBP file.
+ * \param size the size of `data`, in bytes.
+ * \returns true on success or false if the data isn't a valid WEBP image;
+ *          call SDL_GetError() for more information.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_CreateWEBPDecoder
+ * \sa IMG_GetWEBPDecoderSurface
+ */
+extern SDL_DECLSPEC bool SDLCALL IMG_AppendWEBPDecoderData(IMG_WEBPDecoder *decoder, const void *data, size_t size);
+
+/**
+ * Get the image being decoded by an incremental WEBP decoder.
+ *
+ * The surface is available as soon as the image header has been received,
+ * and its first `rows` rows contain decoded pixels. The image is complete
+ * when `rows` is equal to the height of the surface.
+ *
+ * The surface is owned by the decoder and is updated by each call to
+ * IMG_AppendWEBPDecoderData(). It's freed when the decoder is destroyed,
+ * unless the application increments its refcount to keep it.
+ *
+ * \param decoder the incremental WEBP decoder.
+ * \param rows a pointer filled in with the number of decoded rows, may be
+ *             NULL.
+ * \returns the surface being decoded, or NULL if the image header hasn't been
+ *          received yet or on failure; call SDL_GetError() for more
+ *          information.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_CreateWEBPDecoder
+ * \sa IMG_AppendWEBPDecoderData
+ */
+extern SDL_DECLSPEC SDL_Surface * SDLCALL IMG_GetWEBPDecoderSurface(IMG_WEBPDecoder *decoder, int *rows);
+
+/**
+ * Destroy an incremental WEBP decoder.
+ *
+ * \param decoder the incremental WEBP decoder to destroy, may be NULL.
+ *
+ * \since This function is available since SDL_image 3.6.0.
+ *
+ * \sa IMG_CreateWEBPDecoder
+ */
+extern SDL_DECLSPEC void SDLCALL IMG_DestroyWEBPDecoder(IMG_WEBPDecoder *decoder);
+
 /* Ends C function definitions when using C++ */
 #ifdef __cplusplus
 }
@@ -23,6 +23,9 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG.h"
+#include "IMG_utils.h"
+
 #ifdef __EMSCRIPTEN__
 #include <emscripten/emscripten.h>
 #endif
@@ -53,27 +56,28 @@ static struct {
     const char *type;
     bool (SDLCALL *is)(SDL_IOStream *src);
     SDL_Surface *(SDLCALL *load)(SDL_IOStream *src);
+    SDL_Surface *(*load_props)(SDL_IOStream *src, SDL_PropertiesID props);
 } supported[] = {
     /* keep magicless formats first */
-    { "TGA", NULL,      IMG_LoadTGA_IO },
-    { "AVIF",IMG_isAVIF,IMG_LoadAVIF_IO },
-    { "CUR", IMG_isCUR, IMG_LoadCUR_IO },
-    { "ICO", IMG_isICO, IMG_LoadICO_IO },
-    { "BMP", IMG_isBMP, IMG_LoadBMP_IO },
-    { "GIF", IMG_isGIF, IMG_LoadGIF_IO },
-    { "JPG", IMG_isJPG, IMG_LoadJPG_IO },
-    { "JXL", IMG_isJXL, IMG_LoadJXL_IO },
-    { "LBM", IMG_isLBM, IMG_LoadLBM_IO },
-    { "PCX", IMG_isPCX, IMG_LoadPCX_IO },
-    { "PNG", IMG_isPNG, IMG_LoadPNG_IO },
-    { "PNM", IMG_isPNM, IMG_LoadPNM_IO }, /* P[BGP]M share code */
-    { "SVG", IMG_isSVG, IMG_LoadSVG_IO },
-    { "TIF", IMG_isTIF, IMG_LoadTIF_IO },
-    { "XCF", IMG_isXCF, IMG_LoadXCF_IO },
-    { "XPM", IMG_isXPM, IMG_LoadXPM_IO },
-    { "XV",  IMG_isXV,  IMG_LoadXV_IO  },
-    { "WEBP", IMG_isWEBP, IMG_LoadWEBP_IO },
-    { "QOI", IMG_isQOI, IMG_LoadQOI_IO },
+    { "TGA", NULL,      IMG_LoadTGA_IO, NULL },
+    { "AVIF",IMG_isAVIF,IMG_LoadAVIF_IO, IMG_LoadAVIFWithProperties },
+    { "CUR", IMG_isCUR, IMG_LoadCUR_IO, NULL },
+    { "ICO", IMG_isICO, IMG_LoadICO_IO, NULL },
+    { "BMP", IMG_isBMP, IMG_LoadBMP_IO, NULL },
+    { "GIF", IMG_isGIF, IMG_LoadGIF_IO, NULL },
+    { "JPG", IMG_isJPG, IMG_LoadJPG_IO, IMG_LoadJPGWithProperties },
+    { "JXL", IMG_isJXL, IMG_LoadJXL_IO, IMG_LoadJXLWithProperties },
+    { "LBM", IMG_isLBM, IMG_LoadLBM_IO, NULL },
+    { "PCX", IMG_isPCX, IMG_LoadPCX_IO, NULL },
+    { "PNG", IMG_isPNG, IMG_LoadPNG_IO, NULL },
+    { "PNM", IMG_isPNM, IMG_LoadPNM_IO, NULL }, /* P[BGP]M share code */
+    { "SVG", IMG_isSVG, IMG_LoadSVG_IO, IMG_LoadSVGWithProperties },
+    { "TIF", IMG_isTIF, IMG_LoadTIF_IO, IMG_LoadTIFWithProperties },
+    { "XCF", IMG_isXCF, IMG_LoadXCF_IO, IMG_LoadXCFWithProperties },
+    { "XPM", IMG_isXPM, IMG_LoadXPM_IO, NULL },
+    { "XV",  IMG_isXV,  IMG_LoadXV_IO, NULL },
+    { "WEBP", IMG_isWEBP, IMG_LoadWEBP_IO, IMG_LoadWEBPWithProperties },
+    { "QOI", IMG_isQOI, IMG_LoadQOI_IO, NULL },
 };
 
 /* Table of animation detection and loading functions */
@@ -87,6 +91,8 @@ static struct {
     { "WEBP", IMG_isWEBP, IMG_LoadWEBPAnimation_IO  },
     { "APNG", IMG_isPNG, IMG_LoadAPNGAnimation_IO   },
     { "AVIFS", IMG_isAVIF, IMG_LoadAVIFAnimation_IO },
+    { "JXL", IMG_isJXL, IMG_LoadJXLAnimation_IO },
+    { "TIF", IMG_isTIF, IMG_LoadTIFAnimation_IO },
     { "ANI", IMG_isANI, IMG_LoadANIAnimation_IO },
 };
 
@@ -135,8 +141,8 @@ SDL_Surface *IMG_Load_IO(SDL_IOStream *src, bool closeio)
     return IMG_LoadTyped_IO(src, closeio, NULL);
 }
 
-/* Load an image from an SDL datasource, optionally specifying the type */
-SDL_Surface *IMG_LoadTyped_IO(SDL_IOStream *src, bool closeio, const char *type)
+/* Load an image from an SDL datasource, optionally specifying the type and decoding options */
+static SDL_Surface *IMG_LoadTypedWithProperties_IO(SDL_IOStream *src, bool closeio, const char *type, SDL_PropertiesID props)
 {
     size_t i;
     SDL_Surface *image;
@@ -196,7 +202,11 @@ SDL_Surface *IMG_LoadTyped_IO(SDL_IOStream *src, bool closeio, const char *type)
 #ifdef DEBUG_IMGLIB
         SDL_Log("IMGLIB: Loading image as %s\n", supported[i].type);
 #endif
-        image = supported[i].load(src);
+        if (props && supported[i].load_props) {
+            image = supported[i].load_props(src, props);
+        } else {
+            image = supported[i].load(src);
+        }
         if (closeio) {
             SDL_CloseIO(src);
         }
@@ -210,6 +220,48 @@ SDL_Surface *IMG_LoadTyped_IO(SDL_IOStream *src, bool closeio, const char *type)
     return NULL;
 }
 
+/* Load an image from an SDL datasource, optionally specifying the type */
+SDL_Surface *IMG_LoadTyped_IO(SDL_IOStream *src, bool closeio, const char *type)
+{
+    return IMG_LoadTypedWithProperties_IO(src, closeio, type, 0);
+}
+
+SDL_Surface *IMG_LoadWithProperties(SDL_PropertiesID props)
+{
+    if (!props) {
+        SDL_InvalidParamError("props");
+        return NULL;
+    }
+
+    const char *file = SDL_GetStringProperty(props, IMG_PROP_LOAD_FILENAME_STRING, NULL);
+    SDL_IOStream *src = SDL_GetPointerProperty(props, IMG_PROP_LOAD_IOSTREAM_POINTER, NULL);
+    bool closeio = SDL_GetBooleanProperty(props, IMG_PROP_LOAD_IOSTREAM_AUTOCLOSE_BOOLEAN, false);
+    const char *type = SDL_GetStringProperty(props, IMG_PROP_LOAD_TYPE_STRING, NULL);
+
+    if (!src) {
+        if (!file) {
+            SDL_SetError("No input properties set");
+            return NULL;
+        }
+
+        src = SDL_IOFromFile(file, "rb");
+        if (!src) {
+            /* The error message has been set in SDL_IOFromFile */
+            return NULL;
+        }
+        closeio = true;
+    }
+
+    if ((!type || !*type) && file) {
+        type = SDL_strrchr(file, '.');
+        if (type) {
+            // Skip the '.' in the file extension
+            ++type;
+        }
+    }
+    return IMG_LoadTypedWithProperties_IO(src, closeio, type, props);
+}
+
 SDL_Texture *IMG_LoadTexture(SDL_Renderer *renderer, const char *file)
 {
     SDL_Texture *texture = NULL;
@@ -243,6 +295,45 @@ SDL_Texture *IMG_LoadTextureTyped_IO(SDL_Renderer *renderer, SDL_IOStream *src,
     return texture;
 }
 
+static SDL_Texture *IMG_CreateYUVTexture(SDL_Renderer *renderer, SDL_Surface *surface)
+{
+    SDL_Texture *texture;
+    SDL_PropertiesID props = SDL_CreateProperties();
+    if (!props) {
+        return NULL;
+    }
+    SDL_SetNumberProperty(props, SDL_PROP_TEXTURE_CREATE_FORMAT_NUMBER, surface->format);
+    SDL_SetNumberProperty(props, SDL_PROP_TEXTURE_CREATE_COLORSPACE_NUMBER, SDL_GetSurfaceColorspace(surface));
+    SDL_SetNumberProperty(props, SDL_PROP_TEXTURE_CREATE_ACCESS_NUMBER, SDL_TEXTUREACCESS_STATIC);
+    SDL_SetNumberProperty(props, SDL_PROP_TEXTURE_CREATE_WIDTH_NUMBER, surface->w);
+    SDL_SetNumberProperty(props, SDL_PROP_TEXTURE_CREATE_HEIGHT_NUMBER, surface->h);
+    texture = SDL_CreateTextureWithProperties(renderer, props);
+    SDL_DestroyProperties(props);
+
+    if (texture && !SDL_UpdateTexture(texture, NULL, surface->pixels, surface->pitch)) {
+        SDL_DestroyTexture(texture);
+        texture = NULL;
+    }
+    return texture;
+}
+
+SDL_Texture *IMG_LoadTextureWithProperties(SDL_Renderer *renderer, SDL_PropertiesID props)
+{
+    SDL_Texture *texture = NULL;
+    SDL_Surface *surface = IMG_LoadWithProperties(props);
+    if (surface) {
+        if (IMG_IsYUV420Format(surface->format)) {
+            // Upload the planes directly, the renderer will do the color conversion
+            texture = IMG_CreateYUVTexture(renderer, surface);
+        }
+        if (!texture) {
+            texture = SDL_CreateTextureFromSurface(renderer, surface);
+        }
+        SDL_DestroySurface(surface);
+    }
+    return texture;
+}
+
 /* Load an animation from a file */
 IMG_Animation *IMG_LoadAnimation(const char *file)
 {
@@ -368,8 +459,9 @@ bool IMG_Save(SDL_Surface *surface, const char *file)
     return IMG_SaveTyped_IO(surface, dst, true, type);
 }
 
-bool IMG_SaveTyped_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio, const char *type)
+static bool IMG_SaveTypedWithProperties_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio, const char *type, SDL_PropertiesID props)
 {
+    int quality;
     bool result = false;
 
     if (!surface) {
@@ -387,8 +479,14 @@ bool IMG_SaveTyped_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio, con
         goto done;
     }
 
+    quality = (int)SDL_GetNumberProperty(props, IMG_PROP_SAVE_QUALITY_NUMBER, 90);
+
     if (SDL_strcasecmp(type, "avif") == 0) {
-        result = IMG_SaveAVIF_IO(surface, dst, false, 90);
+        if (props) {
+            result = IMG_SaveAVIFWithProperties_IO(surface, dst, props);
+        } else {
+            result = IMG_SaveAVIF_IO(surface, dst, false, quality);
+        }
     } else if (SDL_strcasecmp(type, "bmp") == 0) {
         result = IMG_SaveBMP_IO(surface, dst, false);
     } else if (SDL_strcasecmp(type, "cur") == 0) {
@@ -399,13 +497,23 @@ bool IMG_SaveTyped_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio, con
         result = IMG_SaveICO_IO(surface, dst, false);
     } else if (SDL_strcasecmp(type, "jpg") == 0 ||
                SDL_strcasecmp(type, "jpeg") == 0) {
-        result = IMG_SaveJPG_IO(surface, dst, false, 90);
+        if (props) {
+            result = IMG_SaveJPGWithProperties_IO(surface, dst, props);
+        } else {
+            result = IMG_SaveJPG_IO(surface, dst, false, quality);
+        }
+    } else if (SDL_strcasecmp(type, "jxl") == 0) {
+        if (props) {
+            result = IMG_SaveJXLWithProperties_IO(surface, dst, props);
+        } else {
+            result = IMG_SaveJXL_IO(surface, dst, false, quality);
+        }
     } else if (SDL_strcasecmp(type, "png") == 0) {
         result = IMG_SavePNG_IO(surface, dst, false);
     } else if (SDL_strcasecmp(type, "tga") == 0) {
         result = IMG_SaveTGA_IO(surface, dst, false);
     } else if (SDL_strcasecmp(type, "webp") == 0) {
-        result = IMG_SaveWEBP_IO(surface, dst, false, 90.0f);
+        result = IMG_SaveWEBP_IO(surface, dst, false, (float)quality);
     } else {
         result = SDL_SetError("Unsupported image format");
     }
@@ -417,6 +525,60 @@ done:
     return result;
 }
 
+bool IMG_SaveTyped_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio, const char *type)
+{
+    return IMG_SaveTypedWithProperties_IO(surface, dst, closeio, type, 0);
+}
+
+bool IMG_SaveWithProperties(SDL_Surface *surface, SDL_PropertiesID props)
+{
+    if (!props) {
+        return SDL_InvalidParamError("props");
+    }
+
+    // Read the output stream first, so it's closed on every failure below
+    const char *file = SDL_GetStringProperty(props, IMG_PROP_SAVE_FILENAME_STRING, NULL);
+    SDL_IOStream *dst = SDL_GetPointerProperty(props, IMG_PROP_SAVE_IOSTREAM_POINTER, NULL);
+    bool closeio = SDL_GetBooleanProperty(props, IMG_PROP_SAVE_IOSTREAM_AUTOCLOSE_BOOLEAN, false);
+    const char *type = SDL_GetStringProperty(props, IMG_PROP_SAVE_TYPE_STRING, NULL);
+
+    if (!IMG_VerifyCanSaveSurface(surface)) {
+        goto error;
+    }
+
+    if ((!type || !*type) && file) {
+        type = SDL_strrchr(file, '.');
+        if (type) {
+            // Skip the '.' in the file extension
+            ++type;
+        }
+    }
+    if (!type || !*type) {
+        SDL_SetError("Couldn't determine file type");
+        goto error;
+    }
+
+    if (!dst) {
+        if (!file) {
+            return SDL_SetError("No output properties set");
+        }
+
+        dst = SDL_IOFromFile(file, "wb");
+        if (!dst) {
+            /* The error message has been set in SDL_IOFromFile */
+            return false;
+        }
+        closeio = true;
+    }
+    return IMG_SaveTypedWithProperties_IO(surface, dst, closeio, type, props);
+
+error:
+    if (dst && closeio) {
+        SDL_CloseIO(dst);
+    }
+    return false;
+}
+
 bool IMG_SaveAnimation(IMG_Animation *anim, const char *file)
 {
     if (!anim) {
@@ -563,8 +725,281 @@ Uint64 IMG_TimebaseDuration(Uint64 pts, Uint64 duration, Uint64 src_numerator, U
     return (a - b);
 }
 
+/* Pixels are moved in square tiles when transposing, so that the reads and
+ * the writes of a tile each stay within a handful of cache lines.
+ */
+#define ORIENT_BLOCK_SIZE   32
+
+typedef struct {
+    Uint8 v[3];
+} IMG_Pixel24;
+
+#define ORIENT_COPY_SPAN(TYPE)              \
+    for (x = 0; x < count; ++x) {           \
+        *(TYPE *)dst = *(const TYPE *)src;  \
+        src += sizeof(TYPE);                \
+        dst += step;                        \
+    }
+
+/* Copy count pixels from src to dst, advancing dst by step bytes per pixel */
+static void IMG_CopyPixelSpan(Uint8 *dst, Sint64 step, const Uint8 *src, int count, int bpp)
+{
+    int x;
+
+    switch (bpp) {
+    case 1:
+        ORIENT_COPY_SPAN(Uint8)
+        break;
+    case 2:
+        ORIENT_COPY_SPAN(Uint16)
+        break;
+    case 3:
+        ORIENT_COPY_SPAN(IMG_Pixel24)
+        break;
+    case 4:
+        ORIENT_COPY_SPAN(Uint32)
+        break;
+    default:
+        break;
+    }
+}
+
+#define ORIENT_SWAP_SPAN(TYPE)              \
+    for (x = 0; x < count; ++x) {           \
+        TYPE tmp = *(TYPE *)a;              \
+        *(TYPE *)a = *(TYPE *)b;            \
+        *(TYPE *)b = tmp;                   \
+        a += sizeof(TYPE);                  \
+        b -= sizeof(TYPE);                  \
+    }
+
+/* Swap count pixels walking forward from a with count pixels walking backward from b */
+static void IMG_SwapPixelSpanReversed(Uint8 *a, Uint8 *b, int count, int bpp)
+{
+    int x;
+
+    switch (bpp) {
+    case 1:
+        ORIENT_SWAP_SPAN(Uint8)
+        break;
+    case 2:
+        ORIENT_SWAP_SPAN(Uint16)
+        break;
+    case 3:
+        ORIENT_SWAP_SPAN(IMG_Pixel24)
+        break;
+    case 4:
+        ORIENT_SWAP_SPAN(Uint32)
+        break;
+    default:
+        break;
+    }
+}
+
+static void IMG_SwapRows(Uint8 *a, Uint8 *b, size_t length)
+{
+    Uint8 tmp[256];
+
+    while (length > 0) {
+        size_t chunk = SDL_min(length, sizeof(tmp));
+        SDL_memcpy(tmp, a, chunk);
+        SDL_memcpy(a, b, chunk);
+        SDL_memcpy(b, tmp, chunk);
+        a += chunk;
+        b += chunk;
+        length -= chunk;
+    }
+}
+
+void IMG_OrientPixelsRect(Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch,
+                          int w, int h, int x, int y, int cols, int rows, int bpp, int orientation)
+{
+    Uint8 *origin = dst;
+    Sint64 xstep, ystep;
+    int r, r0, x0;
+
+    /* Where the pixel at (0, 0) lands, and how far to move in dst for a step in x and in y */
+    switch (orientation) {
+    case 2:
+        origin += (Sint64)(w - 1) * bpp;
+        xstep = -bpp;
+        ystep = dst_pitch;
+        break;
+    case 3:
+        origin += (Sint64)(w - 1) * bpp + (Sint64)(h - 1) * dst_pitch;
+        xstep = -bpp;
+        ystep = -dst_pitch;
+        break;
+    case 4:
+        origin += (Sint64)(h - 1) * dst_pitch;
+        xstep = bpp;
+        ystep = -dst_pitch;
+        break;
+    case 5:
+        xstep = dst_pitch;
+        ystep = bpp;
+        break;
+    case 6:
+        origin += (Sint64)(h - 1) * bpp;
+        xstep = dst_pitch;
+        ystep = -bpp;
+        break;
+    case 7:
+        origin += (Sint64)(h - 1) * bpp + (Sint64)(w - 1) * dst_pitch;
+        xstep = -dst_pitch;
+        ystep = -bpp;
+        break;
+    case 8:
+        origin += (Sint64)(w - 1) * dst_pitch;
+        xstep = -dst_pitch;
+        ystep = bpp;
+        break;
+    default:
+        xstep = bpp;
+        ystep = dst_pitch;
+        break;
+    }
+
+    rows = SDL_min(rows, h - y);
+    cols = SDL_min(cols, w - x);
+    origin += (Sint64)x * xstep;
+    if (xstep == bpp || xstep == -bpp) {
+        /* Rows stay rows, so each one is a single sequential span */
+        for (r = 0; r < rows; ++r) {
+            Uint8 *d = origin + (Sint64)(y + r) * ystep;
+            const Uint8 *s = src + (Sint64)r * src_pitch;
+            if (xstep > 0) {
+                SDL_memcpy(d, s, (size_t)cols * bpp);
+            } else {
+                IMG_CopyPixelSpan(d, xstep, s, cols, bpp);
+            }
+        }
+        return;
+    }
+
+    for (r0 = 0; r0 < rows; r0 += ORIENT_BLOCK_SIZE) {
+        int r1 = SDL_min(r0 + ORIENT_BLOCK_SIZE, rows);
+        for (x0 = 0; x0 < cols; x0 += ORIENT_BLOCK_SIZE) {
+            int count = SDL_min(ORIENT_BLOCK_SIZE, cols - x0);
+            for (r = r0; r < r1; ++r) {
+                IMG_CopyPixelSpan(origin + (Sint64)(y + r) * ystep + (Sint64)x0 * xstep, xstep,
+                                  src + (Sint64)r * src_pitch + (Sint64)x0 * bpp, count, bpp);
+            }
+        }
+    }
+}
+
+void IMG_OrientPixels(Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch,
+                      int w, int h, int y, int rows, int bpp, int orientation)
+{
+    IMG_OrientPixelsRect(dst, dst_pitch, src, src_pitch, w, h, 0, y, w, rows, bpp, orientation);
+}
+
+void IMG_FlipPixels(Uint8 *pixels, int pitch, int w, int h, int bpp, int orientation)
+{
+    const size_t row_size = (size_t)w * bpp;
+    int top, bottom;
+
+    switch (orientation) {
+    case 2:
+        for (top = 0; top < h; ++top) {
+            Uint8 *row = pixels + (Sint64)top * pitch;
+            IMG_SwapPixelSpanReversed(row, row + row_size - bpp, w / 2, bpp);
+        }
+        break;
+    case 3:
+        for (top = 0, bottom = h - 1; top <= bottom; ++top, --bottom) {
+            Uint8 *a = pixels + (Sint64)top * pitch;
+            Uint8 *b = pixels + (Sint64)bottom * pitch;
+            IMG_SwapPixelSpanReversed(a, b + row_size - bpp, (top == bottom) ? w / 2 : w, bpp);
+        }
+        break;
+    case 4:
+        for (top = 0, bottom = h - 1; top < bottom; ++top, --bottom) {
+            IMG_SwapRows(pixels + (Sint64)top * pitch, pixels + (Sint64)bottom * pitch, row_size);
+        }
+        break;
+    default:
+        break;
+    }
+}
+
+static bool IMG_CanOrientSurface(SDL_Surface *surface)
+{
+    return !SDL_ISPIXELFORMAT_FOURCC(surface->format) &&
+           SDL_BITSPERPIXEL(surface->format) >= 8 &&
+           SDL_BYTESPERPIXEL(surface->format) <= 4 &&
+           !SDL_MUSTLOCK(surface);
+}
+
+SDL_Surface *IMG_OrientSurface(SDL_Surface *surface, int orientation)
+{
+    SDL_Surface *oriented;
+    int bpp;
+
+    if (orientation < 2 || orientation > 8) {
+        return surface;
+    }
+
+    if (!IMG_CanOrientSurface(surface)) {
+        /* Let SDL handle the unusual formats */
+        static const SDL_FlipMode flips[] = {
+            SDL_FLIP_NONE, SDL_FLIP_HORIZONTAL, SDL_FLIP_NONE, SDL_FLIP_VERTICAL,
+            SDL_FLIP_HORIZONTAL, SDL_FLIP_NONE, SDL_FLIP_HORIZONTAL, SDL_FLIP_NONE
+        };
+        static const float rotations[] = {
+            0.0f, 0.0f, 180.0f, 0.0f, 270.0f, 90.0f, 90.0f, 270.0f
+        };
+        SDL_FlipMode flip = flips[orientation - 1];
+        float rotation = rotations[orientation - 1];
+
+        if (flip != SDL_FLIP_NONE) {
+            if (!SDL_FlipSurface(surface, flip)) {
+                SDL_DestroySurface(surface);
+                return NULL;
+            }
+        }
+        if (rotation != 0.0f) {
+            SDL_Surface *tmp = SDL_RotateSurface(surface, rotation);
+            SDL_DestroySurface(surface);
+            surface = tmp;
+        }
+        return surface;
+    }
+
+    bpp = SDL_BYTESPERPIXEL(surface->format);
+    if (orientation <= 4) {
+        IMG_FlipPixels((Uint8 *)surface->pixels, surface->pitch, surface->w, surface->h, bpp, orientation);
+        return surface;
+    }
+
+    /* The image is transposed, so it needs a surface of a different shape */
+    oriented = SDL_CreateSurface(surface->h, surface->w, surface->format);
+    if (!oriented) {
+        SDL_DestroySurface(surface);
+        return NULL;
+    }
+    if (SDL_ISPIXELFORMAT_INDEXED(surface->format)) {
+        SDL_SetSurfacePalette(oriented, SDL_GetSurfacePalette(surface));
+    }
+    if (SDL_SurfaceHasColorKey(surface)) {
+        Uint32 key;
+        SDL_GetSurfaceColorKey(surface, &key);
+        SDL_SetSurfaceColorKey(oriented, true, key);
+    }
+    SDL_SetSurfaceColorspace(oriented, SDL_GetSurfaceColorspace(surface));
+    SDL_CopyProperties(SDL_GetSurfaceProperties(surface), SDL_GetSurfaceProperties(oriented));
+
+    IMG_OrientPixels((Uint8 *)oriented->pixels, oriented->pitch,
+                     (const Uint8 *)surface->pixels, surface->pitch,
+                     surface->w, surface->h, 0, surface->h, bpp, orientation);
+    SDL_DestroySurface(surface);
+    return oriented;
+}
+
 SDL_Surface *IMG_ApplyOrientation(SDL_Surface *surface, int orientation)
 {
+#ifdef ORIENTATION_USES_PROPERTIES
     float rotation = 0.0f;
     SDL_FlipMode flip = SDL_FLIP_NONE;
     switch (orientation) {
@@ -605,7 +1040,6 @@ SDL_Surface *IMG_ApplyOrientation(SDL_Surface *surface, int orientation)
         break;
     }
 
-#ifdef ORIENTATION_USES_PROPERTIES
     if (flip != SDL_FLIP_NONE) {
         SDL_PropertiesID props = SDL_GetSurfaceProperties(surface);
         SDL_SetNumberProperty(props, SDL_PROP_SURFACE_FLIP_NUMBER, flip);
@@ -614,21 +1048,94 @@ SDL_Surface *IMG_ApplyOrientation(SDL_Surface *surface, int orientation)
         SDL_PropertiesID props = SDL_GetSurfaceProperties(surface);
         SDL_SetFloatProperty(props, SDL_PROP_SURFACE_ROTATION_FLOAT, rotation);
     }
+    return surface;
 #else
-    if (flip != SDL_FLIP_NONE) {
-        if (!SDL_FlipSurface(surface, flip)) {
-            SDL_DestroySurface(surface);
-            return NULL;
-        }
+    return IMG_OrientSurface(surface, orientation);
+#endif
+}
+
+bool IMG_IsYUV420Format(SDL_PixelFormat format)
+{
+    switch (format) {
+    case SDL_PIXELFORMAT_YV12:
+    case SDL_PIXELFORMAT_IYUV:
+    case SDL_PIXELFORMAT_NV12:
+    case SDL_PIXELFORMAT_NV21:
+        return true;
+    default:
+        return false;
     }
-    if (rotation != 0.0f) {
-        SDL_Surface *tmp = SDL_RotateSurface(surface, rotation);
-        SDL_DestroySurface(surface);
-        if (!tmp) {
-            return NULL;
+}
+
+bool IMG_CopyYUV420ToSurface(SDL_Surface *surface, int y, int rows,
+                             const Uint8 *Y, int Y_pitch,
+                             const Uint8 *U, int U_pitch,
+                             const Uint8 *V, int V_pitch,
+                             int orientation)
+{
+    /* The source image is transposed for orientations 5 through 8 */
+    const int w = (orientation >= 5 && orientation <= 8) ? surface->h : surface->w;
+    const int h = (orientation >= 5 && orientation <= 8) ? surface->w : surface->h;
+    const int pitch = surface->pitch;
+    const int chroma_w = (w + 1) / 2;
+    const int chroma_h = (h + 1) / 2;
+    const int chroma_y = y / 2;
+    const int chroma_rows = (SDL_min(y + rows, h) + 1) / 2 - chroma_y;
+    Uint8 *dst = (Uint8 *)surface->pixels;
+    Uint8 *chroma = dst + (size_t)pitch * surface->h;
+    int row, col;
+
+    // The planes follow each other without padding, see SDL_Surface
+    IMG_OrientPixels(dst, pitch, Y, Y_pitch, w, h, y, rows, 1, orientation);
+
+    if (surface->format == SDL_PIXELFORMAT_IYUV || surface->format == SDL_PIXELFORMAT_YV12) {
+        const int chroma_pitch = (pitch + 1) / 2;
+        Uint8 *dst_u = chroma;
+        Uint8 *dst_v = chroma + (size_t)chroma_pitch * ((surface->h + 1) / 2);
+
+        if (surface->format == SDL_PIXELFORMAT_YV12) {
+            Uint8 *tmp = dst_u;
+            dst_u = dst_v;
+            dst_v = tmp;
+        }
+        IMG_OrientPixels(dst_u, chroma_pitch, U, U_pitch, chroma_w, chroma_h, chroma_y, chroma_rows, 1, orientation);
+        IMG_OrientPixels(dst_v, chroma_pitch, V, V_pitch, chroma_w, chroma_h, chroma_y, chroma_rows, 1, orientation);
+    } else {
+        const int chroma_pitch = ((pitch + 1) / 2) * 2;
+        Uint8 *dst_uv = chroma + (size_t)chroma_y * chroma_pitch;
+        Uint8 *interleaved = NULL;
+        int dst_uv_pitch = chroma_pitch;
+
+        if (surface->format == SDL_PIXELFORMAT_NV21) {
+            const Uint8 *tmp = U;
+            int tmp_pitch = U_pitch;
+            U = V;
+            U_pitch = V_pitch;
+            V = tmp;
+            V_pitch = tmp_pitch;
+        }
+        if (orientation >= 2 && orientation <= 8) {
+            /* Interleave aside, then move the pairs into place as 16-bit pixels */
+            dst_uv_pitch = chroma_w * 2;
+            interleaved = (Uint8 *)SDL_malloc((size_t)dst_uv_pitch * chroma_rows);
+            if (!interleaved) {
+                return false;
+            }
+            dst_uv = interleaved;
+        }
+        for (row = 0; row < chroma_rows; ++row) {
+            Uint8 *d = dst_uv + (size_t)row * dst_uv_pitch;
+            for (col = 0; col < chroma_w; ++col) {
+                *d++ = U[col];
+                *d++ = V[col];
+            }
+            U += U_pitch;
+            V += V_pitch;
+        }
+        if (interleaved) {
+            IMG_OrientPixels(chroma, chroma_pitch, interleaved, dst_uv_pitch, chroma_w, chroma_h, chroma_y, chroma_rows, 2, orientation);
+            SDL_free(interleaved);
         }
-        surface = tmp;
     }
-#endif
-    return surface;
+    return true;
 }
@@ -22,3 +22,27 @@
 #include <SDL3_image/SDL_image.h>
 
 extern bool IMG_VerifyCanSaveSurface(SDL_Surface *surface);
+
+extern SDL_Surface *IMG_LoadJPGWithProperties(SDL_IOStream *src, SDL_PropertiesID props);
+extern SDL_Surface *IMG_LoadSVGWithProperties(SDL_IOStream *src, SDL_PropertiesID props);
+extern SDL_Surface *IMG_LoadWEBPWithProperties(SDL_IOStream *src, SDL_PropertiesID props);
+extern SDL_Surface *IMG_LoadAVIFWithProperties(SDL_IOStream *src, SDL_PropertiesID props);
+extern SDL_Surface *IMG_LoadJXLWithProperties(SDL_IOStream *src, SDL_PropertiesID props);
+extern SDL_Surface *IMG_LoadTIFWithProperties(SDL_IOStream *src, SDL_PropertiesID props);
+extern SDL_Surface *IMG_LoadXCFWithProperties(SDL_IOStream *src, SDL_PropertiesID props);
+
+extern bool IMG_CreateJXLAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_PropertiesID props);
+extern bool IMG_CreateTIFAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_PropertiesID props);
+
+extern bool IMG_SaveAVIFWithProperties_IO(SDL_Surface *surface, SDL_IOStream *dst, SDL_PropertiesID props);
+extern bool IMG_SaveJPGWithProperties_IO(SDL_Surface *surface, SDL_IOStream *dst, SDL_PropertiesID props);
+extern bool IMG_SaveJXLWithProperties_IO(SDL_Surface *surface, SDL_IOStream *dst, SDL_PropertiesID props);
+
+extern bool IMG_InflateZlib(const Uint8 *src, size_t srclen, Uint8 *dst, size_t dstlen);
+
+extern bool IMG_IsYUV420Format(SDL_PixelFormat format);
+extern bool IMG_CopyYUV420ToSurface(SDL_Surface *surface, int y, int rows,
+                                    const Uint8 *Y, int Y_pitch,
+                                    const Uint8 *U, int U_pitch,
+                                    const Uint8 *V, int V_pitch,
+                                    int orientation);
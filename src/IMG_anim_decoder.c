@@ -21,6 +21,7 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG.h"
 #include "IMG_anim_decoder.h"
 #include "IMG_ani.h"
 #include "IMG_avif.h"
@@ -216,6 +217,10 @@ IMG_AnimationDecoder *IMG_CreateAnimationDecoderWithProperties(SDL_PropertiesID
         result = IMG_CreateAVIFAnimationDecoder(decoder, props);
     } else if (SDL_strcasecmp(type, "gif") == 0) {
         result = IMG_CreateGIFAnimationDecoder(decoder, props);
+    } else if (SDL_strcasecmp(type, "jxl") == 0) {
+        result = IMG_CreateJXLAnimationDecoder(decoder, props);
+    } else if (SDL_strcasecmp(type, "tif") == 0 || SDL_strcasecmp(type, "tiff") == 0) {
+        result = IMG_CreateTIFAnimationDecoder(decoder, props);
     } else if (SDL_strcasecmp(type, "webp") == 0) {
         result = IMG_CreateWEBPAnimationDecoder(decoder, props);
     }
@@ -469,6 +474,16 @@ IMG_Animation *IMG_LoadGIFAnimation_IO(SDL_IOStream *src)
     return IMG_DecodeAsAnimation(src, "gif", 0);
 }
 
+IMG_Animation *IMG_LoadJXLAnimation_IO(SDL_IOStream *src)
+{
+    return IMG_DecodeAsAnimation(src, "jxl", 0);
+}
+
+IMG_Animation *IMG_LoadTIFAnimation_IO(SDL_IOStream *src)
+{
+    return IMG_DecodeAsAnimation(src, "tif", 0);
+}
+
 IMG_Animation *IMG_LoadWEBPAnimation_IO(SDL_IOStream *src)
 {
     return IMG_DecodeAsAnimation(src, "webp", 0);
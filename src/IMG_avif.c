@@ -88,6 +88,10 @@ static struct {
 
     // XMP metadata support
     avifResult (*avifImageSetMetadataXMP)(avifImage * image, const uint8_t * xmp, size_t xmpSize);
+
+    // Region of interest support
+    avifImage * (*avifImageCreateEmpty)(void);
+    avifResult (*avifImageSetViewRect)(avifImage * dstImage, const avifImage * srcImage, const avifCropRect * rect);
 } lib;
 
 #ifdef LOAD_AVIF_DYNAMIC
@@ -133,6 +137,10 @@ static bool IMG_InitAVIF(void)
 
         // XMP metadata support
         FUNCTION_LOADER(avifImageSetMetadataXMP, avifResult (*)(avifImage * image, const uint8_t * xmp, size_t xmpSize))
+
+        // Region of interest support
+        FUNCTION_LOADER(avifImageCreateEmpty, avifImage * (*)(void))
+        FUNCTION_LOADER(avifImageSetViewRect, avifResult (*)(avifImage * dstImage, const avifImage * srcImage, const avifCropRect * rect))
     }
     ++lib.loaded;
 
@@ -367,16 +375,118 @@ static void ConvertRGB16toXBGR2101010(avifRGBImage *image, SDL_Surface *surface)
     }
 }
 
+/* Copy the planes of an 8-bit 4:2:0 image into a YUV surface, if SDL can represent it */
+static SDL_Surface *CreateYUV420Surface(const avifImage *image, SDL_PixelFormat format)
+{
+    SDL_MatrixCoefficients matrix;
+    SDL_Surface *surface;
+
+    if (image->depth != 8 || image->yuvFormat != AVIF_PIXEL_FORMAT_YUV420 || image->alphaPlane ||
+        image->transferCharacteristics == AVIF_TRANSFER_CHARACTERISTICS_SMPTE2084) {
+        return NULL;
+    }
+
+    switch (image->matrixCoefficients) {
+    case AVIF_MATRIX_COEFFICIENTS_UNSPECIFIED:
+        matrix = SDL_MATRIX_COEFFICIENTS_BT601;
+        break;
+    case AVIF_MATRIX_COEFFICIENTS_BT709:
+    case AVIF_MATRIX_COEFFICIENTS_BT470BG:
+    case AVIF_MATRIX_COEFFICIENTS_BT601:
+    case AVIF_MATRIX_COEFFICIENTS_BT2020_NCL:
+        matrix = (SDL_MatrixCoefficients)image->matrixCoefficients;
+        break;
+    default:
+        // Let avif do the conversion
+        return NULL;
+    }
+
+    surface = SDL_CreateSurface(image->width, image->height, format);
+    if (!surface) {
+        return NULL;
+    }
+    SDL_SetSurfaceColorspace(surface, SDL_DEFINE_COLORSPACE(SDL_COLOR_TYPE_YCBCR,
+                                                            image->yuvRange == AVIF_RANGE_FULL ? SDL_COLOR_RANGE_FULL : SDL_COLOR_RANGE_LIMITED,
+                                                            image->colorPrimaries,
+                                                            image->transferCharacteristics,
+                                                            matrix,
+                                                            SDL_CHROMA_LOCATION_LEFT));
+    IMG_CopyYUV420ToSurface(surface, 0, surface->h,
+                            image->yuvPlanes[AVIF_CHAN_Y], (int)image->yuvRowBytes[AVIF_CHAN_Y],
+                            image->yuvPlanes[AVIF_CHAN_U], (int)image->yuvRowBytes[AVIF_CHAN_U],
+                            image->yuvPlanes[AVIF_CHAN_V], (int)image->yuvRowBytes[AVIF_CHAN_V], 1);
+    return surface;
+}
+
+/* Use half of the logical cores unless the application asks for a thread count */
+static int GetAVIFMaxThreads(SDL_PropertiesID props, const char *name)
+{
+    int maxLCores = SDL_GetNumLogicalCPUCores();
+    int maxThreads = (int)SDL_GetNumberProperty(props, name, 0);
+
+    if (maxThreads <= 0) {
+        maxThreads = maxLCores / 2;
+    }
+    return SDL_clamp(maxThreads, 1, maxLCores);
+}
+
+/* Clip the requested crop rectangle to the image */
+static bool GetAVIFCropRect(const avifImage *image, SDL_PropertiesID props, SDL_Rect *rect)
+{
+    SDL_Rect bounds;
+
+    rect->x = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_CROP_X_NUMBER, 0);
+    rect->y = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_CROP_Y_NUMBER, 0);
+    rect->w = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_CROP_WIDTH_NUMBER, 0);
+    rect->h = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_CROP_HEIGHT_NUMBER, 0);
+
+    bounds.x = 0;
+    bounds.y = 0;
+    bounds.w = (int)image->width;
+    bounds.h = (int)image->height;
+
+    if (rect->w <= 0 || rect->h <= 0) {
+        *rect = bounds;
+    } else if (!SDL_GetRectIntersection(rect, &bounds, rect)) {
+        return SDL_SetError("The crop rectangle is outside the image");
+    }
+    return true;
+}
+
+/* Move the top left corner of the crop rectangle onto the chroma grid */
+static void GetAVIFViewRect(const avifImage *image, const SDL_Rect *rect, avifCropRect *crop)
+{
+    int x = rect->x, y = rect->y, w = rect->w, h = rect->h;
+
+    if (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV420 || image->yuvFormat == AVIF_PIXEL_FORMAT_YUV422) {
+        w += (x & 1);
+        x &= ~1;
+    }
+    if (image->yuvFormat == AVIF_PIXEL_FORMAT_YUV420) {
+        h += (y & 1);
+        y &= ~1;
+    }
+
+    crop->x = (uint32_t)x;
+    crop->y = (uint32_t)y;
+    crop->width = (uint32_t)w;
+    crop->height = (uint32_t)h;
+}
+
 /* Load a AVIF type image from an SDL datasource */
-SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
+SDL_Surface *IMG_LoadAVIFWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
 {
     Sint64 start;
     avifDecoder *decoder = NULL;
     avifImage *image;
+    avifImage *view = NULL;
+    SDL_Rect crop_rect;
     avifIO io;
     avifIOContext context;
     avifResult result;
     SDL_Surface *surface = NULL;
+    SDL_PixelFormat format = (SDL_PixelFormat)SDL_GetNumberProperty(props, IMG_PROP_LOAD_PIXEL_FORMAT_NUMBER, SDL_PIXELFORMAT_UNKNOWN);
+    int maxThreads = GetAVIFMaxThreads(props, IMG_PROP_LOAD_MAX_THREADS_NUMBER);
 
     if (!src) {
         /* The error message has been set in SDL_IOFromFile */
@@ -399,6 +509,7 @@ SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
 
     /* Be permissive so we can load as many images as possible */
     decoder->strictFlags = AVIF_STRICT_DISABLED;
+    decoder->maxThreads = maxThreads;
 
     context.src = src;
     context.start = start;
@@ -420,7 +531,33 @@ SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
     }
 
     image = decoder->image;
-    if (image->transferCharacteristics == AVIF_TRANSFER_CHARACTERISTICS_SMPTE2084) {
+
+    if (!GetAVIFCropRect(image, props, &crop_rect)) {
+        goto done;
+    }
+    if (crop_rect.w != (int)image->width || crop_rect.h != (int)image->height) {
+        avifCropRect crop;
+
+        /* Convert only the requested region, through a view of the decoded planes */
+        GetAVIFViewRect(image, &crop_rect, &crop);
+        view = lib.avifImageCreateEmpty();
+        if (!view) {
+            SDL_OutOfMemory();
+            goto done;
+        }
+        result = lib.avifImageSetViewRect(view, image, &crop);
+        if (result != AVIF_RESULT_OK) {
+            SDL_SetError("Couldn't crop AVIF image: %s", lib.avifResultToString(result));
+            goto done;
+        }
+        image = view;
+    }
+
+    if (IMG_IsYUV420Format(format)) {
+        surface = CreateYUV420Surface(image, format);
+    }
+
+    if (!surface && image->transferCharacteristics == AVIF_TRANSFER_CHARACTERISTICS_SMPTE2084) {
         // This is an HDR PQ image
 
         if (image->matrixCoefficients == AVIF_MATRIX_COEFFICIENTS_IDENTITY &&
@@ -448,6 +585,7 @@ SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
             rgb.depth = 16;
             rgb.format = AVIF_RGB_FORMAT_RGB;
             rgb.rowBytes = (uint32_t)image->width * 3 * sizeof(Uint16);
+            rgb.maxThreads = maxThreads;
             rgb.pixels = (uint8_t *)SDL_malloc(image->height * rgb.rowBytes);
             if (!rgb.pixels) {
                 goto done;
@@ -520,6 +658,8 @@ SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
 #endif
         rgb.pixels = (uint8_t *)surface->pixels;
         rgb.rowBytes = (uint32_t)surface->pitch;
+        /* libavif splits the conversion into bands of rows across threads */
+        rgb.maxThreads = maxThreads;
         result = lib.avifImageYUVToRGB(image, &rgb);
         if (result != AVIF_RESULT_OK) {
             SDL_SetError("Couldn't convert AVIF image to RGB: %s", lib.avifResultToString(result));
@@ -530,6 +670,9 @@ SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
     }
 
 done:
+    if (view) {
+        lib.avifImageDestroy(view);
+    }
     if (decoder) {
         lib.avifDecoderDestroy(decoder);
     }
@@ -539,7 +682,127 @@ done:
     return surface;
 }
 
-static bool IMG_SaveAVIF_IO_libavif(SDL_Surface *surface, SDL_IOStream *dst, int quality)
+SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
+{
+    return IMG_LoadAVIFWithProperties(src, 0);
+}
+
+/* Encode the planes of an 8-bit 4:2:0 YUV surface as they are, without going through RGB.
+ * Planar surfaces are used in place, semi-planar chroma is split into *chroma, which the
+ * caller frees after destroying the image.
+ */
+static avifImage *CreateAVIFImageFromYUV420(SDL_Surface *surface, Uint8 **chroma)
+{
+    const SDL_Colorspace colorspace = SDL_GetSurfaceColorspace(surface);
+    const int chroma_w = (surface->w + 1) / 2;
+    const int chroma_h = (surface->h + 1) / 2;
+    Uint8 *y = (Uint8 *)surface->pixels;
+    Uint8 *u, *v;
+    int chroma_pitch;
+    avifImage *image;
+
+    *chroma = NULL;
+
+    if (surface->format == SDL_PIXELFORMAT_IYUV || surface->format == SDL_PIXELFORMAT_YV12) {
+        chroma_pitch = (surface->pitch + 1) / 2;
+        u = y + (size_t)surface->pitch * surface->h;
+        v = u + (size_t)chroma_pitch * chroma_h;
+        if (surface->format == SDL_PIXELFORMAT_YV12) {
+            Uint8 *tmp = u;
+            u = v;
+            v = tmp;
+        }
+    } else {
+        const int uv_pitch = ((surface->pitch + 1) / 2) * 2;
+        const Uint8 *uv = y + (size_t)surface->pitch * surface->h;
+        int row, col;
+
+        chroma_pitch = chroma_w;
+        *chroma = (Uint8 *)SDL_malloc((size_t)chroma_pitch * chroma_h * 2);
+        if (!*chroma) {
+            return NULL;
+        }
+        u = *chroma;
+        v = u + (size_t)chroma_pitch * chroma_h;
+        if (surface->format == SDL_PIXELFORMAT_NV21) {
+            Uint8 *tmp = u;
+            u = v;
+            v = tmp;
+        }
+        for (row = 0; row < chroma_h; ++row) {
+            const Uint8 *src = uv + (size_t)row * uv_pitch;
+            Uint8 *dst_u = u + (size_t)row * chroma_pitch;
+            Uint8 *dst_v = v + (size_t)row * chroma_pitch;
+            for (col = 0; col < chroma_w; ++col) {
+                dst_u[col] = src[2 * col + 0];
+                dst_v[col] = src[2 * col + 1];
+            }
+        }
+    }
+
+    image = lib.avifImageCreate(surface->w, surface->h, 8, AVIF_PIXEL_FORMAT_YUV420);
+    if (!image) {
+        SDL_free(*chroma);
+        *chroma = NULL;
+        SDL_SetError("Couldn't create AVIF YUV image");
+        return NULL;
+    }
+    image->yuvRange = (SDL_COLORSPACERANGE(colorspace) == SDL_COLOR_RANGE_FULL) ? AVIF_RANGE_FULL : AVIF_RANGE_LIMITED;
+    image->colorPrimaries = (avifColorPrimaries)SDL_COLORSPACEPRIMARIES(colorspace);
+    image->transferCharacteristics = (avifTransferCharacteristics)SDL_COLORSPACETRANSFER(colorspace);
+    image->matrixCoefficients = (avifMatrixCoefficients)SDL_COLORSPACEMATRIX(colorspace);
+    switch (SDL_COLORSPACECHROMA(colorspace)) {
+    case SDL_CHROMA_LOCATION_LEFT:
+        image->yuvChromaSamplePosition = AVIF_CHROMA_SAMPLE_POSITION_VERTICAL;
+        break;
+    case SDL_CHROMA_LOCATION_TOPLEFT:
+        image->yuvChromaSamplePosition = AVIF_CHROMA_SAMPLE_POSITION_COLOCATED;
+        break;
+    default:
+        image->yuvChromaSamplePosition = AVIF_CHROMA_SAMPLE_POSITION_UNKNOWN;
+        break;
+    }
+
+    image->yuvPlanes[AVIF_CHAN_Y] = y;
+    image->yuvRowBytes[AVIF_CHAN_Y] = (uint32_t)surface->pitch;
+    image->yuvPlanes[AVIF_CHAN_U] = u;
+    image->yuvRowBytes[AVIF_CHAN_U] = (uint32_t)chroma_pitch;
+    image->yuvPlanes[AVIF_CHAN_V] = v;
+    image->yuvRowBytes[AVIF_CHAN_V] = (uint32_t)chroma_pitch;
+    image->imageOwnsYUVPlanes = AVIF_FALSE;
+    return image;
+}
+
+/* Split the image into roughly one tile per thread, keeping tiles at least 512x512 pixels */
+static void SetAVIFEncoderTiling(avifEncoder *encoder, int width, int height, SDL_PropertiesID props)
+{
+    const int min_tile_size = 512;
+    int tileRowsLog2 = (int)SDL_GetNumberProperty(props, IMG_PROP_SAVE_AVIF_TILE_ROWS_LOG2_NUMBER, -1);
+    int tileColsLog2 = (int)SDL_GetNumberProperty(props, IMG_PROP_SAVE_AVIF_TILE_COLS_LOG2_NUMBER, -1);
+
+    if (tileRowsLog2 < 0 && tileColsLog2 < 0) {
+        tileRowsLog2 = 0;
+        tileColsLog2 = 0;
+        while ((2 << (tileRowsLog2 + tileColsLog2)) <= encoder->maxThreads) {
+            if ((width >> tileColsLog2) >= (height >> tileRowsLog2)) {
+                if ((width >> (tileColsLog2 + 1)) < min_tile_size) {
+                    break;
+                }
+                ++tileColsLog2;
+            } else {
+                if ((height >> (tileRowsLog2 + 1)) < min_tile_size) {
+                    break;
+                }
+                ++tileRowsLog2;
+            }
+        }
+    }
+    encoder->autoTiling = AVIF_FALSE;
+    encoder->tileRowsLog2 = SDL_clamp(tileRowsLog2, 0, 6);
+    encoder->tileColsLog2 = SDL_clamp(tileColsLog2, 0, 6);
+}
+
+static bool IMG_SaveAVIF_IO_libavif(SDL_Surface *surface, SDL_IOStream *dst, int quality, SDL_PropertiesID props)
 {
     avifImage *image = NULL;
     avifRGBImage rgb;
@@ -548,7 +811,8 @@ static bool IMG_SaveAVIF_IO_libavif(SDL_Surface *surface, SDL_IOStream *dst, int
     avifResult rc;
     SDL_Colorspace colorspace;
     Uint16 maxCLL, maxFALL;
-    SDL_PropertiesID props;
+    SDL_PropertiesID surface_props;
+    Uint8 *chroma = NULL;
     bool result = false;
 
     if (!IMG_InitAVIF()) {
@@ -557,25 +821,34 @@ static bool IMG_SaveAVIF_IO_libavif(SDL_Surface *surface, SDL_IOStream *dst, int
 
     /* Get the colorspace and light level properties, if any */
     colorspace = SDL_GetSurfaceColorspace(surface);
-    props = SDL_GetSurfaceProperties(surface);
-    maxCLL = (Uint16)SDL_GetNumberProperty(props, SDL_PROP_SURFACE_MAXCLL_NUMBER, 0);
-    maxFALL = (Uint16)SDL_GetNumberProperty(props, SDL_PROP_SURFACE_MAXFALL_NUMBER, 0);
+    surface_props = SDL_GetSurfaceProperties(surface);
+    maxCLL = (Uint16)SDL_GetNumberProperty(surface_props, SDL_PROP_SURFACE_MAXCLL_NUMBER, 0);
+    maxFALL = (Uint16)SDL_GetNumberProperty(surface_props, SDL_PROP_SURFACE_MAXFALL_NUMBER, 0);
 
     SDL_zero(rgb);
-    image = lib.avifImageCreate(surface->w, surface->h, 10, AVIF_PIXEL_FORMAT_YUV444);
-    if (!image) {
-        SDL_SetError("Couldn't create AVIF YUV image");
-        goto done;
+    if (IMG_IsYUV420Format(surface->format)) {
+        image = CreateAVIFImageFromYUV420(surface, &chroma);
+        if (!image) {
+            goto done;
+        }
+    } else {
+        image = lib.avifImageCreate(surface->w, surface->h, 10, AVIF_PIXEL_FORMAT_YUV444);
+        if (!image) {
+            SDL_SetError("Couldn't create AVIF YUV image");
+            goto done;
+        }
+        image->yuvRange = AVIF_RANGE_FULL;
+        image->colorPrimaries = (avifColorPrimaries)SDL_COLORSPACEPRIMARIES(colorspace);
+        image->transferCharacteristics = (avifTransferCharacteristics)SDL_COLORSPACETRANSFER(colorspace);
     }
-    image->yuvRange = AVIF_RANGE_FULL;
-    image->colorPrimaries = (avifColorPrimaries)SDL_COLORSPACEPRIMARIES(colorspace);
-    image->transferCharacteristics = (avifTransferCharacteristics)SDL_COLORSPACETRANSFER(colorspace);
     image->clli.maxCLL = maxCLL;
     image->clli.maxPALL = maxFALL;
 
     lib.avifRGBImageSetDefaults(&rgb, image);
 
-    if (SDL_ISPIXELFORMAT_10BIT(surface->format)) {
+    if (IMG_IsYUV420Format(surface->format)) {
+        /* The YUV planes are already in place */
+    } else if (SDL_ISPIXELFORMAT_10BIT(surface->format)) {
         const Uint16 expand_alpha[] = {
             0, 0x155, 0x2aa, 0x3ff
         };
@@ -685,9 +958,16 @@ static bool IMG_SaveAVIF_IO_libavif(SDL_Surface *surface, SDL_IOStream *dst, int
     }
 
     encoder = lib.avifEncoderCreate();
+    if (!encoder) {
+        SDL_SetError("Couldn't create AVIF encoder");
+        goto done;
+    }
     encoder->quality = quality;
     encoder->qualityAlpha = AVIF_QUALITY_LOSSLESS;
-    encoder->speed = AVIF_SPEED_FASTEST;
+    encoder->speed = (int)SDL_GetNumberProperty(props, IMG_PROP_SAVE_AVIF_SPEED_NUMBER, AVIF_SPEED_FASTEST);
+    encoder->speed = SDL_clamp(encoder->speed, AVIF_SPEED_SLOWEST, AVIF_SPEED_FASTEST);
+    encoder->maxThreads = GetAVIFMaxThreads(props, IMG_PROP_SAVE_MAX_THREADS_NUMBER);
+    SetAVIFEncoderTiling(encoder, surface->w, surface->h, props);
 
     rc = lib.avifEncoderAddImage(encoder, image, 1, AVIF_ADD_IMAGE_FLAG_SINGLE);
     if (rc != AVIF_RESULT_OK) {
@@ -712,6 +992,9 @@ done:
     if (image) {
         lib.avifImageDestroy(image);
     }
+    if (chroma) {
+        SDL_free(chroma);
+    }
     if (encoder) {
         lib.avifEncoderDestroy(encoder);
     }
@@ -738,6 +1021,12 @@ SDL_Surface *IMG_LoadAVIF_IO(SDL_IOStream *src)
     return NULL;
 }
 
+SDL_Surface *IMG_LoadAVIFWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    SDL_SetError("SDL_image built without AVIF support");
+    return NULL;
+}
+
 #endif /* LOAD_AVIF */
 
 #if SAVE_AVIF
@@ -754,7 +1043,7 @@ bool IMG_SaveAVIF_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio, int
         goto done;
     }
 
-    result = IMG_SaveAVIF_IO_libavif(surface, dst, quality);
+    result = IMG_SaveAVIF_IO_libavif(surface, dst, quality, 0);
 
 done:
     if (closeio) {
@@ -763,6 +1052,19 @@ done:
     return result;
 }
 
+bool IMG_SaveAVIFWithProperties_IO(SDL_Surface *surface, SDL_IOStream *dst, SDL_PropertiesID props)
+{
+    int quality = (int)SDL_GetNumberProperty(props, IMG_PROP_SAVE_QUALITY_NUMBER, 90);
+
+    if (!IMG_VerifyCanSaveSurface(surface)) {
+        return false;
+    }
+    if (!dst) {
+        return SDL_InvalidParamError("dst");
+    }
+    return IMG_SaveAVIF_IO_libavif(surface, dst, quality, props);
+}
+
 bool IMG_SaveAVIF(SDL_Surface *surface, const char *file, int quality)
 {
     if (!IMG_VerifyCanSaveSurface(surface)) {
@@ -789,6 +1091,11 @@ bool IMG_SaveAVIF(SDL_Surface *surface, const char *file, int quality)
     return SDL_SetError("SDL_image built without AVIF save support");
 }
 
+bool IMG_SaveAVIFWithProperties_IO(SDL_Surface *surface, SDL_IOStream *dst, SDL_PropertiesID props)
+{
+    return SDL_SetError("SDL_image built without AVIF save support");
+}
+
 #endif // SAVE_AVIF
 
 #ifdef LOAD_AVIF
@@ -1103,10 +1410,7 @@ bool IMG_CreateAVIFAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_Propertie
 
     ctx->current_frame = 0;
 
-    int maxLCores = SDL_GetNumLogicalCPUCores();
-    int maxThreads = (int)SDL_GetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_AVIF_MAX_THREADS_NUMBER, maxLCores / 2);
-    maxThreads = SDL_clamp(maxThreads, 1, maxLCores);
-    ctx->decoder->maxThreads = maxThreads;
+    ctx->decoder->maxThreads = GetAVIFMaxThreads(props, IMG_PROP_ANIMATION_DECODER_CREATE_AVIF_MAX_THREADS_NUMBER);
 
     bool allowProgressive = SDL_GetBooleanProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_AVIF_ALLOW_PROGRESSIVE_BOOLEAN, true);
     ctx->decoder->allowProgressive = allowProgressive ? AVIF_TRUE : AVIF_FALSE;
@@ -1225,6 +1529,8 @@ static bool AnimationEncoder_AddFrame(IMG_AnimationEncoder *encoder, SDL_Surface
                    surface->format == SDL_PIXELFORMAT_BGRA64 ||
                    surface->format == SDL_PIXELFORMAT_ABGR64);
     bool hasAlpha = SDL_ISPIXELFORMAT_ALPHA(surface->format);
+    bool isYUV = IMG_IsYUV420Format(surface->format);
+    Uint8 *chroma = NULL;
 
     durationInTimescales = duration * encoder->timebase_numerator;
     colorspace = SDL_GetSurfaceColorspace(surface);
@@ -1235,9 +1541,16 @@ static bool AnimationEncoder_AddFrame(IMG_AnimationEncoder *encoder, SDL_Surface
     uint32_t depth = is16bit ? 16 : (is10bit ? 10 : 8);
     avifPixelFormat pixelFormat = (isLossless) ? AVIF_PIXEL_FORMAT_NONE : AVIF_PIXEL_FORMAT_YUV444;
 
-    image = lib.avifImageCreate(surface->w, surface->h, depth, pixelFormat);
-    if (!image) {
-        return SDL_SetError("Couldn't create AVIF image");
+    if (isYUV) {
+        image = CreateAVIFImageFromYUV420(surface, &chroma);
+        if (!image) {
+            return false;
+        }
+    } else {
+        image = lib.avifImageCreate(surface->w, surface->h, depth, pixelFormat);
+        if (!image) {
+            return SDL_SetError("Couldn't create AVIF image");
+        }
     }
 
     if (!encoder->ctx->first_frame_added && IMG_HasMetadata(encoder->ctx->metadata)) {
@@ -1245,25 +1558,29 @@ static bool AnimationEncoder_AddFrame(IMG_AnimationEncoder *encoder, SDL_Surface
         uint8_t *xmp_data = __xmlman_ConstructXMPWithRDFDescription(SDL_GetStringProperty(encoder->ctx->metadata, IMG_PROP_METADATA_TITLE_STRING, NULL), SDL_GetStringProperty(encoder->ctx->metadata, IMG_PROP_METADATA_AUTHOR_STRING, NULL), SDL_GetStringProperty(encoder->ctx->metadata, IMG_PROP_METADATA_DESCRIPTION_STRING, NULL), SDL_GetStringProperty(encoder->ctx->metadata, IMG_PROP_METADATA_COPYRIGHT_STRING, NULL), SDL_GetStringProperty(encoder->ctx->metadata, IMG_PROP_METADATA_CREATION_TIME_STRING, NULL), &outlen);
         if (!xmp_data || outlen < 1) {
             lib.avifImageDestroy(image);
+            SDL_free(chroma);
             return SDL_SetError("Couldn't create XMP data for AVIF image");
         }
         avifResult ar = lib.avifImageSetMetadataXMP(image, xmp_data, outlen);
         if (ar != AVIF_RESULT_OK) {
             lib.avifImageDestroy(image);
+            SDL_free(chroma);
             SDL_free(xmp_data);
             return SDL_SetError("Couldn't set XMP metadata for AVIF image: %s", lib.avifResultToString(ar));
         }
         SDL_free(xmp_data);
     }
 
-    image->yuvRange = AVIF_RANGE_FULL;
-    image->colorPrimaries = (avifColorPrimaries)SDL_COLORSPACEPRIMARIES(colorspace);
-    image->transferCharacteristics = (avifTransferCharacteristics)SDL_COLORSPACETRANSFER(colorspace);
+    if (!isYUV) {
+        image->yuvRange = AVIF_RANGE_FULL;
+        image->colorPrimaries = (avifColorPrimaries)SDL_COLORSPACEPRIMARIES(colorspace);
+        image->transferCharacteristics = (avifTransferCharacteristics)SDL_COLORSPACETRANSFER(colorspace);
 
-    if (is10bit || is16bit || isLossless) {
-        image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_IDENTITY;
-    } else {
-        image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_BT709;
+        if (is10bit || is16bit || isLossless) {
+            image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_IDENTITY;
+        } else {
+            image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_BT709;
+        }
     }
 
     image->clli.maxCLL = maxCLL;
@@ -1275,12 +1592,15 @@ static bool AnimationEncoder_AddFrame(IMG_AnimationEncoder *encoder, SDL_Surface
     if (SDL_MUSTLOCK(surface)) {
         if (!SDL_LockSurface(surface)) {
             lib.avifImageDestroy(image);
+            SDL_free(chroma);
             return SDL_SetError("Couldn't lock surface for reading");
         }
         lockedSurf = true;
     }
 
-    if (is16bit) {
+    if (isYUV) {
+        // The YUV planes are already in place
+    } else if (is16bit) {
         rgb.depth = 16;
 
         switch (surface->format) {
@@ -1504,6 +1824,7 @@ static bool AnimationEncoder_AddFrame(IMG_AnimationEncoder *encoder, SDL_Surface
     }
 
     lib.avifImageDestroy(image);
+    SDL_free(chroma);
 
     if (rc != AVIF_RESULT_OK) {
         return SDL_SetError("Failed to add image to avif encoder: %s", lib.avifResultToString(rc));
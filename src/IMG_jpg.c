@@ -22,6 +22,10 @@
 /* This is a JPEG image file loading framework */
 
 #include <SDL3_image/SDL_image.h>
+#include <SDL3/SDL_intrin.h>
+
+#include "IMG.h"
+#include "IMG_utils.h"
 
 #include <stdio.h>
 #include <setjmp.h>
@@ -44,8 +48,467 @@
 #define WANT_JPEGLIB
 #endif
 
+#if (defined(LOAD_JPG) && defined(WANT_JPEGLIB)) || (SAVE_JPG && (defined(LOAD_JPG_DYNAMIC) || !defined(WANT_JPEGLIB)))
+
+/* Large images are saved by encoding horizontal bands of MCU rows on several
+ * threads. Each band is encoded as a complete JPEG image and, since the bands
+ * are separated by restart markers, their entropy coded data can be joined
+ * into a single baseline JPEG image with the header of the first band.
+ */
+#define JPEG_MIN_BAND_PIXELS    (256 * 1024)
+
+typedef bool (*JPEG_Encoder)(SDL_Surface *surface, SDL_IOStream *dst, int quality);
+
+typedef struct
+{
+    SDL_Surface *surface;
+    int quality;
+    JPEG_Encoder encode;
+    int band_height;
+    int num_bands;
+    SDL_AtomicInt next_band;
+    SDL_AtomicInt failed;
+    SDL_IOStream **bands;
+} JPEG_BandContext;
+
+static int SDLCALL JPEG_EncodeBands(void *data)
+{
+    JPEG_BandContext *ctx = (JPEG_BandContext *)data;
+    SDL_Surface *surface = ctx->surface;
+    int band;
+
+    while ((band = SDL_AddAtomicInt(&ctx->next_band, 1)) < ctx->num_bands) {
+        int y = band * ctx->band_height;
+        int h = SDL_min(ctx->band_height, surface->h - y);
+        SDL_Surface *strip;
+
+        if (SDL_GetAtomicInt(&ctx->failed)) {
+            break;
+        }
+        strip = SDL_CreateSurfaceFrom(surface->w, h, surface->format, (Uint8 *)surface->pixels + (size_t)y * surface->pitch, surface->pitch);
+        ctx->bands[band] = SDL_IOFromDynamicMem();
+        if (!strip || !ctx->bands[band] || !ctx->encode(strip, ctx->bands[band], ctx->quality)) {
+            SDL_SetAtomicInt(&ctx->failed, 1);
+        }
+        SDL_DestroySurface(strip);
+    }
+    return 0;
+}
+
+/* Find the frame header, the scan header and the entropy coded data of a band */
+static bool JPEG_ParseBand(SDL_IOStream *band, const Uint8 **data, size_t *size, size_t *sof, size_t *sos, size_t *scan)
+{
+    size_t offset = 2;
+
+    *data = (const Uint8 *)SDL_GetPointerProperty(SDL_GetIOProperties(band), SDL_PROP_IOSTREAM_DYNAMIC_MEMORY_POINTER, NULL);
+    *size = (size_t)SDL_TellIO(band);
+    *sof = 0;
+    if (!*data || *size < 4 || (*data)[0] != 0xFF || (*data)[1] != 0xD8) {
+        return false;
+    }
+    while (offset + 4 <= *size && (*data)[offset] == 0xFF) {
+        Uint8 marker = (*data)[offset + 1];
+        size_t length = ((size_t)(*data)[offset + 2] << 8) | (*data)[offset + 3];
+
+        if (length < 2 || offset + 2 + length > *size || marker == 0xDD) {
+            /* Truncated, or the encoder is already using restart intervals */
+            return false;
+        }
+        if (marker == 0xC0) {
+            *sof = offset;
+        } else if (marker == 0xDA) {
+            *sos = offset;
+            *scan = offset + 2 + length;
+            return *sof != 0 && *scan <= *size - 2 &&
+                   (*data)[*size - 2] == 0xFF && (*data)[*size - 1] == 0xD9;
+        }
+        offset += 2 + length;
+    }
+    return false;
+}
+
+static bool JPEG_JoinBands(JPEG_BandContext *ctx, int mcu_size, SDL_IOStream *dst)
+{
+    const Uint8 *data;
+    size_t size, sof, sos, scan;
+    Uint16 restart_interval;
+    Uint8 segment[6];
+    int band;
+
+    if (!JPEG_ParseBand(ctx->bands[0], &data, &size, &sof, &sos, &scan)) {
+        return false;
+    }
+
+    /* The header of the first band, with the height of the whole image */
+    segment[0] = (Uint8)(ctx->surface->h >> 8);
+    segment[1] = (Uint8)ctx->surface->h;
+    if (SDL_WriteIO(dst, data, sof + 5) != sof + 5 ||
+        SDL_WriteIO(dst, segment, 2) != 2 ||
+        SDL_WriteIO(dst, data + sof + 7, sos - sof - 7) != sos - sof - 7) {
+        return false;
+    }
+
+    /* Each band is one restart interval */
+    restart_interval = (Uint16)(((ctx->surface->w + mcu_size - 1) / mcu_size) * (ctx->band_height / mcu_size));
+    segment[0] = 0xFF;
+    segment[1] = 0xDD;
+    segment[2] = 0;
+    segment[3] = 4;
+    segment[4] = (Uint8)(restart_interval >> 8);
+    segment[5] = (Uint8)restart_interval;
+    if (SDL_WriteIO(dst, segment, 6) != 6 ||
+        SDL_WriteIO(dst, data + sos, size - 2 - sos) != size - 2 - sos) {
+        return false;
+    }
+
+    for (band = 1; band < ctx->num_bands; ++band) {
+        if (!JPEG_ParseBand(ctx->bands[band], &data, &size, &sof, &sos, &scan)) {
+            return false;
+        }
+        segment[0] = 0xFF;
+        segment[1] = (Uint8)(0xD0 + ((band - 1) & 7));
+        if (SDL_WriteIO(dst, segment, 2) != 2 ||
+            SDL_WriteIO(dst, data + scan, size - 2 - scan) != size - 2 - scan) {
+            return false;
+        }
+    }
+
+    segment[0] = 0xFF;
+    segment[1] = 0xD9;
+    return SDL_WriteIO(dst, segment, 2) == 2;
+}
+
+/* Use half of the logical cores unless the application asks for a thread count */
+static int JPEG_GetMaxThreads(SDL_PropertiesID props)
+{
+    int maxLCores = SDL_GetNumLogicalCPUCores();
+    int maxThreads = (int)SDL_GetNumberProperty(props, IMG_PROP_SAVE_MAX_THREADS_NUMBER, 0);
+
+    if (maxThreads <= 0) {
+        maxThreads = maxLCores / 2;
+    }
+    return SDL_clamp(maxThreads, 1, maxLCores);
+}
+
+/* Returns false if the image was not saved in bands, and should be encoded in one piece */
+static bool JPEG_SaveBands_IO(SDL_Surface *surface, SDL_IOStream *dst, int quality, int mcu_size, JPEG_Encoder encode, SDL_PropertiesID props)
+{
+    JPEG_BandContext ctx;
+    SDL_Thread **threads = NULL;
+    int num_threads = JPEG_GetMaxThreads(props);
+    int mcus_per_row = (surface->w + mcu_size - 1) / mcu_size;
+    int mcu_rows = (surface->h + mcu_size - 1) / mcu_size;
+    int rows_per_band;
+    Sint64 start;
+    bool result = false;
+    int i;
+
+    num_threads = (int)SDL_min(num_threads, ((Sint64)surface->w * surface->h) / JPEG_MIN_BAND_PIXELS);
+    num_threads = SDL_min(num_threads, mcu_rows);
+    if (num_threads < 2) {
+        return false;
+    }
+
+    /* The restart interval is a 16-bit count of MCUs */
+    rows_per_band = (mcu_rows + num_threads - 1) / num_threads;
+    rows_per_band = SDL_min(rows_per_band, 0xFFFF / mcus_per_row);
+    if (rows_per_band < 1) {
+        return false;
+    }
+
+    SDL_zero(ctx);
+    ctx.surface = surface;
+    ctx.quality = quality;
+    ctx.encode = encode;
+    ctx.band_height = rows_per_band * mcu_size;
+    ctx.num_bands = (mcu_rows + rows_per_band - 1) / rows_per_band;
+    ctx.bands = (SDL_IOStream **)SDL_calloc(ctx.num_bands, sizeof(*ctx.bands));
+    threads = (SDL_Thread **)SDL_calloc(num_threads, sizeof(*threads));
+    if (!ctx.bands || !threads) {
+        goto done;
+    }
+
+    /* This thread encodes bands too, and picks up any that other threads couldn't */
+    for (i = 1; i < num_threads; ++i) {
+        threads[i] = SDL_CreateThread(JPEG_EncodeBands, "SDL_image JPEG", &ctx);
+    }
+    JPEG_EncodeBands(&ctx);
+    for (i = 1; i < num_threads; ++i) {
+        if (threads[i]) {
+            SDL_WaitThread(threads[i], NULL);
+        }
+    }
+
+    if (!SDL_GetAtomicInt(&ctx.failed)) {
+        start = SDL_TellIO(dst);
+        result = JPEG_JoinBands(&ctx, mcu_size, dst);
+        if (!result) {
+            SDL_SeekIO(dst, start, SDL_IO_SEEK_SET);
+        }
+    }
+
+done:
+    if (ctx.bands) {
+        for (i = 0; i < ctx.num_bands; ++i) {
+            if (ctx.bands[i]) {
+                SDL_CloseIO(ctx.bands[i]);
+            }
+        }
+        SDL_free(ctx.bands);
+    }
+    SDL_free(threads);
+    return result;
+}
+
+#endif /* libjpeg or tinyjpeg encoder */
+
 #ifdef LOAD_JPG
 
+/* Give up looking for metadata after this many header segments */
+#define JPEG_MAX_HEADER_SEGMENTS    64
+
+/* Read the payload of the EXIF APP1 segment, if there is one before the first scan */
+static Uint8 *JPEG_ReadEXIF(SDL_IOStream *src, size_t *size)
+{
+    Sint64 start = SDL_TellIO(src);
+    Uint8 *exif = NULL;
+    Uint8 marker[2];
+    int segments;
+
+    if (SDL_ReadIO(src, marker, 2) != 2 || marker[0] != 0xFF || marker[1] != 0xD8) {
+        goto done;
+    }
+    for (segments = 0; segments < JPEG_MAX_HEADER_SEGMENTS; ++segments) {
+        Uint16 length;
+
+        if (SDL_ReadIO(src, marker, 2) != 2 || marker[0] != 0xFF) {
+            break;
+        }
+        if (marker[1] == 0xFF) {
+            /* Fill byte, the marker starts at the next one */
+            SDL_SeekIO(src, -1, SDL_IO_SEEK_CUR);
+            continue;
+        }
+        if (marker[1] == 0xDA || marker[1] == 0xD9) {
+            /* Start of scan or end of image, the metadata is over */
+            break;
+        }
+        if (marker[1] == 0x01 || (marker[1] >= 0xD0 && marker[1] <= 0xD7)) {
+            /* These have no payload */
+            continue;
+        }
+        if (!SDL_ReadU16BE(src, &length) || length < 2) {
+            break;
+        }
+        length -= 2;
+
+        if (marker[1] == 0xE1 && length > 6) {
+            Uint8 header[6];
+
+            if (SDL_ReadIO(src, header, sizeof(header)) != sizeof(header)) {
+                break;
+            }
+            length -= sizeof(header);
+            if (SDL_memcmp(header, "Exif\0\0", sizeof(header)) == 0) {
+                exif = (Uint8 *)SDL_malloc(length);
+                if (exif && SDL_ReadIO(src, exif, length) != length) {
+                    SDL_free(exif);
+                    exif = NULL;
+                }
+                *size = length;
+                break;
+            }
+        }
+        if (SDL_SeekIO(src, length, SDL_IO_SEEK_CUR) < 0) {
+            break;
+        }
+    }
+
+done:
+    SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+    return exif;
+}
+
+/* EXIF data is laid out like a TIFF file, in either byte order */
+typedef struct {
+    const Uint8 *data;
+    size_t size;
+    bool big_endian;
+} EXIF_Reader;
+
+static bool EXIF_Read16(const EXIF_Reader *exif, size_t offset, Uint16 *value)
+{
+    const Uint8 *p;
+
+    if (offset > exif->size || exif->size - offset < 2) {
+        return false;
+    }
+    p = exif->data + offset;
+    if (exif->big_endian) {
+        *value = (Uint16)((p[0] << 8) | p[1]);
+    } else {
+        *value = (Uint16)((p[1] << 8) | p[0]);
+    }
+    return true;
+}
+
+static bool EXIF_Read32(const EXIF_Reader *exif, size_t offset, Uint32 *value)
+{
+    const Uint8 *p;
+
+    if (offset > exif->size || exif->size - offset < 4) {
+        return false;
+    }
+    p = exif->data + offset;
+    if (exif->big_endian) {
+        *value = ((Uint32)p[0] << 24) | ((Uint32)p[1] << 16) | ((Uint32)p[2] << 8) | p[3];
+    } else {
+        *value = ((Uint32)p[3] << 24) | ((Uint32)p[2] << 16) | ((Uint32)p[1] << 8) | p[0];
+    }
+    return true;
+}
+
+/* Check the TIFF header and return the offset of the first IFD */
+static bool EXIF_Open(EXIF_Reader *exif, const Uint8 *data, size_t size, Uint32 *ifd)
+{
+    Uint16 magic;
+
+    exif->data = data;
+    exif->size = size;
+    if (size < 8) {
+        return false;
+    }
+    if (data[0] == 'M' && data[1] == 'M') {
+        exif->big_endian = true;
+    } else if (data[0] == 'I' && data[1] == 'I') {
+        exif->big_endian = false;
+    } else {
+        return false;
+    }
+    return EXIF_Read16(exif, 2, &magic) && magic == 42 && EXIF_Read32(exif, 4, ifd);
+}
+
+/* Find a tag in an IFD and return the offset of its 12 byte entry */
+static bool EXIF_FindTag(const EXIF_Reader *exif, Uint32 ifd, Uint16 tag, size_t *entry)
+{
+    Uint16 count, i;
+
+    if (!EXIF_Read16(exif, ifd, &count)) {
+        return false;
+    }
+    for (i = 0; i < count; ++i) {
+        size_t offset = (size_t)ifd + 2 + (size_t)i * 12;
+        Uint16 value;
+
+        if (!EXIF_Read16(exif, offset, &value)) {
+            return false;
+        }
+        if (value == tag) {
+            *entry = offset;
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Return the orientation tag of an IFD, 1 (as stored) if it has none */
+static int EXIF_GetOrientation(const EXIF_Reader *exif, Uint32 ifd)
+{
+    const Uint16 EXIF_TAG_ORIENTATION = 0x0112;
+    size_t entry;
+    Uint16 orientation;
+
+    if (EXIF_FindTag(exif, ifd, EXIF_TAG_ORIENTATION, &entry) &&
+        EXIF_Read16(exif, entry + 8, &orientation) &&
+        orientation >= 1 && orientation <= 8) {
+        return orientation;
+    }
+    return 1;
+}
+
+#if defined(WANT_JPEGLIB) || defined(USE_STBIMAGE)
+/* Return the EXIF orientation of the image, 1 (as stored) if it has none */
+static int JPEG_GetOrientation(SDL_IOStream *src)
+{
+    EXIF_Reader exif;
+    Uint8 *data;
+    size_t size = 0;
+    Uint32 ifd;
+    int orientation = 1;
+
+    data = JPEG_ReadEXIF(src, &size);
+    if (!data) {
+        return 1;
+    }
+    if (EXIF_Open(&exif, data, size, &ifd)) {
+        orientation = EXIF_GetOrientation(&exif, ifd);
+    }
+    SDL_free(data);
+    return orientation;
+}
+#endif /* WANT_JPEGLIB || USE_STBIMAGE */
+
+/* Find the JPEG thumbnail that cameras store in the second IFD */
+static bool EXIF_FindThumbnail(const EXIF_Reader *exif, Uint32 ifd, Uint32 *offset, Uint32 *length)
+{
+    const Uint16 EXIF_TAG_JPEG_OFFSET = 0x0201;
+    const Uint16 EXIF_TAG_JPEG_LENGTH = 0x0202;
+    Uint16 count;
+    size_t entry;
+
+    /* The offset of the next IFD follows the entries of this one */
+    if (!EXIF_Read16(exif, ifd, &count) ||
+        !EXIF_Read32(exif, (size_t)ifd + 2 + (size_t)count * 12, &ifd) || ifd == 0) {
+        return false;
+    }
+    if (!EXIF_FindTag(exif, ifd, EXIF_TAG_JPEG_OFFSET, &entry) ||
+        !EXIF_Read32(exif, entry + 8, offset) ||
+        !EXIF_FindTag(exif, ifd, EXIF_TAG_JPEG_LENGTH, &entry) ||
+        !EXIF_Read32(exif, entry + 8, length)) {
+        return false;
+    }
+    return *length > 0 && *offset < exif->size && exif->size - *offset >= *length;
+}
+
+/* Load the thumbnail embedded in the EXIF data, without touching the main image */
+SDL_Surface *IMG_LoadJPGThumbnail_IO(SDL_IOStream *src)
+{
+    EXIF_Reader exif;
+    Uint8 *data;
+    size_t size = 0;
+    Uint32 ifd, offset, length;
+    int orientation;
+    SDL_Surface *surface = NULL;
+
+    if (!src) {
+        SDL_InvalidParamError("src");
+        return NULL;
+    }
+
+    data = JPEG_ReadEXIF(src, &size);
+    if (!data || !EXIF_Open(&exif, data, size, &ifd) ||
+        !EXIF_FindThumbnail(&exif, ifd, &offset, &length)) {
+        SDL_free(data);
+        SDL_SetError("JPEG image doesn't have an EXIF thumbnail");
+        return NULL;
+    }
+
+    /* The thumbnail is stored the same way up as the main image */
+    orientation = EXIF_GetOrientation(&exif, ifd);
+
+    src = SDL_IOFromConstMem(data + offset, length);
+    if (src) {
+        surface = IMG_LoadJPG_IO(src);
+        SDL_CloseIO(src);
+    }
+    SDL_free(data);
+
+    if (surface && orientation != 1) {
+        surface = IMG_ApplyOrientation(surface, orientation);
+    }
+    return surface;
+}
+
 #ifdef WANT_JPEGLIB
 
 #define USE_JPEGLIB
@@ -82,8 +545,13 @@ static struct {
     boolean (*jpeg_finish_decompress) (j_decompress_ptr cinfo);
     int (*jpeg_read_header) (j_decompress_ptr cinfo, boolean require_image);
     JDIMENSION (*jpeg_read_scanlines) (j_decompress_ptr cinfo, JSAMPARRAY scanlines, JDIMENSION max_lines);
+    JDIMENSION (*jpeg_read_raw_data) (j_decompress_ptr cinfo, JSAMPIMAGE data, JDIMENSION max_lines);
     boolean (*jpeg_resync_to_restart) (j_decompress_ptr cinfo, int desired);
     boolean (*jpeg_start_decompress) (j_decompress_ptr cinfo);
+    boolean (*jpeg_has_multiple_scans) (j_decompress_ptr cinfo);
+    boolean (*jpeg_input_complete) (j_decompress_ptr cinfo);
+    boolean (*jpeg_start_output) (j_decompress_ptr cinfo, int scan_number);
+    boolean (*jpeg_finish_output) (j_decompress_ptr cinfo);
     void (*jpeg_CreateCompress) (j_compress_ptr cinfo, int version, size_t structsize);
     void (*jpeg_start_compress) (j_compress_ptr cinfo, boolean write_all_tables);
     void (*jpeg_set_quality) (j_compress_ptr cinfo, int quality, boolean force_baseline);
@@ -118,8 +586,13 @@ static bool IMG_InitJPG(void)
         FUNCTION_LOADER(jpeg_finish_decompress, boolean (*) (j_decompress_ptr cinfo))
         FUNCTION_LOADER(jpeg_read_header, int (*) (j_decompress_ptr cinfo, boolean require_image))
         FUNCTION_LOADER(jpeg_read_scanlines, JDIMENSION (*) (j_decompress_ptr cinfo, JSAMPARRAY scanlines, JDIMENSION max_lines))
+        FUNCTION_LOADER(jpeg_read_raw_data, JDIMENSION (*) (j_decompress_ptr cinfo, JSAMPIMAGE data, JDIMENSION max_lines))
         FUNCTION_LOADER(jpeg_resync_to_restart, boolean (*) (j_decompress_ptr cinfo, int desired))
         FUNCTION_LOADER(jpeg_start_decompress, boolean (*) (j_decompress_ptr cinfo))
+        FUNCTION_LOADER(jpeg_has_multiple_scans, boolean (*) (j_decompress_ptr cinfo))
+        FUNCTION_LOADER(jpeg_input_complete, boolean (*) (j_decompress_ptr cinfo))
+        FUNCTION_LOADER(jpeg_start_output, boolean (*) (j_decompress_ptr cinfo, int scan_number))
+        FUNCTION_LOADER(jpeg_finish_output, boolean (*) (j_decompress_ptr cinfo))
         FUNCTION_LOADER(jpeg_CreateCompress, void (*) (j_compress_ptr cinfo, int version, size_t structsize))
         FUNCTION_LOADER(jpeg_start_compress, void (*) (j_compress_ptr cinfo, boolean write_all_tables))
         FUNCTION_LOADER(jpeg_set_quality, void (*) (j_compress_ptr cinfo, int quality, boolean force_baseline))
@@ -350,90 +823,443 @@ static void output_no_message(j_common_ptr cinfo)
     /* do nothing */
 }
 
+/* Output formats that libjpeg can write directly, with the byte offset of each channel */
+typedef struct {
+    SDL_PixelFormat format;
+    J_COLOR_SPACE color_space;
+    int r, g, b, a;
+} LIBJPEG_OutputFormat;
+
+static const LIBJPEG_OutputFormat LIBJPEG_OutputFormats[] = {
+#ifdef JCS_ALPHA_EXTENSIONS
+    { SDL_PIXELFORMAT_RGBA32, JCS_EXT_RGBA, 0, 1, 2, 3 },
+    { SDL_PIXELFORMAT_BGRA32, JCS_EXT_BGRA, 2, 1, 0, 3 },
+    { SDL_PIXELFORMAT_ARGB32, JCS_EXT_ARGB, 1, 2, 3, 0 },
+    { SDL_PIXELFORMAT_ABGR32, JCS_EXT_ABGR, 3, 2, 1, 0 },
+#endif
+#ifdef JCS_EXTENSIONS
+    { SDL_PIXELFORMAT_RGBX32, JCS_EXT_RGBX, 0, 1, 2, 3 },
+    { SDL_PIXELFORMAT_BGRX32, JCS_EXT_BGRX, 2, 1, 0, 3 },
+    { SDL_PIXELFORMAT_XRGB32, JCS_EXT_XRGB, 1, 2, 3, 0 },
+    { SDL_PIXELFORMAT_XBGR32, JCS_EXT_XBGR, 3, 2, 1, 0 },
+#endif
+    { SDL_PIXELFORMAT_RGB24, JCS_RGB, 0, 1, 2, -1 }
+};
+
+static const LIBJPEG_OutputFormat *LIBJPEG_GetOutputFormat(SDL_PixelFormat format)
+{
+    size_t i;
+
+    for (i = 0; i < SDL_arraysize(LIBJPEG_OutputFormats); ++i) {
+        if (LIBJPEG_OutputFormats[i].format == format) {
+            return &LIBJPEG_OutputFormats[i];
+        }
+    }
+    /* Fall back to 24-bit RGB, which is always last */
+    return &LIBJPEG_OutputFormats[SDL_arraysize(LIBJPEG_OutputFormats) - 1];
+}
+
+/* Inverted (Adobe) CMYK is essentially RGB scaled by K, i.e. RGBA composed over black.
+ * These convert 32-bit CMYK pixels in place to the channel order described by output.
+ */
+static void CMYKToRGB_Scalar(Uint8 *pixels, int count, const LIBJPEG_OutputFormat *output)
+{
+    int i;
+
+    for (i = 0; i < count; ++i, pixels += 4) {
+        unsigned int k = pixels[3];
+        unsigned int r = pixels[0] * k + 128;
+        unsigned int g = pixels[1] * k + 128;
+        unsigned int b = pixels[2] * k + 128;
+
+        pixels[output->r] = (Uint8)((r + (r >> 8)) >> 8);
+        pixels[output->g] = (Uint8)((g + (g >> 8)) >> 8);
+        pixels[output->b] = (Uint8)((b + (b >> 8)) >> 8);
+        pixels[output->a] = 0xFF;
+    }
+}
+
+#ifdef SDL_SSE2_INTRINSICS
+static void SDL_TARGETING("sse2") CMYKToRGB_SSE2(Uint8 *pixels, int count, const LIBJPEG_OutputFormat *output)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi16(128);
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i alpha = _mm_set1_epi32((int)(0xFFu << (output->a * 8)));
+    const __m128i shift_r = _mm_cvtsi32_si128(output->r * 8);
+    const __m128i shift_g = _mm_cvtsi32_si128(output->g * 8);
+    const __m128i shift_b = _mm_cvtsi32_si128(output->b * 8);
+    int i;
+
+    for (i = 0; i + 4 <= count; i += 4, pixels += 16) {
+        __m128i cmyk = _mm_loadu_si128((const __m128i *)pixels);
+        __m128i lo = _mm_unpacklo_epi8(cmyk, zero);
+        __m128i hi = _mm_unpackhi_epi8(cmyk, zero);
+        __m128i klo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(lo, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i khi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(hi, _MM_SHUFFLE(3, 3, 3, 3)), _MM_SHUFFLE(3, 3, 3, 3));
+        __m128i rgb, out;
+
+        lo = _mm_add_epi16(_mm_mullo_epi16(lo, klo), bias);
+        hi = _mm_add_epi16(_mm_mullo_epi16(hi, khi), bias);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+        rgb = _mm_packus_epi16(lo, hi);
+
+        out = _mm_or_si128(alpha, _mm_sll_epi32(_mm_and_si128(rgb, mask), shift_r));
+        out = _mm_or_si128(out, _mm_sll_epi32(_mm_and_si128(_mm_srli_epi32(rgb, 8), mask), shift_g));
+        out = _mm_or_si128(out, _mm_sll_epi32(_mm_and_si128(_mm_srli_epi32(rgb, 16), mask), shift_b));
+        _mm_storeu_si128((__m128i *)pixels, out);
+    }
+    CMYKToRGB_Scalar(pixels, count - i, output);
+}
+#endif
+
+#ifdef SDL_NEON_INTRINSICS
+static void CMYKToRGB_NEON(Uint8 *pixels, int count, const LIBJPEG_OutputFormat *output)
+{
+    int i;
+
+    for (i = 0; i + 8 <= count; i += 8, pixels += 32) {
+        uint8x8x4_t cmyk = vld4_u8(pixels);
+        uint8x8x4_t out = { { vdup_n_u8(0xFF), vdup_n_u8(0xFF), vdup_n_u8(0xFF), vdup_n_u8(0xFF) } };
+        uint16x8_t r = vmull_u8(cmyk.val[0], cmyk.val[3]);
+        uint16x8_t g = vmull_u8(cmyk.val[1], cmyk.val[3]);
+        uint16x8_t b = vmull_u8(cmyk.val[2], cmyk.val[3]);
+
+        out.val[output->r] = vrshrn_n_u16(vrsraq_n_u16(r, r, 8), 8);
+        out.val[output->g] = vrshrn_n_u16(vrsraq_n_u16(g, g, 8), 8);
+        out.val[output->b] = vrshrn_n_u16(vrsraq_n_u16(b, b, 8), 8);
+        vst4_u8(pixels, out);
+    }
+    CMYKToRGB_Scalar(pixels, count - i, output);
+}
+#endif
+
+static void CMYKToRGB(Uint8 *pixels, int count, const LIBJPEG_OutputFormat *output)
+{
+#ifdef SDL_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        CMYKToRGB_SSE2(pixels, count, output);
+        return;
+    }
+#endif
+#ifdef SDL_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        CMYKToRGB_NEON(pixels, count, output);
+        return;
+    }
+#endif
+    CMYKToRGB_Scalar(pixels, count, output);
+}
+
+/* The most scanlines libjpeg will hand back from a single jpeg_read_scanlines() call */
+#define MAX_SCANLINE_BATCH  8
+
 struct loadjpeg_vars {
     const char *error;
     SDL_Surface *surface;
+    Uint8 *buffer;
+    int width;
+    int height;
+    SDL_PixelFormat format;
+    int orientation;
+    IMG_ProgressCallback progress;
+    void *progress_userdata;
     struct jpeg_decompress_struct cinfo;
     struct my_error_mgr jerr;
 };
 
-/* Load a JPEG type image from an SDL datasource */
-static bool LIBJPEG_LoadJPG_IO(SDL_IOStream *src, struct loadjpeg_vars *vars)
+/* Pick the smallest IDCT scaling that still covers the requested size */
+static void LIBJPEG_SetOutputScale(struct loadjpeg_vars *vars)
 {
-    JSAMPROW rowptr[1];
+    unsigned int denom;
+    int width = vars->width;
+    int height = vars->height;
 
-    /* Create a decompression structure and load the JPEG header */
-    vars->cinfo.err = lib.jpeg_std_error(&vars->jerr.errmgr);
-    vars->jerr.errmgr.error_exit = my_error_exit;
-    vars->jerr.errmgr.output_message = output_no_message;
-    if (setjmp(vars->jerr.escape)) {
-        /* If we get here, libjpeg found an error */
+    if (width <= 0 && height <= 0) {
+        return;
+    }
+    if (vars->orientation >= 5) {
+        /* The requested size is in display orientation */
+        width = vars->height;
+        height = vars->width;
+    }
+
+    /* 1/2, 1/4 and 1/8 are supported by every libjpeg implementation */
+    vars->cinfo.scale_num = 1;
+    for (denom = 8; denom > 1; denom /= 2) {
+        vars->cinfo.scale_denom = denom;
+        lib.jpeg_calc_output_dimensions(&vars->cinfo);
+        if ((int)vars->cinfo.output_width >= width &&
+            (int)vars->cinfo.output_height >= height) {
+            return;
+        }
+    }
+    vars->cinfo.scale_denom = 1;
+}
+
+#if JPEG_LIB_VERSION >= 70
+#define LIBJPEG_MIN_DCT_SCALED_SIZE(cinfo)  (cinfo)->min_DCT_v_scaled_size
+#else
+#define LIBJPEG_MIN_DCT_SCALED_SIZE(cinfo)  (cinfo)->min_DCT_scaled_size
+#endif
+
+/* Raw YCbCr output maps onto the 4:2:0 SDL formats only for h2v2 images at full size */
+static bool LIBJPEG_CanDecodeYUV420(j_decompress_ptr cinfo)
+{
+    if (cinfo->num_components != 3 || cinfo->jpeg_color_space != JCS_YCbCr) {
+        return false;
+    }
+    if (cinfo->comp_info[0].h_samp_factor != 2 || cinfo->comp_info[0].v_samp_factor != 2 ||
+        cinfo->comp_info[1].h_samp_factor != 1 || cinfo->comp_info[1].v_samp_factor != 1 ||
+        cinfo->comp_info[2].h_samp_factor != 1 || cinfo->comp_info[2].v_samp_factor != 1) {
+        return false;
+    }
+    lib.jpeg_calc_output_dimensions(cinfo);
+    return (LIBJPEG_MIN_DCT_SCALED_SIZE(cinfo) == DCTSIZE);
+}
+
+/* Decode the YCbCr planes as-is, one iMCU row (16 luma lines) at a time */
+static bool LIBJPEG_LoadYUV420(struct loadjpeg_vars *vars)
+{
+    JSAMPROW rows[3][2 * DCTSIZE];
+    JSAMPARRAY planes[3];
+    int pitch[3];
+    Uint8 *buffer;
+    int w = (int)vars->cinfo.image_width;
+    int h = (int)vars->cinfo.image_height;
+    int i, row;
+
+    vars->cinfo.raw_data_out = TRUE;
+    vars->cinfo.out_color_space = JCS_YCbCr;
+
+    if (vars->orientation >= 5) {
+        vars->surface = SDL_CreateSurface(h, w, vars->format);
+    } else {
+        vars->surface = SDL_CreateSurface(w, h, vars->format);
+    }
+    if (!vars->surface) {
+        lib.jpeg_destroy_decompress(&vars->cinfo);
+        return false;
+    }
+    SDL_SetSurfaceColorspace(vars->surface, SDL_COLORSPACE_JPEG);
+
+    /* libjpeg writes whole DCT blocks, so decode into padded rows and copy the visible part */
+    for (i = 0; i < 3; ++i) {
+        pitch[i] = (int)vars->cinfo.comp_info[i].width_in_blocks * DCTSIZE;
+    }
+    vars->buffer = (Uint8 *)SDL_malloc((size_t)(2 * pitch[0] + pitch[1] + pitch[2]) * DCTSIZE);
+    if (!vars->buffer) {
         lib.jpeg_destroy_decompress(&vars->cinfo);
-        vars->error = "JPEG loading error";
         return false;
     }
+    buffer = vars->buffer;
+    for (i = 0; i < 3; ++i) {
+        for (row = 0; row < vars->cinfo.comp_info[i].v_samp_factor * DCTSIZE; ++row) {
+            rows[i][row] = (JSAMPROW)buffer;
+            buffer += pitch[i];
+        }
+        planes[i] = rows[i];
+    }
+
+    lib.jpeg_start_decompress(&vars->cinfo);
+    while (vars->cinfo.output_scanline < vars->cinfo.output_height) {
+        int first = (int)vars->cinfo.output_scanline;
+        int count = (int)lib.jpeg_read_raw_data(&vars->cinfo, planes, 2 * DCTSIZE);
+        if (count <= 0) {
+            break;
+        }
+        if (!IMG_CopyYUV420ToSurface(vars->surface, first, count,
+                                     rows[0][0], pitch[0],
+                                     rows[1][0], pitch[1],
+                                     rows[2][0], pitch[2],
+                                     vars->orientation)) {
+            lib.jpeg_destroy_decompress(&vars->cinfo);
+            return false;
+        }
+    }
+    lib.jpeg_finish_decompress(&vars->cinfo);
+    lib.jpeg_destroy_decompress(&vars->cinfo);
+
+    return true;
+}
+
+/* Decode the rows of the current output pass into the surface */
+static void LIBJPEG_ReadScanlines(struct loadjpeg_vars *vars, const LIBJPEG_OutputFormat *output, int batch, int strip_pitch)
+{
+    JSAMPROW rowptr[MAX_SCANLINE_BATCH];
+    /* Channel layout used to unpack CMYK rows into a 24-bit surface */
+    static const LIBJPEG_OutputFormat rgbx = { SDL_PIXELFORMAT_RGBX32, JCS_CMYK, 0, 1, 2, 3 };
+    const int bpp = (output->a < 0) ? 3 : 4;
+    int w = (int)vars->cinfo.output_width;
+    int h = (int)vars->cinfo.output_height;
+
+    while (vars->cinfo.output_scanline < vars->cinfo.output_height) {
+        int first = (int)vars->cinfo.output_scanline;
+        int count = SDL_min(batch, h - first);
+        int i;
+
+        for (i = 0; i < count; ++i) {
+            if (vars->buffer) {
+                rowptr[i] = (JSAMPROW)(vars->buffer + (size_t)i * strip_pitch);
+            } else {
+                rowptr[i] = (JSAMPROW)((Uint8 *)vars->surface->pixels + (size_t)(first + i) * vars->surface->pitch);
+            }
+        }
+        count = (int)lib.jpeg_read_scanlines(&vars->cinfo, rowptr, (JDIMENSION)count);
+
+        if (vars->cinfo.num_components == 4) {
+            for (i = 0; i < count; ++i) {
+                if (output->a < 0) {
+                    const Uint8 *in = rowptr[i];
+                    Uint8 *out = rowptr[i];
+                    int x;
+
+                    /* Convert, then pack down to 24-bit in place */
+                    CMYKToRGB(rowptr[i], w, &rgbx);
+                    for (x = 0; x < w; ++x, in += 4, out += 3) {
+                        out[0] = in[0];
+                        out[1] = in[1];
+                        out[2] = in[2];
+                    }
+                } else {
+                    CMYKToRGB(rowptr[i], w, output);
+                }
+            }
+        }
+
+        if (vars->buffer) {
+            IMG_OrientPixels((Uint8 *)vars->surface->pixels, vars->surface->pitch,
+                             vars->buffer, strip_pitch, w, h, first, count, bpp, vars->orientation);
+        }
+    }
+}
+
+/* Output the image once per progressive scan, handing each refinement to the progress callback.
+ * Returns false if the callback asked to stop, leaving the surface at the last refinement.
+ */
+static bool LIBJPEG_ReadProgressive(struct loadjpeg_vars *vars, const LIBJPEG_OutputFormat *output, int batch, int strip_pitch)
+{
+    int pass = 0;
+
+    /* Each output pass waits for its scan to be complete, since the source never suspends */
+    while (!lib.jpeg_input_complete(&vars->cinfo)) {
+        lib.jpeg_start_output(&vars->cinfo, vars->cinfo.input_scan_number);
+        LIBJPEG_ReadScanlines(vars, output, batch, strip_pitch);
+        lib.jpeg_finish_output(&vars->cinfo);
+
+        if (lib.jpeg_input_complete(&vars->cinfo)) {
+            /* This was the final scan, the surface holds the finished image */
+            break;
+        }
+        if (!vars->progress(vars->progress_userdata, vars->surface, ++pass)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Decode the image once the error handler is set up.
+ * This is kept out of LIBJPEG_LoadJPG_IO() so that no local variable lives across its setjmp().
+ */
+static bool LIBJPEG_DecodeJPG(SDL_IOStream *src, struct loadjpeg_vars *vars)
+{
+    const LIBJPEG_OutputFormat *output = LIBJPEG_GetOutputFormat(vars->format);
+    const int bpp = (output->a < 0) ? 3 : 4;
+    int batch, w, h;
+    int strip_pitch = 0;
 
     lib.jpeg_create_decompress(&vars->cinfo);
     jpeg_SDL_IO_src(&vars->cinfo, src);
     lib.jpeg_read_header(&vars->cinfo, TRUE);
 
+    if (IMG_IsYUV420Format(vars->format) && LIBJPEG_CanDecodeYUV420(&vars->cinfo)) {
+        return LIBJPEG_LoadYUV420(vars);
+    }
+
     if (vars->cinfo.num_components == 4) {
-        /* Set 32-bit Raw output */
+        /* Set 32-bit Raw output, we'll convert it ourselves */
         vars->cinfo.out_color_space = JCS_CMYK;
-        vars->cinfo.quantize_colors = FALSE;
-        lib.jpeg_calc_output_dimensions(&vars->cinfo);
-
-        /* Allocate an output surface to hold the image */
-        vars->surface = SDL_CreateSurface(vars->cinfo.output_width, vars->cinfo.output_height, SDL_PIXELFORMAT_RGBA32);
     } else {
-        /* Set 24-bit RGB output */
-        vars->cinfo.out_color_space = JCS_RGB;
-        vars->cinfo.quantize_colors = FALSE;
+        /* Set RGB output in the requested channel order */
+        vars->cinfo.out_color_space = output->color_space;
 #ifdef FAST_JPEG
-        vars->cinfo.scale_num   = 1;
-        vars->cinfo.scale_denom = 1;
         vars->cinfo.dct_method = JDCT_FASTEST;
         vars->cinfo.do_fancy_upsampling = FALSE;
 #endif
-        lib.jpeg_calc_output_dimensions(&vars->cinfo);
-
-        /* Allocate an output surface to hold the image */
-        vars->surface = SDL_CreateSurface(vars->cinfo.output_width, vars->cinfo.output_height, SDL_PIXELFORMAT_RGB24);
     }
-
+    vars->cinfo.quantize_colors = FALSE;
+    if (vars->progress && lib.jpeg_has_multiple_scans(&vars->cinfo)) {
+        /* Keep the coefficients around so the image can be output after every scan */
+        vars->cinfo.buffered_image = TRUE;
+    }
+    LIBJPEG_SetOutputScale(vars);
+    lib.jpeg_calc_output_dimensions(&vars->cinfo);
+    batch = SDL_clamp(vars->cinfo.rec_outbuf_height, 1, MAX_SCANLINE_BATCH);
+    w = (int)vars->cinfo.output_width;
+    h = (int)vars->cinfo.output_height;
+
+    /* Allocate an output surface to hold the image, in display orientation */
+    if (vars->orientation >= 5) {
+        vars->surface = SDL_CreateSurface(h, w, output->format);
+    } else {
+        vars->surface = SDL_CreateSurface(w, h, output->format);
+    }
     if (!vars->surface) {
         lib.jpeg_destroy_decompress(&vars->cinfo);
         return false;
     }
 
+    if ((vars->cinfo.num_components == 4 && output->a < 0) || vars->orientation != 1) {
+        /* CMYK doesn't fit in a 24-bit row and reoriented rows don't land in a
+         * single surface row, so decode a batch of rows aside and move them into place.
+         */
+        strip_pitch = w * ((vars->cinfo.num_components == 4) ? 4 : bpp);
+        vars->buffer = (Uint8 *)SDL_malloc((size_t)batch * strip_pitch);
+        if (!vars->buffer) {
+            lib.jpeg_destroy_decompress(&vars->cinfo);
+            return false;
+        }
+    }
+
     /* Decompress the image */
     lib.jpeg_start_decompress(&vars->cinfo);
-    while (vars->cinfo.output_scanline < vars->cinfo.output_height) {
-        rowptr[0] = (JSAMPROW)(Uint8 *)vars->surface->pixels +
-                            vars->cinfo.output_scanline * vars->surface->pitch;
-        lib.jpeg_read_scanlines(&vars->cinfo, rowptr, (JDIMENSION) 1);
+    if (vars->cinfo.buffered_image) {
+        if (!LIBJPEG_ReadProgressive(vars, output, batch, strip_pitch)) {
+            /* Stopped early, skip the rest of the data instead of decoding it */
+            lib.jpeg_destroy_decompress(&vars->cinfo);
+            return true;
+        }
+    } else {
+        LIBJPEG_ReadScanlines(vars, output, batch, strip_pitch);
     }
     lib.jpeg_finish_decompress(&vars->cinfo);
     lib.jpeg_destroy_decompress(&vars->cinfo);
 
-    if (vars->cinfo.num_components == 4) {
-        // The CMYK image is essentially RGBA composed over black
-        SDL_Surface *output = SDL_CreateSurface(vars->cinfo.output_width, vars->cinfo.output_height, SDL_PIXELFORMAT_RGB24);
-        if (!output) {
-            return false;
-        }
+    return true;
+}
 
-        SDL_BlitSurface(vars->surface, NULL, output, NULL);
-        SDL_DestroySurface(vars->surface);
-        vars->surface = output;
+/* Load a JPEG type image from an SDL datasource */
+static bool LIBJPEG_LoadJPG_IO(SDL_IOStream *src, struct loadjpeg_vars *vars)
+{
+    /* Create a decompression structure and load the JPEG header */
+    vars->cinfo.err = lib.jpeg_std_error(&vars->jerr.errmgr);
+    vars->jerr.errmgr.error_exit = my_error_exit;
+    vars->jerr.errmgr.output_message = output_no_message;
+    if (setjmp(vars->jerr.escape)) {
+        /* If we get here, libjpeg found an error */
+        lib.jpeg_destroy_decompress(&vars->cinfo);
+        vars->error = "JPEG loading error";
+        return false;
     }
-    return true;
+    return LIBJPEG_DecodeJPG(src, vars);
 }
 
-SDL_Surface *IMG_LoadJPG_IO(SDL_IOStream *src)
+SDL_Surface *IMG_LoadJPGWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
 {
     Sint64 start;
     struct loadjpeg_vars vars;
+    int orientation;
 
     if (!src) {
         /* The error message has been set in SDL_IOFromFile */
@@ -446,10 +1272,27 @@ SDL_Surface *IMG_LoadJPG_IO(SDL_IOStream *src)
 
     start = SDL_TellIO(src);
     SDL_zero(vars);
+    vars.width = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_WIDTH_NUMBER, 0);
+    vars.height = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_HEIGHT_NUMBER, 0);
+    vars.format = (SDL_PixelFormat)SDL_GetNumberProperty(props, IMG_PROP_LOAD_PIXEL_FORMAT_NUMBER, SDL_PIXELFORMAT_RGB24);
+    vars.progress = (IMG_ProgressCallback)SDL_GetPointerProperty(props, IMG_PROP_LOAD_PROGRESS_CALLBACK_POINTER, NULL);
+    vars.progress_userdata = SDL_GetPointerProperty(props, IMG_PROP_LOAD_PROGRESS_USERDATA_POINTER, NULL);
+    orientation = JPEG_GetOrientation(src);
+#ifdef ORIENTATION_USES_PROPERTIES
+    vars.orientation = 1;
+#else
+    /* Rows are written straight to their oriented place as they are decoded */
+    vars.orientation = orientation;
+#endif
 
     if (LIBJPEG_LoadJPG_IO(src, &vars)) {
+        SDL_free(vars.buffer);
+        if (vars.orientation != orientation) {
+            return IMG_ApplyOrientation(vars.surface, orientation);
+        }
         return vars.surface;
     }
+    SDL_free(vars.buffer);
 
     /* this may clobber a set error if seek fails: don't care. */
     SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
@@ -463,6 +1306,11 @@ SDL_Surface *IMG_LoadJPG_IO(SDL_IOStream *src)
     return NULL;
 }
 
+SDL_Surface *IMG_LoadJPG_IO(SDL_IOStream *src)
+{
+    return IMG_LoadJPGWithProperties(src, 0);
+}
+
 #define OUTPUT_BUFFER_SIZE   4096
 typedef struct {
     struct jpeg_destination_mgr pub;
@@ -517,6 +1365,9 @@ static void jpeg_SDL_IO_dest(j_compress_ptr cinfo, SDL_IOStream *ctx)
     dest->pub.free_in_buffer = OUTPUT_BUFFER_SIZE;
 }
 
+/* Scanlines passed to libjpeg at a time, one MCU row with chroma subsampling */
+#define JPEG_SAVE_BATCH_LINES   16
+
 struct savejpeg_vars
 {
     struct jpeg_compress_struct cinfo;
@@ -552,11 +1403,15 @@ static bool JPEG_SaveJPEG_IO(struct savejpeg_vars *vars, SDL_Surface *jpeg_surfa
     lib.jpeg_start_compress(&vars->cinfo, TRUE);
 
     while (vars->cinfo.next_scanline < vars->cinfo.image_height) {
-        JSAMPROW row_pointer[1];
-        int offset = vars->cinfo.next_scanline * jpeg_surface->pitch;
+        JSAMPROW row_pointers[JPEG_SAVE_BATCH_LINES];
+        JDIMENSION first = vars->cinfo.next_scanline;
+        JDIMENSION count = SDL_min(vars->cinfo.image_height - first, JPEG_SAVE_BATCH_LINES);
+        JDIMENSION i;
 
-        row_pointer[0] = ((Uint8*)jpeg_surface->pixels) + offset;
-        lib.jpeg_write_scanlines(&vars->cinfo, row_pointer, 1);
+        for (i = 0; i < count; ++i) {
+            row_pointers[i] = (Uint8 *)jpeg_surface->pixels + (size_t)(first + i) * jpeg_surface->pitch;
+        }
+        lib.jpeg_write_scanlines(&vars->cinfo, row_pointers, count);
     }
 
     lib.jpeg_finish_compress(&vars->cinfo);
@@ -564,11 +1419,18 @@ static bool JPEG_SaveJPEG_IO(struct savejpeg_vars *vars, SDL_Surface *jpeg_surfa
     return true;
 }
 
-static bool IMG_SaveJPG_IO_jpeglib(SDL_Surface *surface, SDL_IOStream *dst, int quality)
+static bool JPEG_SaveRGB24_IO(SDL_Surface *surface, SDL_IOStream *dst, int quality)
+{
+    struct savejpeg_vars vars;
+
+    SDL_zero(vars);
+    return JPEG_SaveJPEG_IO(&vars, surface, dst, quality);
+}
+
+static bool IMG_SaveJPG_IO_jpeglib(SDL_Surface *surface, SDL_IOStream *dst, int quality, SDL_PropertiesID props)
 {
     /* The JPEG library reads bytes in R,G,B order, so this is the right
      * encoding for either endianness */
-    struct savejpeg_vars vars;
     static const Uint32 jpg_format = SDL_PIXELFORMAT_RGB24;
     SDL_Surface* jpeg_surface = surface;
     bool result;
@@ -585,8 +1447,11 @@ static bool IMG_SaveJPG_IO_jpeglib(SDL_Surface *surface, SDL_IOStream *dst, int
         }
     }
 
-    SDL_zero(vars);
-    result = JPEG_SaveJPEG_IO(&vars, jpeg_surface, dst, quality);
+    /* The default 2x2 chroma subsampling makes the MCUs 16x16 pixels */
+    result = JPEG_SaveBands_IO(jpeg_surface, dst, quality, 16, JPEG_SaveRGB24_IO, props);
+    if (!result) {
+        result = JPEG_SaveRGB24_IO(jpeg_surface, dst, quality);
+    }
 
     if (jpeg_surface != surface) {
         SDL_DestroySurface(jpeg_surface);
@@ -673,7 +1538,20 @@ bool IMG_isJPG(SDL_IOStream *src)
 /* Load a JPEG type image from an SDL datasource */
 SDL_Surface *IMG_LoadJPG_IO(SDL_IOStream *src)
 {
-    return IMG_LoadSTB_IO(src);
+    SDL_Surface *surface;
+    int orientation;
+
+    if (!src) {
+        /* The error message has been set in SDL_IOFromFile */
+        return NULL;
+    }
+
+    orientation = JPEG_GetOrientation(src);
+    surface = IMG_LoadSTB_IO(src);
+    if (surface && orientation != 1) {
+        surface = IMG_ApplyOrientation(surface, orientation);
+    }
+    return surface;
 }
 
 #endif /* WANT_JPEGLIB */
@@ -693,8 +1571,22 @@ SDL_Surface *IMG_LoadJPG_IO(SDL_IOStream *src)
     return NULL;
 }
 
+SDL_Surface *IMG_LoadJPGThumbnail_IO(SDL_IOStream *src)
+{
+    SDL_SetError("SDL_image built without JPG support");
+    return NULL;
+}
+
 #endif /* LOAD_JPG */
 
+#ifndef USE_JPEGLIB
+/* Other backends always decode at the natural size of the image */
+SDL_Surface *IMG_LoadJPGWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    return IMG_LoadJPG_IO(src);
+}
+#endif
+
 /* Use tinyjpeg as a fallback if we don't have a hard dependency on libjpeg */
 #if SAVE_JPG && (defined(LOAD_JPG_DYNAMIC) || !defined(WANT_JPEGLIB))
 
@@ -724,48 +1616,76 @@ static void IMG_SaveJPG_IO_tinyjpeg_callback(void* context, void* data, int size
     SDL_WriteIO((SDL_IOStream*) context, data, size);
 }
 
-static bool IMG_SaveJPG_IO_tinyjpeg(SDL_Surface *surface, SDL_IOStream *dst, int quality)
+/* Find the byte offsets of the color channels, for the formats tinyjpeg can read directly */
+static bool TJE_GetRGBOffsets(SDL_PixelFormat format, int rgb[3])
+{
+    const SDL_PixelFormatDetails *details;
+
+    if (format == SDL_PIXELFORMAT_RGB24 || format == SDL_PIXELFORMAT_BGR24) {
+        rgb[0] = (format == SDL_PIXELFORMAT_RGB24) ? 0 : 2;
+        rgb[1] = 1;
+        rgb[2] = 2 - rgb[0];
+        return true;
+    }
+
+    details = SDL_GetPixelFormatDetails(format);
+    if (!details || !SDL_ISPIXELFORMAT_PACKED(format) || details->bytes_per_pixel != 4 ||
+        details->Rbits != 8 || details->Gbits != 8 || details->Bbits != 8) {
+        return false;
+    }
+#if SDL_BYTEORDER == SDL_LIL_ENDIAN
+    rgb[0] = details->Rshift / 8;
+    rgb[1] = details->Gshift / 8;
+    rgb[2] = details->Bshift / 8;
+#else
+    rgb[0] = 3 - details->Rshift / 8;
+    rgb[1] = 3 - details->Gshift / 8;
+    rgb[2] = 3 - details->Bshift / 8;
+#endif
+    return true;
+}
+
+static bool TJE_SaveSurface_IO(SDL_Surface *surface, SDL_IOStream *dst, int quality)
+{
+    int rgb[3];
+
+    if (!TJE_GetRGBOffsets(surface->format, rgb) ||
+        !tje_encode_with_func_ex(IMG_SaveJPG_IO_tinyjpeg_callback, dst, quality,
+                                 surface->w, surface->h, SDL_BYTESPERPIXEL(surface->format), rgb,
+                                 surface->pixels, surface->pitch)) {
+        return SDL_SetError("tinyjpeg error");
+    }
+    return true;
+}
+
+static bool IMG_SaveJPG_IO_tinyjpeg(SDL_Surface *surface, SDL_IOStream *dst, int quality, SDL_PropertiesID props)
 {
-    /* The JPEG library reads bytes in R,G,B order, so this is the right
-     * encoding for either endianness */
-    static const Uint32 jpg_format = SDL_PIXELFORMAT_RGB24;
     SDL_Surface* jpeg_surface = surface;
     bool result = false;
+    int rgb[3];
 
-    /* Convert surface to format we can save */
-    if (surface->format != jpg_format) {
-        jpeg_surface = SDL_ConvertSurface(surface, jpg_format);
+    /* Convert surface to format we can save, 24-bit and 32-bit RGB are read directly */
+    if (SDL_MUSTLOCK(surface) || !TJE_GetRGBOffsets(surface->format, rgb)) {
+        jpeg_surface = SDL_ConvertSurface(surface, SDL_PIXELFORMAT_RGB24);
         if (!jpeg_surface) {
             return false;
         }
     }
 
-    /* Quality for tinyjpeg is from 1-3:
-     * 0  - 33  - Lowest quality
-     * 34 - 66  - Middle quality
-     * 67 - 100 - Highest quality
-     */
-    if      (quality < 34) quality = 1;
-    else if (quality < 67) quality = 2;
-    else                   quality = 3;
-
-    result = tje_encode_with_func(
-        IMG_SaveJPG_IO_tinyjpeg_callback,
-        dst,
-        quality,
-        jpeg_surface->w,
-        jpeg_surface->h,
-        3,
-        jpeg_surface->pixels,
-        jpeg_surface->pitch
-    );
-
-    if (jpeg_surface != surface) {
-        SDL_DestroySurface(jpeg_surface);
+    if (quality < 1) {
+        quality = 1;
+    } else if (quality > 100) {
+        quality = 100;
     }
 
+    /* tinyjpeg doesn't subsample chroma, so the MCUs are 8x8 pixels */
+    result = JPEG_SaveBands_IO(jpeg_surface, dst, quality, 8, TJE_SaveSurface_IO, props);
     if (!result) {
-        SDL_SetError("tinyjpeg error");
+        result = TJE_SaveSurface_IO(jpeg_surface, dst, quality);
+    }
+
+    if (jpeg_surface != surface) {
+        SDL_DestroySurface(jpeg_surface);
     }
     return result;
 }
@@ -774,38 +1694,49 @@ static bool IMG_SaveJPG_IO_tinyjpeg(SDL_Surface *surface, SDL_IOStream *dst, int
 
 #if SAVE_JPG
 
-bool IMG_SaveJPG_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio, int quality)
+static bool IMG_SaveJPG_IO_props(SDL_Surface *surface, SDL_IOStream *dst, int quality, SDL_PropertiesID props)
 {
     bool result = false;
 
     if (!surface) {
-        SDL_InvalidParamError("surface");
-        goto done;
+        return SDL_InvalidParamError("surface");
     }
     if (!dst) {
-        SDL_InvalidParamError("dst");
-        goto done;
+        return SDL_InvalidParamError("dst");
     }
 
 #ifdef USE_JPEGLIB
     if (!result) {
-        result = IMG_SaveJPG_IO_jpeglib(surface, dst, quality);
+        result = IMG_SaveJPG_IO_jpeglib(surface, dst, quality, props);
     }
 #endif
 
 #if defined(LOAD_JPG_DYNAMIC) || !defined(WANT_JPEGLIB)
     if (!result) {
-        result = IMG_SaveJPG_IO_tinyjpeg(surface, dst, quality);
+        result = IMG_SaveJPG_IO_tinyjpeg(surface, dst, quality, props);
     }
 #endif
 
-done:
-    if (closeio) {
+    return result;
+}
+
+bool IMG_SaveJPG_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio, int quality)
+{
+    bool result = IMG_SaveJPG_IO_props(surface, dst, quality, 0);
+
+    if (closeio && dst) {
         result &= SDL_CloseIO(dst);
     }
     return result;
 }
 
+bool IMG_SaveJPGWithProperties_IO(SDL_Surface *surface, SDL_IOStream *dst, SDL_PropertiesID props)
+{
+    int quality = (int)SDL_GetNumberProperty(props, IMG_PROP_SAVE_QUALITY_NUMBER, 90);
+
+    return IMG_SaveJPG_IO_props(surface, dst, quality, props);
+}
+
 bool IMG_SaveJPG(SDL_Surface *surface, const char *file, int quality)
 {
     SDL_IOStream *dst = SDL_IOFromFile(file, "wb");
@@ -828,4 +1759,9 @@ bool IMG_SaveJPG(SDL_Surface *surface, const char *file, int quality)
     return SDL_SetError("SDL_image built without JPG save support");
 }
 
+bool IMG_SaveJPGWithProperties_IO(SDL_Surface *surface, SDL_IOStream *dst, SDL_PropertiesID props)
+{
+    return SDL_SetError("SDL_image built without JPG save support");
+}
+
 #endif // SAVE_JPG
@@ -23,6 +23,14 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG.h"
+#include "IMG_anim_decoder.h"
+
+/* JXL save support needs the full libjxl, not only the decoder, so it is off by default */
+#if !defined(SAVE_JXL)
+#define SAVE_JXL 0
+#endif
+
 #ifdef LOAD_JXL
 
 #if defined(LOAD_JXL_DYNAMIC) && defined(SDL_ELF_NOTE_DLOPEN)
@@ -35,6 +43,9 @@ SDL_ELF_NOTE_DLOPEN(
 #endif
 
 #include <jxl/decode.h>
+#if SAVE_JXL
+#include <jxl/encode.h>
+#endif
 
 
 static struct {
@@ -43,11 +54,33 @@ static struct {
     JxlDecoder* (*JxlDecoderCreate)(const JxlMemoryManager* memory_manager);
     JxlDecoderStatus (*JxlDecoderSubscribeEvents)(JxlDecoder* dec, int events_wanted);
     JxlDecoderStatus (*JxlDecoderSetInput)(JxlDecoder* dec, const uint8_t* data, size_t size);
+    size_t (*JxlDecoderReleaseInput)(JxlDecoder* dec);
     JxlDecoderStatus (*JxlDecoderProcessInput)(JxlDecoder* dec);
     JxlDecoderStatus (*JxlDecoderGetBasicInfo)(const JxlDecoder* dec, JxlBasicInfo* info);
+    JxlDecoderStatus (*JxlDecoderGetFrameHeader)(const JxlDecoder* dec, JxlFrameHeader* header);
     JxlDecoderStatus (*JxlDecoderImageOutBufferSize)(const JxlDecoder* dec, const JxlPixelFormat* format, size_t* size);
     JxlDecoderStatus (*JxlDecoderSetImageOutBuffer)(JxlDecoder* dec, const JxlPixelFormat* format, void* buffer, size_t size);
+    JxlDecoderStatus (*JxlDecoderSetParallelRunner)(JxlDecoder* dec, JxlParallelRunner parallel_runner, void* parallel_runner_opaque);
+    JxlDecoderStatus (*JxlDecoderSetProgressiveDetail)(JxlDecoder* dec, JxlProgressiveDetail detail);
+    JxlDecoderStatus (*JxlDecoderFlushImage)(JxlDecoder* dec);
+    void (*JxlDecoderRewind)(JxlDecoder* dec);
     void (*JxlDecoderDestroy)(JxlDecoder* dec);
+#if SAVE_JXL
+    JxlEncoder* (*JxlEncoderCreate)(const JxlMemoryManager* memory_manager);
+    void (*JxlEncoderDestroy)(JxlEncoder* enc);
+    JxlEncoderStatus (*JxlEncoderSetParallelRunner)(JxlEncoder* enc, JxlParallelRunner parallel_runner, void* parallel_runner_opaque);
+    JxlEncoderFrameSettings* (*JxlEncoderFrameSettingsCreate)(JxlEncoder* enc, const JxlEncoderFrameSettings* source);
+    void (*JxlEncoderInitBasicInfo)(JxlBasicInfo* info);
+    JxlEncoderStatus (*JxlEncoderSetBasicInfo)(JxlEncoder* enc, const JxlBasicInfo* info);
+    void (*JxlColorEncodingSetToSRGB)(JxlColorEncoding* color_encoding, JXL_BOOL is_gray);
+    JxlEncoderStatus (*JxlEncoderSetColorEncoding)(JxlEncoder* enc, const JxlColorEncoding* color);
+    JxlEncoderStatus (*JxlEncoderSetFrameLossless)(JxlEncoderFrameSettings* frame_settings, JXL_BOOL lossless);
+    JxlEncoderStatus (*JxlEncoderSetFrameDistance)(JxlEncoderFrameSettings* frame_settings, float distance);
+    JxlEncoderStatus (*JxlEncoderFrameSettingsSetOption)(JxlEncoderFrameSettings* frame_settings, JxlEncoderFrameSettingId option, int64_t value);
+    JxlEncoderStatus (*JxlEncoderAddImageFrame)(const JxlEncoderFrameSettings* frame_settings, const JxlPixelFormat* pixel_format, const void* buffer, size_t size);
+    void (*JxlEncoderCloseInput)(JxlEncoder* enc);
+    JxlEncoderStatus (*JxlEncoderProcessOutput)(JxlEncoder* enc, uint8_t** next_out, size_t* avail_out);
+#endif
 } lib;
 
 #ifdef LOAD_JXL_DYNAMIC
@@ -76,11 +109,33 @@ static bool IMG_InitJXL(void)
         FUNCTION_LOADER(JxlDecoderCreate, JxlDecoder* (*)(const JxlMemoryManager* memory_manager))
         FUNCTION_LOADER(JxlDecoderSubscribeEvents, JxlDecoderStatus (*)(JxlDecoder* dec, int events_wanted))
         FUNCTION_LOADER(JxlDecoderSetInput, JxlDecoderStatus (*)(JxlDecoder* dec, const uint8_t* data, size_t size))
+        FUNCTION_LOADER(JxlDecoderReleaseInput, size_t (*)(JxlDecoder* dec))
         FUNCTION_LOADER(JxlDecoderProcessInput, JxlDecoderStatus (*)(JxlDecoder* dec))
         FUNCTION_LOADER(JxlDecoderGetBasicInfo, JxlDecoderStatus (*)(const JxlDecoder* dec, JxlBasicInfo* info))
+        FUNCTION_LOADER(JxlDecoderGetFrameHeader, JxlDecoderStatus (*)(const JxlDecoder* dec, JxlFrameHeader* header))
         FUNCTION_LOADER(JxlDecoderImageOutBufferSize, JxlDecoderStatus (*)(const JxlDecoder* dec, const JxlPixelFormat* format, size_t* size))
         FUNCTION_LOADER(JxlDecoderSetImageOutBuffer, JxlDecoderStatus (*)(JxlDecoder* dec, const JxlPixelFormat* format, void* buffer, size_t size))
+        FUNCTION_LOADER(JxlDecoderSetParallelRunner, JxlDecoderStatus (*)(JxlDecoder* dec, JxlParallelRunner parallel_runner, void* parallel_runner_opaque))
+        FUNCTION_LOADER(JxlDecoderSetProgressiveDetail, JxlDecoderStatus (*)(JxlDecoder* dec, JxlProgressiveDetail detail))
+        FUNCTION_LOADER(JxlDecoderFlushImage, JxlDecoderStatus (*)(JxlDecoder* dec))
+        FUNCTION_LOADER(JxlDecoderRewind, void (*)(JxlDecoder* dec))
         FUNCTION_LOADER(JxlDecoderDestroy, void (*)(JxlDecoder* dec))
+#if SAVE_JXL
+        FUNCTION_LOADER(JxlEncoderCreate, JxlEncoder* (*)(const JxlMemoryManager* memory_manager))
+        FUNCTION_LOADER(JxlEncoderDestroy, void (*)(JxlEncoder* enc))
+        FUNCTION_LOADER(JxlEncoderSetParallelRunner, JxlEncoderStatus (*)(JxlEncoder* enc, JxlParallelRunner parallel_runner, void* parallel_runner_opaque))
+        FUNCTION_LOADER(JxlEncoderFrameSettingsCreate, JxlEncoderFrameSettings* (*)(JxlEncoder* enc, const JxlEncoderFrameSettings* source))
+        FUNCTION_LOADER(JxlEncoderInitBasicInfo, void (*)(JxlBasicInfo* info))
+        FUNCTION_LOADER(JxlEncoderSetBasicInfo, JxlEncoderStatus (*)(JxlEncoder* enc, const JxlBasicInfo* info))
+        FUNCTION_LOADER(JxlColorEncodingSetToSRGB, void (*)(JxlColorEncoding* color_encoding, JXL_BOOL is_gray))
+        FUNCTION_LOADER(JxlEncoderSetColorEncoding, JxlEncoderStatus (*)(JxlEncoder* enc, const JxlColorEncoding* color))
+        FUNCTION_LOADER(JxlEncoderSetFrameLossless, JxlEncoderStatus (*)(JxlEncoderFrameSettings* frame_settings, JXL_BOOL lossless))
+        FUNCTION_LOADER(JxlEncoderSetFrameDistance, JxlEncoderStatus (*)(JxlEncoderFrameSettings* frame_settings, float distance))
+        FUNCTION_LOADER(JxlEncoderFrameSettingsSetOption, JxlEncoderStatus (*)(JxlEncoderFrameSettings* frame_settings, JxlEncoderFrameSettingId option, int64_t value))
+        FUNCTION_LOADER(JxlEncoderAddImageFrame, JxlEncoderStatus (*)(const JxlEncoderFrameSettings* frame_settings, const JxlPixelFormat* pixel_format, const void* buffer, size_t size))
+        FUNCTION_LOADER(JxlEncoderCloseInput, void (*)(JxlEncoder* enc))
+        FUNCTION_LOADER(JxlEncoderProcessOutput, JxlEncoderStatus (*)(JxlEncoder* enc, uint8_t** next_out, size_t* avail_out))
+#endif
     }
     ++lib.loaded;
 
@@ -101,6 +156,225 @@ void IMG_QuitJXL(void)
 }
 #endif // 0
 
+/* The size of the chunks read from the data source while decoding, and written while encoding */
+#define JXL_INPUT_CHUNK_SIZE    (64 * 1024)
+#define JXL_OUTPUT_CHUNK_SIZE   (64 * 1024)
+
+/* A pool of SDL threads that runs the parallel work of libjxl.
+ * libjxl_threads isn't part of every libjxl build, so SDL_image provides its own runner.
+ * The calling thread takes part in each job as thread 0.
+ */
+typedef struct
+{
+    SDL_Mutex *lock;
+    SDL_Condition *job_ready;
+    SDL_Condition *job_done;
+    SDL_Thread **threads;
+    int num_threads;
+    int num_busy;
+    Uint32 generation;
+    bool quit;
+
+    void *jpegxl_opaque;
+    JxlParallelRunFunction func;
+    Uint32 end_range;
+    SDL_AtomicInt next_value;
+} JXL_ThreadPool;
+
+typedef struct
+{
+    JXL_ThreadPool *pool;
+    size_t thread_id;
+} JXL_ThreadData;
+
+static void JXL_RunJob(JXL_ThreadPool *pool, size_t thread_id)
+{
+    Uint32 value;
+
+    while ((value = (Uint32)SDL_AddAtomicInt(&pool->next_value, 1)) < pool->end_range) {
+        pool->func(pool->jpegxl_opaque, value, thread_id);
+    }
+}
+
+static int SDLCALL JXL_ThreadPoolWorker(void *data)
+{
+    JXL_ThreadData *thread = (JXL_ThreadData *)data;
+    JXL_ThreadPool *pool = thread->pool;
+    Uint32 generation = 0;
+
+    SDL_LockMutex(pool->lock);
+    for ( ; ; ) {
+        while (!pool->quit && pool->generation == generation) {
+            SDL_WaitCondition(pool->job_ready, pool->lock);
+        }
+        if (pool->quit) {
+            break;
+        }
+        generation = pool->generation;
+        SDL_UnlockMutex(pool->lock);
+
+        JXL_RunJob(pool, thread->thread_id);
+
+        SDL_LockMutex(pool->lock);
+        if (--pool->num_busy == 0) {
+            SDL_SignalCondition(pool->job_done);
+        }
+    }
+    SDL_UnlockMutex(pool->lock);
+    return 0;
+}
+
+static JxlParallelRetCode JXL_RunParallel(void *runner_opaque, void *jpegxl_opaque, JxlParallelRunInit init, JxlParallelRunFunction func, uint32_t start_range, uint32_t end_range)
+{
+    JXL_ThreadPool *pool = (JXL_ThreadPool *)runner_opaque;
+    JxlParallelRetCode ret;
+    uint32_t value;
+
+    ret = init(jpegxl_opaque, (size_t)pool->num_threads + 1);
+    if (ret != JXL_PARALLEL_RET_SUCCESS) {
+        return ret;
+    }
+
+    if (pool->num_threads == 0 || end_range - start_range <= 1) {
+        for (value = start_range; value < end_range; ++value) {
+            func(jpegxl_opaque, value, 0);
+        }
+        return JXL_PARALLEL_RET_SUCCESS;
+    }
+
+    SDL_LockMutex(pool->lock);
+    pool->jpegxl_opaque = jpegxl_opaque;
+    pool->func = func;
+    pool->end_range = end_range;
+    SDL_SetAtomicInt(&pool->next_value, (int)start_range);
+    pool->num_busy = pool->num_threads;
+    ++pool->generation;
+    SDL_BroadcastCondition(pool->job_ready);
+    SDL_UnlockMutex(pool->lock);
+
+    JXL_RunJob(pool, 0);
+
+    SDL_LockMutex(pool->lock);
+    while (pool->num_busy > 0) {
+        SDL_WaitCondition(pool->job_done, pool->lock);
+    }
+    SDL_UnlockMutex(pool->lock);
+
+    return JXL_PARALLEL_RET_SUCCESS;
+}
+
+static void JXL_DestroyThreadPool(JXL_ThreadPool *pool)
+{
+    int i;
+
+    if (!pool) {
+        return;
+    }
+
+    if (pool->threads) {
+        SDL_LockMutex(pool->lock);
+        pool->quit = true;
+        SDL_BroadcastCondition(pool->job_ready);
+        SDL_UnlockMutex(pool->lock);
+
+        for (i = 0; i < pool->num_threads; ++i) {
+            SDL_WaitThread(pool->threads[i], NULL);
+        }
+        SDL_free(pool->threads);
+    }
+    SDL_DestroyCondition(pool->job_done);
+    SDL_DestroyCondition(pool->job_ready);
+    SDL_DestroyMutex(pool->lock);
+    SDL_free(pool);
+}
+
+/* Returns NULL if the work should be done on the calling thread */
+static JXL_ThreadPool *JXL_CreateThreadPool(int max_threads)
+{
+    JXL_ThreadPool *pool;
+    JXL_ThreadData *data;
+    int i;
+
+    if (max_threads < 2) {
+        return NULL;
+    }
+
+    pool = (JXL_ThreadPool *)SDL_calloc(1, sizeof(*pool) + (max_threads - 1) * sizeof(*data));
+    if (!pool) {
+        return NULL;
+    }
+    data = (JXL_ThreadData *)(pool + 1);
+
+    pool->lock = SDL_CreateMutex();
+    pool->job_ready = SDL_CreateCondition();
+    pool->job_done = SDL_CreateCondition();
+    pool->threads = (SDL_Thread **)SDL_calloc(max_threads - 1, sizeof(*pool->threads));
+    if (!pool->lock || !pool->job_ready || !pool->job_done || !pool->threads) {
+        JXL_DestroyThreadPool(pool);
+        return NULL;
+    }
+
+    for (i = 0; i < max_threads - 1; ++i) {
+        data[i].pool = pool;
+        data[i].thread_id = (size_t)i + 1;
+        pool->threads[i] = SDL_CreateThread(JXL_ThreadPoolWorker, "SDL_image JXL", &data[i]);
+        if (!pool->threads[i]) {
+            break;
+        }
+        ++pool->num_threads;
+    }
+    if (pool->num_threads == 0) {
+        JXL_DestroyThreadPool(pool);
+        return NULL;
+    }
+    return pool;
+}
+
+/* Use half of the logical cores unless the application asks for a thread count */
+static int JXL_GetMaxThreads(SDL_PropertiesID props, const char *name)
+{
+    int maxLCores = SDL_GetNumLogicalCPUCores();
+    int maxThreads = (int)SDL_GetNumberProperty(props, name, 0);
+
+    if (maxThreads <= 0) {
+        maxThreads = maxLCores / 2;
+    }
+    return SDL_clamp(maxThreads, 1, maxLCores);
+}
+
+/* Keep the input that libjxl hasn't used yet and add the next chunk from the data source */
+static bool JXL_ReadInput(JxlDecoder *decoder, SDL_IOStream *src, Uint8 **input, size_t *input_size, size_t *input_used)
+{
+    size_t remaining = lib.JxlDecoderReleaseInput(decoder);
+    size_t amount;
+
+    if (remaining > 0) {
+        SDL_memmove(*input, *input + *input_used - remaining, remaining);
+    }
+    *input_used = remaining;
+
+    if (*input_used == *input_size) {
+        size_t size = *input_size ? *input_size * 2 : JXL_INPUT_CHUNK_SIZE;
+        Uint8 *buffer = (Uint8 *)SDL_realloc(*input, size);
+        if (!buffer) {
+            return false;
+        }
+        *input = buffer;
+        *input_size = size;
+    }
+
+    amount = SDL_ReadIO(src, *input + *input_used, *input_size - *input_used);
+    if (amount == 0) {
+        return SDL_SetError("Incomplete JXL image");
+    }
+    *input_used += amount;
+
+    if (lib.JxlDecoderSetInput(decoder, *input, *input_used) != JXL_DEC_SUCCESS) {
+        return SDL_SetError("Couldn't set JXL input");
+    }
+    return true;
+}
+
 /* See if an image is contained in a data source */
 bool IMG_isJXL(SDL_IOStream *src)
 {
@@ -137,17 +411,23 @@ bool IMG_isJXL(SDL_IOStream *src)
 }
 
 /* Load a JXL type image from an SDL datasource */
-SDL_Surface *IMG_LoadJXL_IO(SDL_IOStream *src)
+SDL_Surface *IMG_LoadJXLWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
 {
     Sint64 start;
-    unsigned char *data;
-    size_t datasize;
+    Uint8 *input = NULL;
+    size_t input_size = 0;
+    size_t input_used = 0;
+    JXL_ThreadPool *pool = NULL;
     JxlDecoder *decoder = NULL;
     JxlBasicInfo info;
     JxlPixelFormat format = { 4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0 };
     size_t outputsize;
     void *pixels = NULL;
     int pitch = 0;
+    IMG_ProgressCallback progress = (IMG_ProgressCallback)SDL_GetPointerProperty(props, IMG_PROP_LOAD_PROGRESS_CALLBACK_POINTER, NULL);
+    void *progress_userdata = SDL_GetPointerProperty(props, IMG_PROP_LOAD_PROGRESS_USERDATA_POINTER, NULL);
+    int events = JXL_DEC_BASIC_INFO | JXL_DEC_FULL_IMAGE;
+    int pass = 0;
     SDL_Surface *surface = NULL;
 
     if (!src) {
@@ -160,24 +440,27 @@ SDL_Surface *IMG_LoadJXL_IO(SDL_IOStream *src)
         return NULL;
     }
 
-    data = (unsigned char *)SDL_LoadFile_IO(src, &datasize, false);
-    if (!data) {
-        return NULL;
-    }
-
     decoder = lib.JxlDecoderCreate(NULL);
     if (!decoder) {
         SDL_SetError("Couldn't create JXL decoder");
         goto done;
     }
 
-    if (lib.JxlDecoderSubscribeEvents(decoder, JXL_DEC_BASIC_INFO | JXL_DEC_FULL_IMAGE) != JXL_DEC_SUCCESS) {
+    if (progress) {
+        events |= JXL_DEC_FRAME_PROGRESSION;
+    }
+    if (lib.JxlDecoderSubscribeEvents(decoder, events) != JXL_DEC_SUCCESS) {
         SDL_SetError("Couldn't subscribe to JXL events");
         goto done;
     }
+    if (progress && lib.JxlDecoderSetProgressiveDetail(decoder, kPasses) != JXL_DEC_SUCCESS) {
+        SDL_SetError("Couldn't set JXL progressive detail");
+        goto done;
+    }
 
-    if (lib.JxlDecoderSetInput(decoder, data, datasize) != JXL_DEC_SUCCESS) {
-        SDL_SetError("Couldn't set JXL input");
+    pool = JXL_CreateThreadPool(JXL_GetMaxThreads(props, IMG_PROP_LOAD_MAX_THREADS_NUMBER));
+    if (pool && lib.JxlDecoderSetParallelRunner(decoder, JXL_RunParallel, pool) != JXL_DEC_SUCCESS) {
+        SDL_SetError("Couldn't set JXL parallel runner");
         goto done;
     }
 
@@ -191,8 +474,10 @@ SDL_Surface *IMG_LoadJXL_IO(SDL_IOStream *src)
             SDL_SetError("JXL decoder error");
             goto done;
         case JXL_DEC_NEED_MORE_INPUT:
-            SDL_SetError("Incomplete JXL image");
-            goto done;
+            if (!JXL_ReadInput(decoder, src, &input, &input_size, &input_used)) {
+                goto done;
+            }
+            break;
         case JXL_DEC_BASIC_INFO:
             if (lib.JxlDecoderGetBasicInfo(decoder, &info) != JXL_DEC_SUCCESS) {
                 SDL_SetError("Couldn't get JXL image info");
@@ -225,30 +510,49 @@ SDL_Surface *IMG_LoadJXL_IO(SDL_IOStream *src)
                 goto done;
             }
             break;
+        case JXL_DEC_FRAME_PROGRESSION:
+            /* Render what has been decoded so far into the output buffer and show it */
+            if (pixels && lib.JxlDecoderFlushImage(decoder) == JXL_DEC_SUCCESS) {
+                SDL_Surface *preview = SDL_CreateSurfaceFrom(info.xsize, info.ysize, SDL_PIXELFORMAT_RGBA32, pixels, pitch);
+                bool keep_going;
+
+                if (!preview) {
+                    goto done;
+                }
+                keep_going = progress(progress_userdata, preview, ++pass);
+                SDL_DestroySurface(preview);
+                if (!keep_going) {
+                    goto finish;
+                }
+            }
+            break;
         case JXL_DEC_FULL_IMAGE:
             /* We have a full image - in the case of an animation, keep decoding until the last frame */
             break;
         case JXL_DEC_SUCCESS:
             /* All done! */
-            surface = SDL_CreateSurfaceFrom(info.xsize, info.ysize, SDL_PIXELFORMAT_RGBA32, pixels, pitch);
-            if (surface) {
-                /* Let SDL manage the memory now */
-                pixels = NULL;
-                surface->flags &= ~SDL_SURFACE_PREALLOCATED;
-            }
-            goto done;
+            goto finish;
         default:
             SDL_SetError("Unknown JXL decoding status: %d", status);
             goto done;
         }
     }
 
+finish:
+    surface = SDL_CreateSurfaceFrom(info.xsize, info.ysize, SDL_PIXELFORMAT_RGBA32, pixels, pitch);
+    if (surface) {
+        /* Let SDL manage the memory now */
+        pixels = NULL;
+        surface->flags &= ~SDL_SURFACE_PREALLOCATED;
+    }
+
 done:
     if (decoder) {
         lib.JxlDecoderDestroy(decoder);
     }
-    if (data) {
-        SDL_free(data);
+    JXL_DestroyThreadPool(pool);
+    if (input) {
+        SDL_free(input);
     }
     if (pixels) {
         SDL_free(pixels);
@@ -259,8 +563,337 @@ done:
     return surface;
 }
 
+SDL_Surface *IMG_LoadJXL_IO(SDL_IOStream *src)
+{
+    return IMG_LoadJXLWithProperties(src, 0);
+}
+
+struct IMG_AnimationDecoderContext
+{
+    JxlDecoder *decoder;              /* JXL decoder instance */
+    JXL_ThreadPool *pool;             /* Worker threads shared by every frame */
+    Uint8 *input;                     /* Input buffer, refilled in chunks */
+    size_t input_size;
+    size_t input_used;
+    JxlBasicInfo info;                /* Image size and animation timing */
+    JxlFrameHeader header;            /* Header of the frame being decoded */
+    SDL_Surface *canvas;              /* Output buffer, reused for every frame */
+};
+
+/* Run the decoder until the next frame has been composited into the canvas */
+static bool IMG_AnimationDecoderProcess_Internal(IMG_AnimationDecoder *decoder)
+{
+    IMG_AnimationDecoderContext *ctx = decoder->ctx;
+    JxlPixelFormat format = { 4, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0 };
+
+    for ( ; ; ) {
+        JxlDecoderStatus status = lib.JxlDecoderProcessInput(ctx->decoder);
+
+        switch (status) {
+        case JXL_DEC_ERROR:
+            return SDL_SetError("JXL decoder error");
+        case JXL_DEC_NEED_MORE_INPUT:
+            if (!JXL_ReadInput(ctx->decoder, decoder->src, &ctx->input, &ctx->input_size, &ctx->input_used)) {
+                return false;
+            }
+            break;
+        case JXL_DEC_BASIC_INFO:
+            if (lib.JxlDecoderGetBasicInfo(ctx->decoder, &ctx->info) != JXL_DEC_SUCCESS) {
+                return SDL_SetError("Couldn't get JXL image info");
+            }
+            if (ctx->info.xsize == 0 || ctx->info.ysize == 0 ||
+                ctx->info.xsize > SDL_MAX_SINT32 || ctx->info.ysize > SDL_MAX_SINT32) {
+                return SDL_SetError("Invalid JXL image size %ux%u", ctx->info.xsize, ctx->info.ysize);
+            }
+            /* The basic info is all that's needed when the decoder is created */
+            if (!ctx->canvas) {
+                return true;
+            }
+            break;
+        case JXL_DEC_FRAME:
+            if (lib.JxlDecoderGetFrameHeader(ctx->decoder, &ctx->header) != JXL_DEC_SUCCESS) {
+                return SDL_SetError("Couldn't get JXL frame header");
+            }
+            break;
+        case JXL_DEC_NEED_IMAGE_OUT_BUFFER:
+            format.align = (size_t)ctx->canvas->pitch;
+            if (lib.JxlDecoderSetImageOutBuffer(ctx->decoder, &format, ctx->canvas->pixels, (size_t)ctx->canvas->pitch * ctx->canvas->h) != JXL_DEC_SUCCESS) {
+                return SDL_SetError("Couldn't set JXL output buffer");
+            }
+            break;
+        case JXL_DEC_FULL_IMAGE:
+            return true;
+        case JXL_DEC_SUCCESS:
+            decoder->status = IMG_DECODER_STATUS_COMPLETE;
+            return false;
+        default:
+            return SDL_SetError("Unknown JXL decoding status: %d", status);
+        }
+    }
+}
+
+static bool IMG_AnimationDecoderReset_Internal(IMG_AnimationDecoder *decoder)
+{
+    IMG_AnimationDecoderContext *ctx = decoder->ctx;
+
+    if (SDL_SeekIO(decoder->src, decoder->start, SDL_IO_SEEK_SET) != decoder->start) {
+        return SDL_SetError("Failed to seek to beginning of JXL file");
+    }
+
+    /* The decoder keeps its events and parallel runner, and starts over with fresh input */
+    lib.JxlDecoderReleaseInput(ctx->decoder);
+    lib.JxlDecoderRewind(ctx->decoder);
+    ctx->input_used = 0;
+    decoder->accumulated_pts = 0;
+
+    return true;
+}
+
+static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *decoder, SDL_Surface **frame, Uint64 *duration)
+{
+    IMG_AnimationDecoderContext *ctx = decoder->ctx;
+
+    SDL_zero(ctx->header);
+    if (!IMG_AnimationDecoderProcess_Internal(decoder)) {
+        return false;
+    }
+
+    *frame = SDL_DuplicateSurface(ctx->canvas);
+    if (!*frame) {
+        return false;
+    }
+
+    if (ctx->info.have_animation && ctx->info.animation.tps_numerator > 0) {
+        /* Frame durations are in ticks of tps_denominator / tps_numerator seconds */
+        *duration = IMG_GetDecoderDuration(decoder, (Uint64)ctx->header.duration * ctx->info.animation.tps_denominator, ctx->info.animation.tps_numerator);
+    } else {
+        *duration = 0;
+    }
+    return true;
+}
+
+static bool IMG_AnimationDecoderClose_Internal(IMG_AnimationDecoder *decoder)
+{
+    IMG_AnimationDecoderContext *ctx = decoder->ctx;
+
+    if (ctx->decoder) {
+        lib.JxlDecoderDestroy(ctx->decoder);
+    }
+    JXL_DestroyThreadPool(ctx->pool);
+    SDL_free(ctx->input);
+    SDL_DestroySurface(ctx->canvas);
+    SDL_free(ctx);
+    decoder->ctx = NULL;
+
+    return true;
+}
+
+bool IMG_CreateJXLAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_PropertiesID props)
+{
+    IMG_AnimationDecoderContext *ctx;
+
+    if (!IMG_InitJXL()) {
+        return false;
+    }
+
+    ctx = (IMG_AnimationDecoderContext *)SDL_calloc(1, sizeof(*ctx));
+    if (!ctx) {
+        return false;
+    }
+    decoder->ctx = ctx;
+
+    ctx->decoder = lib.JxlDecoderCreate(NULL);
+    if (!ctx->decoder) {
+        SDL_SetError("Couldn't create JXL decoder");
+        goto error;
+    }
+
+    /* Frames are coalesced by libjxl, so every full image is a complete frame of the animation */
+    if (lib.JxlDecoderSubscribeEvents(ctx->decoder, JXL_DEC_BASIC_INFO | JXL_DEC_FRAME | JXL_DEC_FULL_IMAGE) != JXL_DEC_SUCCESS) {
+        SDL_SetError("Couldn't subscribe to JXL events");
+        goto error;
+    }
+
+    ctx->pool = JXL_CreateThreadPool(JXL_GetMaxThreads(props, IMG_PROP_ANIMATION_DECODER_CREATE_JXL_MAX_THREADS_NUMBER));
+    if (ctx->pool && lib.JxlDecoderSetParallelRunner(ctx->decoder, JXL_RunParallel, ctx->pool) != JXL_DEC_SUCCESS) {
+        SDL_SetError("Couldn't set JXL parallel runner");
+        goto error;
+    }
+
+    decoder->Reset = IMG_AnimationDecoderReset_Internal;
+    decoder->GetNextFrame = IMG_AnimationDecoderGetNextFrame_Internal;
+    decoder->Close = IMG_AnimationDecoderClose_Internal;
+
+    if (!IMG_AnimationDecoderProcess_Internal(decoder)) {
+        if (decoder->status == IMG_DECODER_STATUS_COMPLETE) {
+            SDL_SetError("No frames found in JXL");
+        }
+        goto error;
+    }
+
+    ctx->canvas = SDL_CreateSurface((int)ctx->info.xsize, (int)ctx->info.ysize, SDL_PIXELFORMAT_RGBA32);
+    if (!ctx->canvas) {
+        goto error;
+    }
+
+    if (!SDL_GetBooleanProperty(props, IMG_PROP_METADATA_IGNORE_PROPS_BOOLEAN, false) && ctx->info.have_animation) {
+        SDL_SetNumberProperty(decoder->props, IMG_PROP_METADATA_LOOP_COUNT_NUMBER, ctx->info.animation.num_loops);
+    }
+    return true;
+
+error:
+    IMG_AnimationDecoderClose_Internal(decoder);
+    decoder->status = IMG_DECODER_STATUS_OK;
+    return false;
+}
+
+#if SAVE_JXL
+
+/* The same mapping from quality to Butteraugli distance that cjxl uses */
+static float JXL_DistanceFromQuality(int quality)
+{
+    if (quality >= 100) {
+        return 0.0f;
+    } else if (quality >= 30) {
+        return 0.1f + (100 - quality) * 0.09f;
+    } else {
+        return 53.0f / 3000.0f * quality * quality - 23.0f / 20.0f * quality + 25.0f;
+    }
+}
+
+static bool IMG_SaveJXL_IO_libjxl(SDL_Surface *surface, SDL_IOStream *dst, int quality, SDL_PropertiesID props)
+{
+    bool lossless = SDL_GetBooleanProperty(props, IMG_PROP_SAVE_JXL_LOSSLESS_BOOLEAN, quality >= 100);
+    float distance = SDL_GetFloatProperty(props, IMG_PROP_SAVE_JXL_DISTANCE_FLOAT, -1.0f);
+    int effort = (int)SDL_GetNumberProperty(props, IMG_PROP_SAVE_JXL_EFFORT_NUMBER, 7);
+    bool has_alpha = SDL_ISPIXELFORMAT_ALPHA(surface->format);
+    SDL_PixelFormat format = has_alpha ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_RGB24;
+    JxlPixelFormat pixel_format = { has_alpha ? 4 : 3, JXL_TYPE_UINT8, JXL_NATIVE_ENDIAN, 0 };
+    SDL_Surface *temp = NULL;
+    JXL_ThreadPool *pool = NULL;
+    JxlEncoder *encoder = NULL;
+    JxlEncoderFrameSettings *settings;
+    JxlEncoderStatus status;
+    JxlBasicInfo info;
+    JxlColorEncoding color;
+    Uint8 *output = NULL;
+    bool result = false;
+
+    if (!IMG_InitJXL()) {
+        return false;
+    }
+
+    if (surface->format == format) {
+        temp = surface;
+    } else {
+        temp = SDL_ConvertSurface(surface, format);
+        if (!temp) {
+            return false;
+        }
+    }
+    /* libjxl rounds the row size up to a multiple of align, which gives exactly the surface pitch */
+    pixel_format.align = (size_t)temp->pitch;
+
+    encoder = lib.JxlEncoderCreate(NULL);
+    if (!encoder) {
+        SDL_SetError("Couldn't create JXL encoder");
+        goto done;
+    }
+
+    pool = JXL_CreateThreadPool(JXL_GetMaxThreads(props, IMG_PROP_SAVE_MAX_THREADS_NUMBER));
+    if (pool && lib.JxlEncoderSetParallelRunner(encoder, JXL_RunParallel, pool) != JXL_ENC_SUCCESS) {
+        SDL_SetError("Couldn't set JXL parallel runner");
+        goto done;
+    }
+
+    lib.JxlEncoderInitBasicInfo(&info);
+    info.xsize = (uint32_t)temp->w;
+    info.ysize = (uint32_t)temp->h;
+    info.bits_per_sample = 8;
+    info.uses_original_profile = lossless ? JXL_TRUE : JXL_FALSE;
+    if (has_alpha) {
+        info.num_extra_channels = 1;
+        info.alpha_bits = 8;
+    }
+    if (lib.JxlEncoderSetBasicInfo(encoder, &info) != JXL_ENC_SUCCESS) {
+        SDL_SetError("Couldn't set JXL image info");
+        goto done;
+    }
+
+    lib.JxlColorEncodingSetToSRGB(&color, JXL_FALSE);
+    if (lib.JxlEncoderSetColorEncoding(encoder, &color) != JXL_ENC_SUCCESS) {
+        SDL_SetError("Couldn't set JXL color encoding");
+        goto done;
+    }
+
+    settings = lib.JxlEncoderFrameSettingsCreate(encoder, NULL);
+    if (!settings) {
+        SDL_SetError("Couldn't create JXL frame settings");
+        goto done;
+    }
+    if (lossless) {
+        status = lib.JxlEncoderSetFrameLossless(settings, JXL_TRUE);
+    } else {
+        if (distance < 0.0f) {
+            distance = JXL_DistanceFromQuality(SDL_clamp(quality, 0, 99));
+        }
+        status = lib.JxlEncoderSetFrameDistance(settings, SDL_clamp(distance, 0.0f, 25.0f));
+    }
+    if (status != JXL_ENC_SUCCESS ||
+        lib.JxlEncoderFrameSettingsSetOption(settings, JXL_ENC_FRAME_SETTING_EFFORT, SDL_clamp(effort, 1, 9)) != JXL_ENC_SUCCESS) {
+        SDL_SetError("Couldn't set JXL encoder options");
+        goto done;
+    }
+
+    if (lib.JxlEncoderAddImageFrame(settings, &pixel_format, temp->pixels, (size_t)temp->pitch * temp->h) != JXL_ENC_SUCCESS) {
+        SDL_SetError("Couldn't add JXL image frame");
+        goto done;
+    }
+    lib.JxlEncoderCloseInput(encoder);
+
+    output = (Uint8 *)SDL_malloc(JXL_OUTPUT_CHUNK_SIZE);
+    if (!output) {
+        goto done;
+    }
+    do {
+        uint8_t *next_out = output;
+        size_t avail_out = JXL_OUTPUT_CHUNK_SIZE;
+        size_t amount;
+
+        status = lib.JxlEncoderProcessOutput(encoder, &next_out, &avail_out);
+        if (status == JXL_ENC_ERROR) {
+            SDL_SetError("JXL encoder error");
+            goto done;
+        }
+        amount = JXL_OUTPUT_CHUNK_SIZE - avail_out;
+        if (SDL_WriteIO(dst, output, amount) != amount) {
+            goto done;
+        }
+    } while (status == JXL_ENC_NEED_MORE_OUTPUT);
+
+    result = true;
+
+done:
+    if (output) {
+        SDL_free(output);
+    }
+    if (encoder) {
+        lib.JxlEncoderDestroy(encoder);
+    }
+    JXL_DestroyThreadPool(pool);
+    if (temp && temp != surface) {
+        SDL_DestroySurface(temp);
+    }
+    return result;
+}
+
+#endif /* SAVE_JXL */
+
 #else
 
+/* We don't have any way to save JXL files */
+#undef SAVE_JXL
+
 /* See if an image is contained in a data source */
 bool IMG_isJXL(SDL_IOStream *src)
 {
@@ -274,4 +907,84 @@ SDL_Surface *IMG_LoadJXL_IO(SDL_IOStream *src)
     return NULL;
 }
 
+SDL_Surface *IMG_LoadJXLWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    SDL_SetError("SDL_image built without JXL support");
+    return NULL;
+}
+
+bool IMG_CreateJXLAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_PropertiesID props)
+{
+    return SDL_SetError("SDL_image built without JXL animation support");
+}
+
 #endif /* LOAD_JXL */
+
+#if SAVE_JXL
+
+bool IMG_SaveJXLWithProperties_IO(SDL_Surface *surface, SDL_IOStream *dst, SDL_PropertiesID props)
+{
+    int quality = (int)SDL_GetNumberProperty(props, IMG_PROP_SAVE_QUALITY_NUMBER, 90);
+
+    if (!IMG_VerifyCanSaveSurface(surface)) {
+        return false;
+    }
+    if (!dst) {
+        return SDL_InvalidParamError("dst");
+    }
+    return IMG_SaveJXL_IO_libjxl(surface, dst, quality, props);
+}
+
+bool IMG_SaveJXL_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio, int quality)
+{
+    bool result = false;
+
+    if (!IMG_VerifyCanSaveSurface(surface)) {
+        goto done;
+    }
+    if (!dst) {
+        SDL_InvalidParamError("dst");
+        goto done;
+    }
+
+    result = IMG_SaveJXL_IO_libjxl(surface, dst, quality, 0);
+
+done:
+    if (dst && closeio) {
+        result &= SDL_CloseIO(dst);
+    }
+    return result;
+}
+
+bool IMG_SaveJXL(SDL_Surface *surface, const char *file, int quality)
+{
+    if (!IMG_VerifyCanSaveSurface(surface)) {
+        return false;
+    }
+
+    SDL_IOStream *dst = SDL_IOFromFile(file, "wb");
+    if (dst) {
+        return IMG_SaveJXL_IO(surface, dst, true, quality);
+    } else {
+        return false;
+    }
+}
+
+#else
+
+bool IMG_SaveJXL_IO(SDL_Surface *surface, SDL_IOStream *dst, bool closeio, int quality)
+{
+    return SDL_SetError("SDL_image built without JXL save support");
+}
+
+bool IMG_SaveJXL(SDL_Surface *surface, const char *file, int quality)
+{
+    return SDL_SetError("SDL_image built without JXL save support");
+}
+
+bool IMG_SaveJXLWithProperties_IO(SDL_Surface *surface, SDL_IOStream *dst, SDL_PropertiesID props)
+{
+    return SDL_SetError("SDL_image built without JXL save support");
+}
+
+#endif /* SAVE_JXL */
@@ -21,6 +21,8 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG.h"
+
 #ifdef USE_STBIMAGE
 
 #define malloc SDL_malloc
@@ -56,6 +58,15 @@
 #define STB_IMAGE_IMPLEMENTATION
 #include "stb_image.h"
 
+/* Inflate a complete zlib stream, which must fill the output exactly */
+bool IMG_InflateZlib(const Uint8 *src, size_t srclen, Uint8 *dst, size_t dstlen)
+{
+    if (srclen > SDL_MAX_SINT32 || dstlen > SDL_MAX_SINT32) {
+        return false;
+    }
+    return stbi_zlib_decode_buffer((char *)dst, (int)dstlen, (const char *)src, (int)srclen) == (int)dstlen;
+}
+
 static int IMG_LoadSTB_IO_read(void *user, char *data, int size)
 {
     size_t amount = SDL_ReadIO((SDL_IOStream*)user, data, size);
@@ -24,6 +24,9 @@
  */
 
 #include <SDL3_image/SDL_image.h>
+#include <SDL3/SDL_intrin.h>
+
+#include "IMG.h"
 
 #ifdef LOAD_SVG
 
@@ -103,34 +106,193 @@ bool IMG_isSVG(SDL_IOStream *src)
     return is_SVG;
 }
 
-/* Load a SVG type image from an SDL datasource */
-SDL_Surface *IMG_LoadSizedSVG_IO(SDL_IOStream *src, int width, int height)
+struct IMG_SVGDocument
+{
+    struct NSVGimage *image;
+};
+
+/* Rasterizers keep their edge and point buffers between images, so each thread keeps one around */
+static SDL_TLSID svg_rasterizer;
+
+static void SDLCALL SVG_DestroyRasterizer(void *rasterizer)
+{
+    nsvgDeleteRasterizer((struct NSVGrasterizer *)rasterizer);
+}
+
+static struct NSVGrasterizer *SVG_GetRasterizer(void)
+{
+    struct NSVGrasterizer *rasterizer = (struct NSVGrasterizer *)SDL_GetTLS(&svg_rasterizer);
+
+    if (!rasterizer) {
+        rasterizer = nsvgCreateRasterizer();
+        if (!rasterizer) {
+            SDL_SetError("Couldn't create SVG rasterizer");
+            return NULL;
+        }
+        if (!SDL_SetTLS(&svg_rasterizer, rasterizer, SVG_DestroyRasterizer)) {
+            nsvgDeleteRasterizer(rasterizer);
+            return NULL;
+        }
+    }
+    return rasterizer;
+}
+
+static int SVG_GetMaxThreads(SDL_PropertiesID props, const char *name)
+{
+    int maxLCores = SDL_GetNumLogicalCPUCores();
+    int maxThreads = (int)SDL_GetNumberProperty(props, name, 0);
+
+    if (maxThreads <= 0) {
+        maxThreads = maxLCores / 2;
+    }
+    return SDL_clamp(maxThreads, 1, maxLCores);
+}
+
+/* Smaller images aren't worth starting threads for */
+#define SVG_MIN_PARALLEL_PIXELS (256 * 1024)
+
+/* Horizontal bands of the output, each rasterized on its own */
+typedef struct
+{
+    struct NSVGimage *image;
+    float tx, ty;
+    float scale;
+    SDL_Surface *surface;
+    int num_bands;
+    SDL_AtomicInt next_band;
+} SVG_BandContext;
+
+static void SVG_GetBand(SVG_BandContext *ctx, int band, int *y0, int *y1)
+{
+    *y0 = (int)(((Sint64)ctx->surface->h * band) / ctx->num_bands);
+    *y1 = (int)(((Sint64)ctx->surface->h * (band + 1)) / ctx->num_bands);
+}
+
+static void SVG_RasterizeBands(SVG_BandContext *ctx)
+{
+    SDL_Surface *surface = ctx->surface;
+    struct NSVGrasterizer *rasterizer = SVG_GetRasterizer();
+    int band;
+
+    /* If this thread can't get a rasterizer, the others pick up its bands */
+    if (!rasterizer) {
+        return;
+    }
+
+    while ((band = SDL_AddAtomicInt(&ctx->next_band, 1)) < ctx->num_bands) {
+        int y0, y1;
+
+        SVG_GetBand(ctx, band, &y0, &y1);
+        nsvgRasterizeRows(rasterizer, ctx->image, ctx->tx, ctx->ty, ctx->scale, (unsigned char *)surface->pixels, surface->w, surface->h, surface->pitch, y0, y1);
+
+        /* The first and last rows need the neighbouring bands, so they're defringed once every band is done */
+        nsvgDefringeRows((unsigned char *)surface->pixels, surface->w, surface->h, surface->pitch, y0 + 1, y1 - 1);
+    }
+}
+
+static int SDLCALL SVG_RasterizeThread(void *data)
+{
+    SVG_RasterizeBands((SVG_BandContext *)data);
+    return 0;
+}
+
+/* Rasterize the image on several threads, with the same result as a single nsvgRasterize() call */
+static bool SVG_RasterizeParallel(struct NSVGimage *image, float tx, float ty, float scale, SDL_Surface *surface, int num_threads)
+{
+    SVG_BandContext ctx;
+    SDL_Thread **threads;
+    int band;
+    int i;
+
+    threads = (SDL_Thread **)SDL_calloc(num_threads, sizeof(*threads));
+    if (!threads) {
+        return false;
+    }
+
+    SDL_zero(ctx);
+    ctx.image = image;
+    ctx.tx = tx;
+    ctx.ty = ty;
+    ctx.scale = scale;
+    ctx.surface = surface;
+    ctx.num_bands = num_threads;
+
+    /* This thread rasterizes bands too, and picks up any that other threads couldn't */
+    for (i = 1; i < num_threads; ++i) {
+        threads[i] = SDL_CreateThread(SVG_RasterizeThread, "SDL_image SVG", &ctx);
+    }
+    SVG_RasterizeBands(&ctx);
+    for (i = 1; i < num_threads; ++i) {
+        if (threads[i]) {
+            SDL_WaitThread(threads[i], NULL);
+        }
+    }
+    SDL_free(threads);
+
+    /* Bands are only left over if no thread could get a rasterizer */
+    if (SDL_GetAtomicInt(&ctx.next_band) < ctx.num_bands) {
+        return false;
+    }
+
+    for (band = 0; band < ctx.num_bands; ++band) {
+        int y0, y1;
+
+        SVG_GetBand(&ctx, band, &y0, &y1);
+        nsvgDefringeRows((unsigned char *)surface->pixels, surface->w, surface->h, surface->pitch, y0, y0 + 1);
+        nsvgDefringeRows((unsigned char *)surface->pixels, surface->w, surface->h, surface->pitch, y1 - 1, y1);
+    }
+    return true;
+}
+
+static struct NSVGimage *SVG_Parse(SDL_IOStream *src)
 {
     char *data;
+    size_t size;
     struct NSVGimage *image;
-    struct NSVGrasterizer *rasterizer;
-    SDL_Surface *surface = NULL;
-    float scale = 1.0f;
 
-    data = (char *)SDL_LoadFile_IO(src, NULL, false);
+    data = (char *)SDL_LoadFile_IO(src, &size, false);
     if (!data) {
         return NULL;
     }
 
     /* For now just use default units of pixels at 96 DPI */
-    image = nsvgParse(data, "px", 96.0f);
+    image = nsvgParseBuffer(data, size, "px", 96.0f);
     SDL_free(data);
     if (!image || image->width <= 0.0f || image->height <= 0.0f) {
         SDL_SetError("Couldn't parse SVG image");
+        if (image) {
+            nsvgDelete(image);
+        }
         return NULL;
     }
+    return image;
+}
+
+/* Rasterize the image into the whole surface, offset by tx, ty pixels after scaling */
+static bool SVG_RasterizeSurface(struct NSVGimage *image, float tx, float ty, float scale, SDL_Surface *surface, int max_threads)
+{
+    struct NSVGrasterizer *rasterizer;
+    int num_threads;
+
+    /* Each band needs a few rows to be worth flattening the shapes again */
+    num_threads = (int)SDL_min(max_threads, ((Sint64)surface->w * surface->h) / SVG_MIN_PARALLEL_PIXELS);
+    num_threads = SDL_min(num_threads, surface->h / 16);
+    if (num_threads >= 2) {
+        return SVG_RasterizeParallel(image, tx, ty, scale, surface, num_threads);
+    }
 
-    rasterizer = nsvgCreateRasterizer();
+    rasterizer = SVG_GetRasterizer();
     if (!rasterizer) {
-        SDL_SetError("Couldn't create SVG rasterizer");
-        nsvgDelete(image);
-        return NULL;
+        return false;
     }
+    nsvgRasterize(rasterizer, image, tx, ty, scale, (unsigned char *)surface->pixels, surface->w, surface->h, surface->pitch);
+    return true;
+}
+
+static SDL_Surface *SVG_Rasterize(struct NSVGimage *image, int width, int height, int max_threads)
+{
+    SDL_Surface *surface = NULL;
+    float scale = 1.0f;
 
     if (width > 0 && height > 0) {
         float scale_x = (float)width / image->width;
@@ -150,18 +312,146 @@ SDL_Surface *IMG_LoadSizedSVG_IO(SDL_IOStream *src, int width, int height)
                                 SDL_PIXELFORMAT_RGBA32);
 
     if (!surface) {
-        nsvgDeleteRasterizer(rasterizer);
-        nsvgDelete(image);
         return NULL;
     }
 
-    nsvgRasterize(rasterizer, image, 0.0f, 0.0f, scale, (unsigned char *)surface->pixels, surface->w, surface->h, surface->pitch);
-    nsvgDeleteRasterizer(rasterizer);
+    if (!SVG_RasterizeSurface(image, 0.0f, 0.0f, scale, surface, max_threads)) {
+        SDL_DestroySurface(surface);
+        return NULL;
+    }
+    return surface;
+}
+
+static SDL_Surface *SVG_Load(SDL_IOStream *src, int width, int height, int max_threads)
+{
+    struct NSVGimage *image;
+    SDL_Surface *surface;
+
+    image = SVG_Parse(src);
+    if (!image) {
+        return NULL;
+    }
+
+    surface = SVG_Rasterize(image, width, height, max_threads);
     nsvgDelete(image);
 
     return surface;
 }
 
+/* Load a SVG type image from an SDL datasource */
+SDL_Surface *IMG_LoadSizedSVG_IO(SDL_IOStream *src, int width, int height)
+{
+    return SVG_Load(src, width, height, SVG_GetMaxThreads(0, NULL));
+}
+
+SDL_Surface *IMG_LoadSVGWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    int width = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_WIDTH_NUMBER, 0);
+    int height = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_HEIGHT_NUMBER, 0);
+
+    return SVG_Load(src, width, height, SVG_GetMaxThreads(props, IMG_PROP_LOAD_MAX_THREADS_NUMBER));
+}
+
+IMG_SVGDocument *IMG_LoadSVGDocument_IO(SDL_IOStream *src, bool closeio)
+{
+    IMG_SVGDocument *document = NULL;
+    struct NSVGimage *image;
+
+    if (!src) {
+        SDL_InvalidParamError("src");
+        return NULL;
+    }
+
+    image = SVG_Parse(src);
+    if (image) {
+        document = (IMG_SVGDocument *)SDL_malloc(sizeof(*document));
+        if (document) {
+            document->image = image;
+        } else {
+            nsvgDelete(image);
+        }
+    }
+    if (closeio) {
+        SDL_CloseIO(src);
+    }
+    return document;
+}
+
+bool IMG_GetSVGDocumentSize(IMG_SVGDocument *document, float *width, float *height)
+{
+    if (!document) {
+        return SDL_InvalidParamError("document");
+    }
+
+    if (width) {
+        *width = document->image->width;
+    }
+    if (height) {
+        *height = document->image->height;
+    }
+    return true;
+}
+
+SDL_Surface *IMG_RasterizeSVG(IMG_SVGDocument *document, int width, int height)
+{
+    if (!document) {
+        SDL_InvalidParamError("document");
+        return NULL;
+    }
+
+    return SVG_Rasterize(document->image, width, height, SVG_GetMaxThreads(0, NULL));
+}
+
+SDL_Surface *IMG_RasterizeSVGRegion(IMG_SVGDocument *document, float x, float y, float scale, int width, int height)
+{
+    SDL_Surface *surface;
+
+    if (!document) {
+        SDL_InvalidParamError("document");
+        return NULL;
+    }
+    if (SDL_isinff(x) || SDL_isnanf(x)) {
+        SDL_InvalidParamError("x");
+        return NULL;
+    }
+    if (SDL_isinff(y) || SDL_isnanf(y)) {
+        SDL_InvalidParamError("y");
+        return NULL;
+    }
+    if (!(scale > 0.0f) || SDL_isinff(scale)) {
+        SDL_InvalidParamError("scale");
+        return NULL;
+    }
+    if (width <= 0) {
+        SDL_InvalidParamError("width");
+        return NULL;
+    }
+    if (height <= 0) {
+        SDL_InvalidParamError("height");
+        return NULL;
+    }
+
+    surface = SDL_CreateSurface(width, height, SDL_PIXELFORMAT_RGBA32);
+    if (!surface) {
+        return NULL;
+    }
+
+    /* Shapes outside the region are culled by the rasterizer before their edges are built */
+    if (!SVG_RasterizeSurface(document->image, -x * scale, -y * scale, scale, surface, SVG_GetMaxThreads(0, NULL))) {
+        SDL_DestroySurface(surface);
+        return NULL;
+    }
+    return surface;
+}
+
+void IMG_FreeSVGDocument(IMG_SVGDocument *document)
+{
+    if (document) {
+        nsvgDelete(document->image);
+        SDL_free(document);
+    }
+}
+
 #else
 
 /* See if an image is contained in a data source */
@@ -177,6 +467,42 @@ SDL_Surface *IMG_LoadSizedSVG_IO(SDL_IOStream *src, int width, int height)
     return NULL;
 }
 
+SDL_Surface *IMG_LoadSVGWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    SDL_SetError("SDL_image built without SVG support");
+    return NULL;
+}
+
+IMG_SVGDocument *IMG_LoadSVGDocument_IO(SDL_IOStream *src, bool closeio)
+{
+    if (src && closeio) {
+        SDL_CloseIO(src);
+    }
+    SDL_SetError("SDL_image built without SVG support");
+    return NULL;
+}
+
+bool IMG_GetSVGDocumentSize(IMG_SVGDocument *document, float *width, float *height)
+{
+    return SDL_SetError("SDL_image built without SVG support");
+}
+
+SDL_Surface *IMG_RasterizeSVG(IMG_SVGDocument *document, int width, int height)
+{
+    SDL_SetError("SDL_image built without SVG support");
+    return NULL;
+}
+
+SDL_Surface *IMG_RasterizeSVGRegion(IMG_SVGDocument *document, float x, float y, float scale, int width, int height)
+{
+    SDL_SetError("SDL_image built without SVG support");
+    return NULL;
+}
+
+void IMG_FreeSVGDocument(IMG_SVGDocument *document)
+{
+}
+
 #endif /* LOAD_SVG */
 
 /* Load a SVG type image from an SDL datasource */
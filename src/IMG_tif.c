@@ -25,6 +25,10 @@
 
 #include <SDL3_image/SDL_image.h>
 
+#include "IMG.h"
+#include "IMG_anim_decoder.h"
+#include "IMG_utils.h"
+
 #ifdef LOAD_TIF
 
 #include <tiffio.h>
@@ -44,6 +48,18 @@ static struct {
     TIFF* (*TIFFClientOpen)(const char*, const char*, thandle_t, TIFFReadWriteProc, TIFFReadWriteProc, TIFFSeekProc, TIFFCloseProc, TIFFSizeProc, TIFFMapFileProc, TIFFUnmapFileProc);
     void (*TIFFClose)(TIFF*);
     int (*TIFFGetField)(TIFF*, ttag_t, ...);
+    tdir_t (*TIFFNumberOfDirectories)(TIFF*);
+    int (*TIFFSetDirectory)(TIFF*, tdir_t);
+    int (*TIFFSetSubDirectory)(TIFF*, uint64_t);
+    int (*TIFFReadDirectory)(TIFF*);
+    int (*TIFFLastDirectory)(TIFF*);
+    uint64_t (*TIFFCurrentDirOffset)(TIFF*);
+    int (*TIFFIsTiled)(TIFF*);
+    uint32_t (*TIFFNumberOfStrips)(TIFF*);
+    uint32_t (*TIFFNumberOfTiles)(TIFF*);
+    tmsize_t (*TIFFTileSize)(TIFF*);
+    tmsize_t (*TIFFReadEncodedStrip)(TIFF*, uint32_t, void*, tmsize_t);
+    tmsize_t (*TIFFReadEncodedTile)(TIFF*, uint32_t, void*, tmsize_t);
     int (*TIFFReadRGBAImageOriented)(TIFF*, Uint32, Uint32, Uint32*, int, int);
     TIFFErrorHandler (*TIFFSetErrorHandler)(TIFFErrorHandler);
 } lib;
@@ -69,6 +85,18 @@ static bool IMG_InitTIF(void)
         FUNCTION_LOADER(TIFFClientOpen, TIFF * (*)(const char*, const char*, thandle_t, TIFFReadWriteProc, TIFFReadWriteProc, TIFFSeekProc, TIFFCloseProc, TIFFSizeProc, TIFFMapFileProc, TIFFUnmapFileProc))
         FUNCTION_LOADER(TIFFClose, void (*)(TIFF*))
         FUNCTION_LOADER(TIFFGetField, int (*)(TIFF*, ttag_t, ...))
+        FUNCTION_LOADER(TIFFNumberOfDirectories, tdir_t (*)(TIFF*))
+        FUNCTION_LOADER(TIFFSetDirectory, int (*)(TIFF*, tdir_t))
+        FUNCTION_LOADER(TIFFSetSubDirectory, int (*)(TIFF*, uint64_t))
+        FUNCTION_LOADER(TIFFReadDirectory, int (*)(TIFF*))
+        FUNCTION_LOADER(TIFFLastDirectory, int (*)(TIFF*))
+        FUNCTION_LOADER(TIFFCurrentDirOffset, uint64_t (*)(TIFF*))
+        FUNCTION_LOADER(TIFFIsTiled, int (*)(TIFF*))
+        FUNCTION_LOADER(TIFFNumberOfStrips, uint32_t (*)(TIFF*))
+        FUNCTION_LOADER(TIFFNumberOfTiles, uint32_t (*)(TIFF*))
+        FUNCTION_LOADER(TIFFTileSize, tmsize_t (*)(TIFF*))
+        FUNCTION_LOADER(TIFFReadEncodedStrip, tmsize_t (*)(TIFF*, uint32_t, void*, tmsize_t))
+        FUNCTION_LOADER(TIFFReadEncodedTile, tmsize_t (*)(TIFF*, uint32_t, void*, tmsize_t))
         FUNCTION_LOADER(TIFFReadRGBAImageOriented, int (*)(TIFF*, Uint32, Uint32, Uint32*, int, int))
         FUNCTION_LOADER(TIFFSetErrorHandler, TIFFErrorHandler (*)(TIFFErrorHandler))
     }
@@ -122,7 +150,17 @@ static int tiff_close(thandle_t fd)
 
 static int tiff_map(thandle_t fd, tdata_t* pbase, toff_t* psize)
 {
-    return (0);
+    /* Memory streams can be read in place, so libtiff doesn't copy the strips */
+    SDL_PropertiesID props = SDL_GetIOProperties((SDL_IOStream*)fd);
+    void *base = SDL_GetPointerProperty(props, SDL_PROP_IOSTREAM_MEMORY_POINTER, NULL);
+    Sint64 size = SDL_GetNumberProperty(props, SDL_PROP_IOSTREAM_MEMORY_SIZE_NUMBER, 0);
+
+    if (!base || size <= 0) {
+        return (0);
+    }
+    *pbase = base;
+    *psize = (toff_t)size;
+    return (1);
 }
 
 static void tiff_unmap(thandle_t fd, tdata_t base, toff_t size)
@@ -170,38 +208,270 @@ bool IMG_isTIF(SDL_IOStream * src)
     return is_TIF;
 }
 
-SDL_Surface* IMG_LoadTIF_IO(SDL_IOStream * src)
+static TIFF *TIF_Open(SDL_IOStream *src)
 {
-    Sint64 start;
-    TIFF* tiff = NULL;
-    SDL_Surface* surface = NULL;
-    Uint32 img_width, img_height;
-    Uint16 img_orientation = 1;
+    return lib.TIFFClientOpen("SDL_image", "r", (thandle_t)src,
+        tiff_read, tiff_write, tiff_seek, tiff_close, tiff_size, tiff_map, tiff_unmap);
+}
 
-    if ( !src ) {
-        /* The error message has been set in SDL_IOFromFile */
+static int TIF_GetMaxThreads(SDL_PropertiesID props, const char *name)
+{
+    int maxLCores = SDL_GetNumLogicalCPUCores();
+    int maxThreads = (int)SDL_GetNumberProperty(props, name, 0);
+
+    if (maxThreads <= 0) {
+        maxThreads = maxLCores / 2;
+    }
+    return SDL_clamp(maxThreads, 1, maxLCores);
+}
+
+/* Smaller images aren't worth starting threads for */
+#define TIF_MIN_PARALLEL_PIXELS (256 * 1024)
+
+/* Strips and tiles of a contiguous 8-bit image, decoded into the surface in display orientation */
+typedef struct
+{
+    SDL_Surface *surface;
+    int width;
+    int height;
+    int orientation;
+    int bpp;
+    bool tiled;
+    int chunk_width;
+    int chunk_height;
+    int chunks_across;
+    int num_chunks;
+    size_t chunk_size;
+    uint64_t dir_offset;
+    const Uint8 *data;
+    size_t size;
+    SDL_AtomicInt next_chunk;
+    SDL_AtomicInt failed;
+} TIF_ChunkContext;
+
+/* Map the TIFF layout onto a native surface format, or return SDL_PIXELFORMAT_UNKNOWN */
+static SDL_PixelFormat TIF_GetDirectFormat(TIFF *tiff)
+{
+    Uint16 bits = 1, samples = 1, planar = PLANARCONFIG_CONTIG, photometric = 0, sampleformat = SAMPLEFORMAT_UINT;
+    Uint16 extra_count = 0;
+    Uint16 *extra_types = NULL;
+
+    lib.TIFFGetField(tiff, TIFFTAG_BITSPERSAMPLE, &bits);
+    lib.TIFFGetField(tiff, TIFFTAG_SAMPLESPERPIXEL, &samples);
+    lib.TIFFGetField(tiff, TIFFTAG_PLANARCONFIG, &planar);
+    lib.TIFFGetField(tiff, TIFFTAG_SAMPLEFORMAT, &sampleformat);
+    lib.TIFFGetField(tiff, TIFFTAG_EXTRASAMPLES, &extra_count, &extra_types);
+    if (!lib.TIFFGetField(tiff, TIFFTAG_PHOTOMETRIC, &photometric)) {
+        return SDL_PIXELFORMAT_UNKNOWN;
+    }
+    if (bits != 8 || planar != PLANARCONFIG_CONTIG || sampleformat != SAMPLEFORMAT_UINT) {
+        return SDL_PIXELFORMAT_UNKNOWN;
+    }
+
+    if (photometric == PHOTOMETRIC_MINISBLACK && samples == 1) {
+        return SDL_PIXELFORMAT_INDEX8;
+    }
+    if (photometric == PHOTOMETRIC_RGB) {
+        if (samples == 3) {
+            return SDL_PIXELFORMAT_RGB24;
+        }
+        /* Premultiplied alpha is left to libtiff */
+        if (samples == 4 && extra_count == 1 && extra_types && extra_types[0] == EXTRASAMPLE_UNASSALPHA) {
+            return SDL_PIXELFORMAT_RGBA32;
+        }
+    }
+    return SDL_PIXELFORMAT_UNKNOWN;
+}
+
+static bool TIF_DecodeChunks(TIF_ChunkContext *ctx, TIFF *tiff)
+{
+    SDL_Surface *surface = ctx->surface;
+    int src_pitch = ctx->chunk_width * ctx->bpp;
+    bool direct = (!ctx->tiled && ctx->orientation == 1 && surface->pitch == src_pitch);
+    Uint8 *buffer = NULL;
+    int chunk;
+
+    if (!direct) {
+        buffer = (Uint8 *)SDL_malloc(ctx->chunk_size);
+        if (!buffer) {
+            return false;
+        }
+    }
+
+    while ((chunk = SDL_AddAtomicInt(&ctx->next_chunk, 1)) < ctx->num_chunks) {
+        int x = (chunk % ctx->chunks_across) * ctx->chunk_width;
+        int y = (chunk / ctx->chunks_across) * ctx->chunk_height;
+        int cols = SDL_min(ctx->chunk_width, ctx->width - x);
+        int rows = SDL_min(ctx->chunk_height, ctx->height - y);
+        tmsize_t amount;
+
+        if (SDL_GetAtomicInt(&ctx->failed)) {
+            break;
+        }
+        if (ctx->tiled) {
+            amount = lib.TIFFReadEncodedTile(tiff, (uint32_t)chunk, buffer, (tmsize_t)ctx->chunk_size);
+        } else if (direct) {
+            /* Rows are already in place, so decompress straight into the surface */
+            amount = lib.TIFFReadEncodedStrip(tiff, (uint32_t)chunk, (Uint8 *)surface->pixels + (size_t)y * surface->pitch, (tmsize_t)rows * src_pitch);
+        } else {
+            amount = lib.TIFFReadEncodedStrip(tiff, (uint32_t)chunk, buffer, (tmsize_t)rows * src_pitch);
+        }
+        if (amount < 0) {
+            SDL_SetAtomicInt(&ctx->failed, 1);
+            break;
+        }
+        if (!direct) {
+            IMG_OrientPixelsRect((Uint8 *)surface->pixels, surface->pitch, buffer, src_pitch,
+                                 ctx->width, ctx->height, x, y, cols, rows, ctx->bpp, ctx->orientation);
+        }
+    }
+    SDL_free(buffer);
+    return true;
+}
+
+static int SDLCALL TIF_DecodeThread(void *data)
+{
+    TIF_ChunkContext *ctx = (TIF_ChunkContext *)data;
+    SDL_IOStream *src;
+    TIFF *tiff = NULL;
+
+    /* libtiff handles can't be shared, so each thread reads its own view of the file */
+    src = SDL_IOFromConstMem(ctx->data, ctx->size);
+    if (src) {
+        tiff = TIF_Open(src);
+    }
+    if (tiff) {
+        /* Later pages are found by the offset of their directory, without walking the ones before */
+        if ((lib.TIFFCurrentDirOffset(tiff) != ctx->dir_offset && !lib.TIFFSetSubDirectory(tiff, ctx->dir_offset)) ||
+            !TIF_DecodeChunks(ctx, tiff)) {
+            SDL_SetAtomicInt(&ctx->failed, 1);
+        }
+        lib.TIFFClose(tiff);
+    }
+    if (src) {
+        SDL_CloseIO(src);
+    }
+    return 0;
+}
+
+/* Read a contiguous 8-bit image strip by strip or tile by tile, on several threads if it's large */
+static SDL_Surface *TIF_LoadDirect(TIFF *tiff, SDL_IOStream *src, Sint64 start, SDL_PixelFormat format,
+                                   int width, int height, int orientation, int max_threads)
+{
+    TIF_ChunkContext ctx;
+    SDL_Thread **threads = NULL;
+    Uint8 *data = NULL;
+    int num_threads;
+    int i;
+
+    SDL_zero(ctx);
+    ctx.width = width;
+    ctx.height = height;
+    ctx.orientation = orientation;
+    ctx.bpp = SDL_BYTESPERPIXEL(format);
+    ctx.dir_offset = lib.TIFFCurrentDirOffset(tiff);
+    ctx.tiled = lib.TIFFIsTiled(tiff) ? true : false;
+    if (ctx.tiled) {
+        Uint32 tile_width = 0, tile_height = 0;
+
+        lib.TIFFGetField(tiff, TIFFTAG_TILEWIDTH, &tile_width);
+        lib.TIFFGetField(tiff, TIFFTAG_TILELENGTH, &tile_height);
+        if (tile_width == 0 || tile_height == 0 || tile_width > 65536 || tile_height > 65536) {
+            return NULL;
+        }
+        ctx.chunk_width = (int)tile_width;
+        ctx.chunk_height = (int)tile_height;
+        ctx.num_chunks = (int)lib.TIFFNumberOfTiles(tiff);
+        ctx.chunk_size = (size_t)lib.TIFFTileSize(tiff);
+    } else {
+        Uint32 rows_per_strip = (Uint32)height;
+
+        lib.TIFFGetField(tiff, TIFFTAG_ROWSPERSTRIP, &rows_per_strip);
+        ctx.chunk_width = width;
+        ctx.chunk_height = (int)SDL_clamp(rows_per_strip, 1, (Uint32)height);
+        ctx.num_chunks = (int)lib.TIFFNumberOfStrips(tiff);
+        ctx.chunk_size = (size_t)ctx.chunk_height * width * ctx.bpp;
+    }
+    ctx.chunks_across = (width + ctx.chunk_width - 1) / ctx.chunk_width;
+    if (ctx.num_chunks != ctx.chunks_across * ((height + ctx.chunk_height - 1) / ctx.chunk_height) ||
+        ctx.chunk_size < (size_t)ctx.chunk_width * ctx.chunk_height * ctx.bpp) {
+        /* Not the layout we expect, let libtiff sort it out */
         return NULL;
     }
-    start = SDL_TellIO(src);
 
-    if (!IMG_InitTIF()) {
+    if (orientation >= 5) {
+        ctx.surface = SDL_CreateSurface(height, width, format);
+    } else {
+        ctx.surface = SDL_CreateSurface(width, height, format);
+    }
+    if (!ctx.surface) {
         return NULL;
     }
+    if (format == SDL_PIXELFORMAT_INDEX8) {
+        SDL_Palette *palette = SDL_CreateSurfacePalette(ctx.surface);
+        if (!palette) {
+            SDL_DestroySurface(ctx.surface);
+            return NULL;
+        }
+        for (i = 0; i < palette->ncolors; ++i) {
+            palette->colors[i].r = palette->colors[i].g = palette->colors[i].b = (Uint8)i;
+        }
+    }
 
-    /* turn off memory mapped access with the m flag */
-    tiff = lib.TIFFClientOpen("SDL_image", "rm", (thandle_t)src,
-        tiff_read, tiff_write, tiff_seek, tiff_close, tiff_size, tiff_map, tiff_unmap);
-    if(!tiff)
-        goto error;
+    num_threads = (int)SDL_min(max_threads, ((Sint64)width * height) / TIF_MIN_PARALLEL_PIXELS);
+    num_threads = SDL_min(num_threads, ctx.num_chunks);
+    if (num_threads >= 2) {
+        /* The other threads open the file again, so they need it in memory */
+        SDL_PropertiesID props = SDL_GetIOProperties(src);
+        const Uint8 *base = (const Uint8 *)SDL_GetPointerProperty(props, SDL_PROP_IOSTREAM_MEMORY_POINTER, NULL);
+        Sint64 size = SDL_GetNumberProperty(props, SDL_PROP_IOSTREAM_MEMORY_SIZE_NUMBER, 0);
+
+        if (base && start >= 0 && size > start) {
+            ctx.data = base + start;
+            ctx.size = (size_t)(size - start);
+        } else if (SDL_SeekIO(src, start, SDL_IO_SEEK_SET) == start) {
+            data = (Uint8 *)SDL_LoadFile_IO(src, &ctx.size, false);
+            ctx.data = data;
+        }
+        if (ctx.data) {
+            threads = (SDL_Thread **)SDL_calloc(num_threads, sizeof(*threads));
+        }
+    }
 
-    /* Retrieve the dimensions of the image from the TIFF tags */
-    lib.TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &img_width);
-    lib.TIFFGetField(tiff, TIFFTAG_IMAGELENGTH, &img_height);
-    lib.TIFFGetField(tiff, TIFFTAG_ORIENTATION, &img_orientation);
+    /* This thread decodes chunks too, and picks up any that other threads couldn't */
+    if (threads) {
+        for (i = 1; i < num_threads; ++i) {
+            threads[i] = SDL_CreateThread(TIF_DecodeThread, "SDL_image TIFF", &ctx);
+        }
+    }
+    if (!TIF_DecodeChunks(&ctx, tiff)) {
+        SDL_SetAtomicInt(&ctx.failed, 1);
+    }
+    if (threads) {
+        for (i = 1; i < num_threads; ++i) {
+            if (threads[i]) {
+                SDL_WaitThread(threads[i], NULL);
+            }
+        }
+        SDL_free(threads);
+    }
+    SDL_free(data);
 
-    surface = SDL_CreateSurface(img_width, img_height, SDL_PIXELFORMAT_ABGR8888);
-    if(!surface)
-        goto error;
+    if (SDL_GetAtomicInt(&ctx.failed)) {
+        SDL_SetError("Couldn't decode TIFF image data");
+        SDL_DestroySurface(ctx.surface);
+        return NULL;
+    }
+    return ctx.surface;
+}
+
+/* Anything else goes through libtiff's RGBA conversion */
+static SDL_Surface *TIF_LoadRGBA(TIFF *tiff, Uint32 img_width, Uint32 img_height, Uint16 img_orientation)
+{
+    SDL_Surface *surface = SDL_CreateSurface(img_width, img_height, SDL_PIXELFORMAT_ABGR8888);
+    if (!surface) {
+        return NULL;
+    }
 
     int load_orientation;
     switch (img_orientation) {
@@ -215,48 +485,249 @@ SDL_Surface* IMG_LoadTIF_IO(SDL_IOStream * src)
         load_orientation = ORIENTATION_TOPLEFT;
         break;
     }
-    if(!lib.TIFFReadRGBAImageOriented(tiff, img_width, img_height, (Uint32 *)surface->pixels, load_orientation, 0)) {
-        goto error;
+    if (!lib.TIFFReadRGBAImageOriented(tiff, img_width, img_height, (Uint32 *)surface->pixels, load_orientation, 0)) {
+        SDL_DestroySurface(surface);
+        return NULL;
     }
 
-    lib.TIFFClose(tiff);
-
-    SDL_Surface *rotated;
     switch (img_orientation) {
     case 5:
     case 7:
-        rotated = SDL_RotateSurface(surface, 270.0f);
-        if (!rotated) {
-            goto error;
-        }
-        SDL_DestroySurface(surface);
-        surface = rotated;
+        // Rotate 270 CW
+        surface = IMG_OrientSurface(surface, 8);
         break;
     case 6:
     case 8:
-        rotated = SDL_RotateSurface(surface, 90.0f);
-        if (!rotated) {
-            goto error;
-        }
-        SDL_DestroySurface(surface);
-        surface = rotated;
+        // Rotate 90 CW
+        surface = IMG_OrientSurface(surface, 6);
         break;
     default:
         break;
     }
     return surface;
+}
+
+/* Load the page of the current TIFF directory */
+static SDL_Surface *TIF_LoadPage(TIFF *tiff, SDL_IOStream *src, Sint64 start, int max_threads)
+{
+    SDL_Surface *surface = NULL;
+    Uint32 img_width = 0, img_height = 0;
+    Uint16 img_orientation = 1;
+    SDL_PixelFormat format;
+
+    /* Retrieve the dimensions of the image from the TIFF tags */
+    lib.TIFFGetField(tiff, TIFFTAG_IMAGEWIDTH, &img_width);
+    lib.TIFFGetField(tiff, TIFFTAG_IMAGELENGTH, &img_height);
+    lib.TIFFGetField(tiff, TIFFTAG_ORIENTATION, &img_orientation);
+    if (img_orientation < 1 || img_orientation > 8) {
+        img_orientation = 1;
+    }
+
+    format = TIF_GetDirectFormat(tiff);
+    if (format != SDL_PIXELFORMAT_UNKNOWN && img_width > 0 && img_height > 0 &&
+        img_width <= SDL_MAX_SINT32 / 4 && img_height <= SDL_MAX_SINT32) {
+        surface = TIF_LoadDirect(tiff, src, start, format, (int)img_width, (int)img_height, img_orientation, max_threads);
+    }
+    if (!surface) {
+        surface = TIF_LoadRGBA(tiff, img_width, img_height, img_orientation);
+    }
+    return surface;
+}
+
+static SDL_Surface *TIF_LoadPageWithProperties(SDL_IOStream *src, int page, SDL_PropertiesID props)
+{
+    Sint64 start;
+    TIFF* tiff = NULL;
+    SDL_Surface* surface = NULL;
+
+    if ( !src ) {
+        /* The error message has been set in SDL_IOFromFile */
+        return NULL;
+    }
+    if (page < 0) {
+        SDL_InvalidParamError("page");
+        return NULL;
+    }
+    start = SDL_TellIO(src);
+
+    if (!IMG_InitTIF()) {
+        return NULL;
+    }
+
+    tiff = TIF_Open(src);
+    if(!tiff)
+        goto error;
+
+    /* libtiff follows the chain of directory offsets, so earlier pages aren't decoded */
+    if (page > 0 && ((int)(tdir_t)page != page || !lib.TIFFSetDirectory(tiff, (tdir_t)page))) {
+        SDL_SetError("Couldn't find TIFF page %d", page);
+        goto error;
+    }
+
+    surface = TIF_LoadPage(tiff, src, start, TIF_GetMaxThreads(props, IMG_PROP_LOAD_MAX_THREADS_NUMBER));
+    if (!surface) {
+        goto error;
+    }
+
+    lib.TIFFClose(tiff);
+    return surface;
 
 error:
     SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
-    if (surface) {
-        SDL_DestroySurface(surface);
-    }
     if (tiff) {
         lib.TIFFClose(tiff);
     }
     return NULL;
 }
 
+SDL_Surface *IMG_LoadTIFWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    return TIF_LoadPageWithProperties(src, 0, props);
+}
+
+SDL_Surface* IMG_LoadTIF_IO(SDL_IOStream * src)
+{
+    return IMG_LoadTIFWithProperties(src, 0);
+}
+
+SDL_Surface *IMG_LoadTIFPage_IO(SDL_IOStream *src, int page)
+{
+    return TIF_LoadPageWithProperties(src, page, 0);
+}
+
+int IMG_GetTIFPageCount_IO(SDL_IOStream *src)
+{
+    Sint64 start;
+    TIFF *tiff;
+    int count;
+
+    if (!src) {
+        SDL_InvalidParamError("src");
+        return 0;
+    }
+    start = SDL_TellIO(src);
+
+    if (!IMG_InitTIF()) {
+        return 0;
+    }
+
+    tiff = TIF_Open(src);
+    if (!tiff) {
+        SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+        SDL_SetError("Couldn't open TIFF image");
+        return 0;
+    }
+
+    /* Only the directory headers are read, not the image data */
+    count = (int)lib.TIFFNumberOfDirectories(tiff);
+    lib.TIFFClose(tiff);
+    SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+
+    if (count <= 0) {
+        SDL_SetError("TIFF image doesn't have any pages");
+        return 0;
+    }
+    return count;
+}
+
+struct IMG_AnimationDecoderContext
+{
+    TIFF *tiff;                       /* libtiff handle, positioned at the next page */
+    int page;                         /* Index of the next page */
+    int max_threads;                  /* Threads used to decode each page */
+};
+
+static bool IMG_AnimationDecoderReset_Internal(IMG_AnimationDecoder *decoder)
+{
+    IMG_AnimationDecoderContext *ctx = decoder->ctx;
+
+    if (ctx->page > 0 && !lib.TIFFSetDirectory(ctx->tiff, 0)) {
+        return SDL_SetError("Failed to seek to first TIFF page");
+    }
+    ctx->page = 0;
+    decoder->accumulated_pts = 0;
+
+    return true;
+}
+
+static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *decoder, SDL_Surface **frame, Uint64 *duration)
+{
+    IMG_AnimationDecoderContext *ctx = decoder->ctx;
+
+    /* Each page is read when it's asked for, so only one is in memory at a time */
+    if (ctx->page > 0) {
+        if (lib.TIFFLastDirectory(ctx->tiff)) {
+            decoder->status = IMG_DECODER_STATUS_COMPLETE;
+            return false;
+        }
+        if (!lib.TIFFReadDirectory(ctx->tiff)) {
+            return SDL_SetError("Couldn't read TIFF page %d", ctx->page);
+        }
+    }
+
+    *frame = TIF_LoadPage(ctx->tiff, decoder->src, decoder->start, ctx->max_threads);
+    if (!*frame) {
+        return false;
+    }
+    ++ctx->page;
+
+    /* Pages don't have any timing */
+    *duration = 0;
+    return true;
+}
+
+static bool IMG_AnimationDecoderClose_Internal(IMG_AnimationDecoder *decoder)
+{
+    IMG_AnimationDecoderContext *ctx = decoder->ctx;
+
+    if (ctx->tiff) {
+        lib.TIFFClose(ctx->tiff);
+    }
+    SDL_free(ctx);
+    decoder->ctx = NULL;
+
+    return true;
+}
+
+bool IMG_CreateTIFAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_PropertiesID props)
+{
+    IMG_AnimationDecoderContext *ctx;
+    SDL_PropertiesID io_props;
+
+    if (!IMG_InitTIF()) {
+        return false;
+    }
+
+    ctx = (IMG_AnimationDecoderContext *)SDL_calloc(1, sizeof(*ctx));
+    if (!ctx) {
+        return false;
+    }
+    decoder->ctx = ctx;
+
+    ctx->tiff = TIF_Open(decoder->src);
+    if (!ctx->tiff) {
+        SDL_SetError("Couldn't open TIFF image");
+        goto error;
+    }
+
+    /* Decoding a page on several threads needs the whole file in memory, so only do that for memory streams */
+    io_props = SDL_GetIOProperties(decoder->src);
+    if (SDL_GetPointerProperty(io_props, SDL_PROP_IOSTREAM_MEMORY_POINTER, NULL)) {
+        ctx->max_threads = TIF_GetMaxThreads(props, IMG_PROP_ANIMATION_DECODER_CREATE_TIF_MAX_THREADS_NUMBER);
+    } else {
+        ctx->max_threads = 1;
+    }
+
+    decoder->Reset = IMG_AnimationDecoderReset_Internal;
+    decoder->GetNextFrame = IMG_AnimationDecoderGetNextFrame_Internal;
+    decoder->Close = IMG_AnimationDecoderClose_Internal;
+    return true;
+
+error:
+    IMG_AnimationDecoderClose_Internal(decoder);
+    return false;
+}
+
 #else
 
 /* See if an image is contained in a data source */
@@ -272,6 +743,63 @@ SDL_Surface *IMG_LoadTIF_IO(SDL_IOStream *src)
     return NULL;
 }
 
+SDL_Surface *IMG_LoadTIFWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    SDL_SetError("SDL_image built without TIFF support");
+    return NULL;
+}
+
+SDL_Surface *IMG_LoadTIFPage_IO(SDL_IOStream *src, int page)
+{
+    SDL_SetError("SDL_image built without TIFF support");
+    return NULL;
+}
+
+int IMG_GetTIFPageCount_IO(SDL_IOStream *src)
+{
+    SDL_SetError("SDL_image built without TIFF support");
+    return 0;
+}
+
+bool IMG_CreateTIFAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_PropertiesID props)
+{
+    return SDL_SetError("SDL_image built without TIFF support");
+}
+
 #endif /* LOAD_TIF */
 
+#else
+
+#include "IMG.h"
+
+/* The platform backend loads TIFF images without any options */
+SDL_Surface *IMG_LoadTIFWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    return IMG_LoadTIF_IO(src);
+}
+
+/* Only the first page is available through the platform backend */
+SDL_Surface *IMG_LoadTIFPage_IO(SDL_IOStream *src, int page)
+{
+    if (page != 0) {
+        SDL_SetError("TIFF pages other than the first aren't supported by this backend");
+        return NULL;
+    }
+    return IMG_LoadTIF_IO(src);
+}
+
+int IMG_GetTIFPageCount_IO(SDL_IOStream *src)
+{
+    if (!IMG_isTIF(src)) {
+        SDL_SetError("Not a TIFF image");
+        return 0;
+    }
+    return 1;
+}
+
+bool IMG_CreateTIFAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_PropertiesID props)
+{
+    return SDL_SetError("TIFF animation decoding isn't supported by this backend");
+}
+
 #endif /* !defined(__APPLE__) || defined(SDL_IMAGE_USE_COMMON_BACKEND) */
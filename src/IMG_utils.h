@@ -21,3 +21,11 @@
 
 extern SDL_Surface *IMG_ApplyOrientation(SDL_Surface *surface, int orientation);
 
+/* These take EXIF orientation values (1-8) and always move the pixels */
+extern SDL_Surface *IMG_OrientSurface(SDL_Surface *surface, int orientation);
+extern void IMG_OrientPixels(Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch,
+                             int w, int h, int y, int rows, int bpp, int orientation);
+extern void IMG_OrientPixelsRect(Uint8 *dst, int dst_pitch, const Uint8 *src, int src_pitch,
+                                 int w, int h, int x, int y, int cols, int rows, int bpp, int orientation);
+extern void IMG_FlipPixels(Uint8 *pixels, int pitch, int w, int h, int bpp, int orientation);
+
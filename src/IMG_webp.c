@@ -97,8 +97,17 @@ static struct
     void *handle_libwebpmux;
 
     VP8StatusCode (*WebPGetFeaturesInternal)(const uint8_t *data, size_t data_size, WebPBitstreamFeatures *features, int decoder_abi_version);
-    uint8_t *(*WebPDecodeRGBInto)(const uint8_t *data, size_t data_size, uint8_t *output_buffer, size_t output_buffer_size, int output_stride);
-    uint8_t *(*WebPDecodeRGBAInto)(const uint8_t *data, size_t data_size, uint8_t *output_buffer, size_t output_buffer_size, int output_stride);
+    int (*WebPInitDecoderConfigInternal)(WebPDecoderConfig *config, int version);
+    VP8StatusCode (*WebPDecode)(const uint8_t *data, size_t data_size, WebPDecoderConfig *config);
+    uint8_t *(*WebPDecodeYUV)(const uint8_t *data, size_t data_size, int *width, int *height, uint8_t **u, uint8_t **v, int *stride, int *uv_stride);
+    uint8_t *(*WebPDecodeYUVInto)(const uint8_t *data, size_t data_size, uint8_t *luma, size_t luma_size, int luma_stride, uint8_t *u, size_t u_size, int u_stride, uint8_t *v, size_t v_size, int v_stride);
+
+    // Incremental decoding functions
+    WebPIDecoder *(*WebPIDecode)(const uint8_t *data, size_t data_size, WebPDecoderConfig *config);
+    VP8StatusCode (*WebPIAppend)(WebPIDecoder *idec, const uint8_t *data, size_t data_size);
+    uint8_t *(*WebPIDecGetRGB)(const WebPIDecoder *idec, int *last_y, int *width, int *height, int *stride);
+    void (*WebPIDelete)(WebPIDecoder *idec);
+
     WebPDemuxer *(*WebPDemuxInternal)(const WebPData *data, int allow_partial, WebPDemuxState *state, int version);
     int (*WebPDemuxGetFrame)(const WebPDemuxer *dmux, int frame_number, WebPIterator *iter);
     int (*WebPDemuxNextFrame)(WebPIterator *iter);
@@ -200,8 +209,16 @@ static bool IMG_InitWEBP(void)
         }
 #endif
         FUNCTION_LOADER_LIBWEBP(WebPGetFeaturesInternal, VP8StatusCode(*)(const uint8_t *data, size_t data_size, WebPBitstreamFeatures *features, int decoder_abi_version))
-        FUNCTION_LOADER_LIBWEBP(WebPDecodeRGBInto, uint8_t *(*)(const uint8_t *data, size_t data_size, uint8_t *output_buffer, size_t output_buffer_size, int output_stride))
-        FUNCTION_LOADER_LIBWEBP(WebPDecodeRGBAInto, uint8_t *(*)(const uint8_t *data, size_t data_size, uint8_t *output_buffer, size_t output_buffer_size, int output_stride))
+        FUNCTION_LOADER_LIBWEBP(WebPInitDecoderConfigInternal, int (*)(WebPDecoderConfig *config, int version))
+        FUNCTION_LOADER_LIBWEBP(WebPDecode, VP8StatusCode (*)(const uint8_t *data, size_t data_size, WebPDecoderConfig *config))
+        FUNCTION_LOADER_LIBWEBP(WebPDecodeYUV, uint8_t *(*)(const uint8_t *data, size_t data_size, int *width, int *height, uint8_t **u, uint8_t **v, int *stride, int *uv_stride))
+        FUNCTION_LOADER_LIBWEBP(WebPDecodeYUVInto, uint8_t *(*)(const uint8_t *data, size_t data_size, uint8_t *luma, size_t luma_size, int luma_stride, uint8_t *u, size_t u_size, int u_stride, uint8_t *v, size_t v_size, int v_stride))
+
+        // Incremental decoding functions
+        FUNCTION_LOADER_LIBWEBP(WebPIDecode, WebPIDecoder *(*)(const uint8_t *data, size_t data_size, WebPDecoderConfig *config))
+        FUNCTION_LOADER_LIBWEBP(WebPIAppend, VP8StatusCode (*)(WebPIDecoder *idec, const uint8_t *data, size_t data_size))
+        FUNCTION_LOADER_LIBWEBP(WebPIDecGetRGB, uint8_t *(*)(const WebPIDecoder *idec, int *last_y, int *width, int *height, int *stride))
+        FUNCTION_LOADER_LIBWEBP(WebPIDelete, void (*)(WebPIDecoder *idec))
         FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxInternal, WebPDemuxer * (*)(const WebPData *, int, WebPDemuxState *, int))
         FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxGetFrame, int (*)(const WebPDemuxer *dmux, int frame_number, WebPIterator *iter))
         FUNCTION_LOADER_LIBWEBPDEMUX(WebPDemuxNextFrame, int (*)(WebPIterator *iter))
@@ -265,7 +282,7 @@ void IMG_QuitWEBP(void)
 
 static bool webp_getinfo(SDL_IOStream *src, size_t *datasize)
 {
-    Sint64 start, size;
+    Sint64 start;
     bool is_WEBP;
     Uint8 magic[20];
 
@@ -290,12 +307,8 @@ static bool webp_getinfo(SDL_IOStream *src, size_t *datasize)
             (magic[15] == ' ' || magic[15] == 'X' || magic[15] == 'L')) {
             is_WEBP = true;
             if (datasize) {
-                size = SDL_GetIOSize(src);
-                if (size > 0) {
-                    *datasize = (size_t)(size - start);
-                } else {
-                    *datasize = 0;
-                }
+                /* The RIFF header and its payload, so nothing after the image is read */
+                *datasize = ((size_t)magic[4] | ((size_t)magic[5] << 8) | ((size_t)magic[6] << 16) | ((size_t)magic[7] << 24)) + 8;
             }
         }
     }
@@ -309,16 +322,312 @@ bool IMG_isWEBP(SDL_IOStream *src)
     return webp_getinfo(src, NULL);
 }
 
-SDL_Surface *IMG_LoadWEBP_IO(SDL_IOStream *src)
+/* Decode lossy WebP straight into the planes of a 4:2:0 YUV surface */
+static bool WEBP_DecodeYUV420(const uint8_t *data, size_t data_size, SDL_Surface *surface)
+{
+    if (surface->format == SDL_PIXELFORMAT_IYUV || surface->format == SDL_PIXELFORMAT_YV12) {
+        const int chroma_pitch = (surface->pitch + 1) / 2;
+        const size_t chroma_size = (size_t)chroma_pitch * ((surface->h + 1) / 2);
+        uint8_t *y = (uint8_t *)surface->pixels;
+        uint8_t *u = y + (size_t)surface->pitch * surface->h;
+        uint8_t *v = u + chroma_size;
+
+        if (surface->format == SDL_PIXELFORMAT_YV12) {
+            uint8_t *tmp = u;
+            u = v;
+            v = tmp;
+        }
+        return lib.WebPDecodeYUVInto(data, data_size,
+                                     y, (size_t)surface->pitch * surface->h, surface->pitch,
+                                     u, chroma_size, chroma_pitch,
+                                     v, chroma_size, chroma_pitch) != NULL;
+    } else {
+        int w, h, stride, uv_stride;
+        uint8_t *u, *v;
+        uint8_t *y = lib.WebPDecodeYUV(data, data_size, &w, &h, &u, &v, &stride, &uv_stride);
+        if (!y) {
+            return false;
+        }
+        IMG_CopyYUV420ToSurface(surface, 0, surface->h, y, stride, u, uv_stride, v, uv_stride, 1);
+        lib.WebPFree(y);
+        return true;
+    }
+}
+
+/* Fit an image into width x height, keeping its aspect ratio */
+static void WEBP_GetScaledSize(int w, int h, int width, int height, int *scaled_w, int *scaled_h)
+{
+    if (width > 0 && height > 0) {
+        if ((Sint64)width * h <= (Sint64)height * w) {
+            height = 0;
+        } else {
+            width = 0;
+        }
+    }
+
+    if (width > 0) {
+        *scaled_w = width;
+        *scaled_h = (int)SDL_max(((Sint64)h * width + w / 2) / w, 1);
+    } else if (height > 0) {
+        *scaled_w = (int)SDL_max(((Sint64)w * height + h / 2) / h, 1);
+        *scaled_h = height;
+    } else {
+        *scaled_w = w;
+        *scaled_h = h;
+    }
+}
+
+/* Get the area of the image to decode and the size it should be decoded at */
+static bool WEBP_GetDecodeArea(int image_width, int image_height, const SDL_Rect *crop, int width, int height, SDL_Rect *area, int *scaled_w, int *scaled_h)
+{
+    area->x = 0;
+    area->y = 0;
+    area->w = image_width;
+    area->h = image_height;
+
+    if (crop->w > 0 && crop->h > 0) {
+        SDL_Rect image_rect = *area;
+        if (!SDL_GetRectIntersection(crop, &image_rect, area)) {
+            return SDL_SetError("The crop rectangle is outside the image");
+        }
+
+        /* libwebp rounds the crop origin down to even coordinates to stay on the
+         * chroma grid (older versions also do this for lossless images), so move
+         * it there ourselves and grow the area to still cover the requested part.
+         * Animation frame offsets are always even, so this holds for frames too.
+         */
+        area->w += (area->x & 1);
+        area->x &= ~1;
+        area->h += (area->y & 1);
+        area->y &= ~1;
+    }
+    WEBP_GetScaledSize(area->w, area->h, width, height, scaled_w, scaled_h);
+    return true;
+}
+
+/* Crop and scale while decoding and write to the pixels of an RGB(A) surface */
+static void WEBP_SetupDecoderConfig(WebPDecoderConfig *config, int image_width, int image_height, const SDL_Rect *area, SDL_Surface *surface)
+{
+    WebPDecoderOptions *options = &config->options;
+    WebPRGBABuffer *buffer = &config->output.u.RGBA;
+
+    if (area->x != 0 || area->y != 0 || area->w != image_width || area->h != image_height) {
+        options->use_cropping = 1;
+        options->crop_left = area->x;
+        options->crop_top = area->y;
+        options->crop_width = area->w;
+        options->crop_height = area->h;
+    }
+    if (surface->w != area->w || surface->h != area->h) {
+        options->use_scaling = 1;
+        options->scaled_width = surface->w;
+        options->scaled_height = surface->h;
+    }
+
+    config->output.colorspace = (surface->format == SDL_PIXELFORMAT_RGB24) ? MODE_RGB : MODE_RGBA;
+    config->output.is_external_memory = 1;
+    buffer->rgba = (uint8_t *)surface->pixels;
+    buffer->stride = surface->pitch;
+    buffer->size = (size_t)surface->pitch * surface->h;
+}
+
+/* Only this much of the stream is staged to read the image features */
+#define WEBP_HEADER_SIZE        64
+#define WEBP_STREAM_CHUNK_SIZE  (64 * 1024)
+
+struct IMG_WEBPDecoder
+{
+    WebPIDecoder *idec;
+    WebPDecoderConfig config;
+    SDL_Rect crop;
+    int width;
+    int height;
+    SDL_Surface *surface;
+    uint8_t header[WEBP_HEADER_SIZE];
+    size_t header_size;
+    bool complete;
+};
+
+IMG_WEBPDecoder *IMG_CreateWEBPDecoder(void)
+{
+    if (!IMG_InitWEBP()) {
+        return NULL;
+    }
+    return (IMG_WEBPDecoder *)SDL_calloc(1, sizeof(IMG_WEBPDecoder));
+}
+
+/* Create the output surface and let libwebp decode rows directly into it */
+static bool WEBP_StartDecoder(IMG_WEBPDecoder *decoder, const WebPBitstreamFeatures *features)
+{
+    SDL_Rect area;
+    int w, h;
+
+    if (features->has_animation) {
+        return SDL_SetError("Animated WEBP images can't be decoded incrementally");
+    }
+
+    if (!lib.WebPInitDecoderConfigInternal(&decoder->config, WEBP_DECODER_ABI_VERSION)) {
+        return SDL_SetError("Incompatible WEBP library version");
+    }
+
+    if (!WEBP_GetDecodeArea(features->width, features->height, &decoder->crop, decoder->width, decoder->height, &area, &w, &h)) {
+        return false;
+    }
+
+    decoder->surface = SDL_CreateSurface(w, h, features->has_alpha ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_RGB24);
+    if (!decoder->surface) {
+        return false;
+    }
+    WEBP_SetupDecoderConfig(&decoder->config, features->width, features->height, &area, decoder->surface);
+
+    /* The configuration is kept in the decoder, libwebp refers to it while decoding */
+    decoder->idec = lib.WebPIDecode(NULL, 0, &decoder->config);
+    if (!decoder->idec) {
+        SDL_DestroySurface(decoder->surface);
+        decoder->surface = NULL;
+        return SDL_SetError("Failed to create WEBP decoder");
+    }
+    return true;
+}
+
+static bool WEBP_AppendDecoderData(IMG_WEBPDecoder *decoder, const uint8_t *data, size_t size)
+{
+    VP8StatusCode status = lib.WebPIAppend(decoder->idec, data, size);
+
+    if (status == VP8_STATUS_OK) {
+        decoder->complete = true;
+    } else if (status != VP8_STATUS_SUSPENDED) {
+        return SDL_SetError("Failed to decode WEBP");
+    }
+    return true;
+}
+
+bool IMG_AppendWEBPDecoderData(IMG_WEBPDecoder *decoder, const void *data, size_t size)
+{
+    const uint8_t *bytes = (const uint8_t *)data;
+
+    if (!decoder) {
+        return SDL_InvalidParamError("decoder");
+    }
+    if (!data && size > 0) {
+        return SDL_InvalidParamError("data");
+    }
+    if (decoder->complete || size == 0) {
+        return true;
+    }
+
+    if (!decoder->idec) {
+        WebPBitstreamFeatures features;
+        VP8StatusCode status;
+        size_t used = SDL_min(size, sizeof(decoder->header) - decoder->header_size);
+
+        SDL_memcpy(&decoder->header[decoder->header_size], bytes, used);
+        decoder->header_size += used;
+        bytes += used;
+        size -= used;
+
+        status = lib.WebPGetFeaturesInternal(decoder->header, decoder->header_size, &features, WEBP_DECODER_ABI_VERSION);
+        if (status == VP8_STATUS_NOT_ENOUGH_DATA && decoder->header_size < sizeof(decoder->header)) {
+            return true;
+        }
+        if (status != VP8_STATUS_OK) {
+            return SDL_SetError("Invalid WEBP");
+        }
+        if (!WEBP_StartDecoder(decoder, &features) ||
+            !WEBP_AppendDecoderData(decoder, decoder->header, decoder->header_size)) {
+            return false;
+        }
+    }
+
+    if (size > 0 && !decoder->complete) {
+        return WEBP_AppendDecoderData(decoder, bytes, size);
+    }
+    return true;
+}
+
+SDL_Surface *IMG_GetWEBPDecoderSurface(IMG_WEBPDecoder *decoder, int *rows)
+{
+    int last_y = 0;
+
+    if (rows) {
+        *rows = 0;
+    }
+    if (!decoder) {
+        SDL_InvalidParamError("decoder");
+        return NULL;
+    }
+    if (!decoder->surface) {
+        SDL_SetError("The WEBP header hasn't been received yet");
+        return NULL;
+    }
+
+    if (decoder->complete) {
+        last_y = decoder->surface->h;
+    } else {
+        lib.WebPIDecGetRGB(decoder->idec, &last_y, NULL, NULL, NULL);
+    }
+    if (rows) {
+        *rows = last_y;
+    }
+    return decoder->surface;
+}
+
+void IMG_DestroyWEBPDecoder(IMG_WEBPDecoder *decoder)
+{
+    if (!decoder) {
+        return;
+    }
+    if (decoder->idec) {
+        lib.WebPIDelete(decoder->idec);
+    }
+    SDL_DestroySurface(decoder->surface);
+    SDL_free(decoder);
+}
+
+/* Get the first frame of an animated WEBP image, cropped and scaled like the still images */
+static SDL_Surface *WEBP_LoadFirstFrame(SDL_IOStream *src, const SDL_Rect *crop, int width, int height)
+{
+    SDL_PropertiesID props;
+    IMG_AnimationDecoder *decoder;
+    SDL_Surface *frame = NULL;
+
+    props = SDL_CreateProperties();
+    if (!props) {
+        return NULL;
+    }
+    SDL_SetPointerProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_IOSTREAM_POINTER, src);
+    SDL_SetStringProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_TYPE_STRING, "webp");
+    SDL_SetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_WIDTH_NUMBER, width);
+    SDL_SetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_HEIGHT_NUMBER, height);
+    SDL_SetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_CROP_X_NUMBER, crop->x);
+    SDL_SetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_CROP_Y_NUMBER, crop->y);
+    SDL_SetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_CROP_WIDTH_NUMBER, crop->w);
+    SDL_SetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_CROP_HEIGHT_NUMBER, crop->h);
+    decoder = IMG_CreateAnimationDecoderWithProperties(props);
+    SDL_DestroyProperties(props);
+
+    if (decoder) {
+        IMG_GetAnimationDecoderFrame(decoder, &frame, NULL);
+        IMG_CloseAnimationDecoder(decoder);
+    }
+    return frame;
+}
+
+SDL_Surface *IMG_LoadWEBPWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
 {
     Sint64 start;
     const char *error = NULL;
     SDL_Surface *surface = NULL;
     Uint32 format;
     WebPBitstreamFeatures features;
+    uint8_t header[WEBP_HEADER_SIZE];
+    size_t header_size;
     size_t raw_data_size;
+    size_t remaining;
     uint8_t *raw_data = NULL;
-    uint8_t *ret;
+    IMG_WEBPDecoder *decoder = NULL;
+    SDL_Rect crop;
+    int width, height;
 
     if (!src) {
         /* The error message has been set in SDL_IOFromFile */
@@ -327,6 +636,13 @@ SDL_Surface *IMG_LoadWEBP_IO(SDL_IOStream *src)
 
     start = SDL_TellIO(src);
 
+    crop.x = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_CROP_X_NUMBER, 0);
+    crop.y = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_CROP_Y_NUMBER, 0);
+    crop.w = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_CROP_WIDTH_NUMBER, 0);
+    crop.h = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_CROP_HEIGHT_NUMBER, 0);
+    width = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_WIDTH_NUMBER, 0);
+    height = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_HEIGHT_NUMBER, 0);
+
     if (!IMG_InitWEBP()) {
         goto error;
     }
@@ -337,27 +653,9 @@ SDL_Surface *IMG_LoadWEBP_IO(SDL_IOStream *src)
         goto error;
     }
 
-    raw_data = (uint8_t *)SDL_malloc(raw_data_size);
-    if (raw_data == NULL) {
-        error = "Failed to allocate enough buffer for WEBP";
-        goto error;
-    }
-
-    if (SDL_ReadIO(src, raw_data, raw_data_size) != raw_data_size) {
-        error = "Failed to read WEBP";
-        goto error;
-    }
-
-#if 0
-    {/* extract size of picture, not interesting since we don't know about alpha channel */
-      int width = -1, height = -1;
-      if (!WebPGetInfo(raw_data, raw_data_size, &width, &height)) {
-          printf("WebPGetInfo has failed\n");
-          return NULL;
-    } }
-#endif
-
-    if (lib.WebPGetFeaturesInternal(raw_data, raw_data_size, &features, WEBP_DECODER_ABI_VERSION) != VP8_STATUS_OK) {
+    /* The header is enough to decide how to decode the image */
+    header_size = SDL_ReadIO(src, header, SDL_min(sizeof(header), raw_data_size));
+    if (lib.WebPGetFeaturesInternal(header, header_size, &features, WEBP_DECODER_ABI_VERSION) != VP8_STATUS_OK) {
         error = "WebPGetFeatures has failed";
         goto error;
     }
@@ -368,55 +666,103 @@ SDL_Surface *IMG_LoadWEBP_IO(SDL_IOStream *src)
             error = "Failed to seek IO to read animated WebP";
             goto error;
         } else {
-            IMG_Animation *animation = IMG_DecodeAsAnimation(src, "webp", 1);
-            if (animation && animation->count > 0) {
-                SDL_Surface *surf = animation->frames[0];
-                if (surf) {
-                    ++surf->refcount;
-                    if (raw_data) {
-                        SDL_free(raw_data);
-                    }
-                    IMG_FreeAnimation(animation);
-                    return surf;
-                } else {
-                    error = "Failed to load first frame of animated WebP";
-                    IMG_FreeAnimation(animation);
-                    goto error;
-                }
-            } else {
-                IMG_FreeAnimation(animation);
-                error = "Received an animated WebP but the animation data was invalid";
-                goto error;
+            surface = WEBP_LoadFirstFrame(src, &crop, width, height);
+            if (surface) {
+                return surface;
             }
+            error = "Failed to load first frame of animated WebP";
+            goto error;
         }
     }
 
-    if (features.has_alpha) {
-        format = SDL_PIXELFORMAT_RGBA32;
-    } else {
-        format = SDL_PIXELFORMAT_RGB24;
+    format = (Uint32)SDL_GetNumberProperty(props, IMG_PROP_LOAD_PIXEL_FORMAT_NUMBER, SDL_PIXELFORMAT_UNKNOWN);
+    if (IMG_IsYUV420Format(format) && !features.has_alpha &&
+        (crop.w <= 0 || crop.h <= 0) && width <= 0 && height <= 0) {
+        /* The YUV decoding API needs the whole file in memory */
+        raw_data = (uint8_t *)SDL_malloc(raw_data_size);
+        if (raw_data == NULL) {
+            error = "Failed to allocate enough buffer for WEBP";
+            goto error;
+        }
+        SDL_memcpy(raw_data, header, header_size);
+        if (SDL_ReadIO(src, raw_data + header_size, raw_data_size - header_size) != raw_data_size - header_size) {
+            error = "Failed to read WEBP";
+            goto error;
+        }
+
+        /* Extended files only report the bitstream format with all the data */
+        if (lib.WebPGetFeaturesInternal(raw_data, raw_data_size, &features, WEBP_DECODER_ABI_VERSION) != VP8_STATUS_OK) {
+            error = "WebPGetFeatures has failed";
+            goto error;
+        }
+
+        if (features.format == 1 /* lossy */) {
+            surface = SDL_CreateSurface(features.width, features.height, format);
+            if (surface == NULL) {
+                error = "Failed to allocate SDL_Surface";
+                goto error;
+            }
+            /* VP8 uses studio swing BT.601 */
+            SDL_SetSurfaceColorspace(surface, SDL_COLORSPACE_BT601_LIMITED);
+
+            if (!WEBP_DecodeYUV420(raw_data, raw_data_size, surface)) {
+                error = "Failed to decode WEBP";
+                goto error;
+            }
+            SDL_free(raw_data);
+            return surface;
+        }
     }
 
-    surface = SDL_CreateSurface(features.width, features.height, format);
-    if (surface == NULL) {
-        error = "Failed to allocate SDL_Surface";
+    decoder = IMG_CreateWEBPDecoder();
+    if (!decoder) {
         goto error;
     }
+    decoder->crop = crop;
+    decoder->width = width;
+    decoder->height = height;
 
-    if (features.has_alpha) {
-        ret = lib.WebPDecodeRGBAInto(raw_data, raw_data_size, (uint8_t *)surface->pixels, surface->pitch * surface->h, surface->pitch);
+    if (raw_data) {
+        if (!IMG_AppendWEBPDecoderData(decoder, raw_data, raw_data_size)) {
+            goto error;
+        }
     } else {
-        ret = lib.WebPDecodeRGBInto(raw_data, raw_data_size, (uint8_t *)surface->pixels, surface->pitch * surface->h, surface->pitch);
+        /* Decode while reading instead of staging the whole file */
+        raw_data = (uint8_t *)SDL_malloc(WEBP_STREAM_CHUNK_SIZE);
+        if (raw_data == NULL) {
+            goto error;
+        }
+        if (!IMG_AppendWEBPDecoderData(decoder, header, header_size)) {
+            goto error;
+        }
+        remaining = raw_data_size - header_size;
+        while (!decoder->complete && remaining > 0) {
+            size_t amount = SDL_ReadIO(src, raw_data, SDL_min(remaining, WEBP_STREAM_CHUNK_SIZE));
+            if (amount == 0) {
+                break;
+            }
+            remaining -= amount;
+            if (!IMG_AppendWEBPDecoderData(decoder, raw_data, amount)) {
+                goto error;
+            }
+        }
+
+        /* Skip any chunks after the image data, leaving the stream after the image */
+        if (decoder->complete && remaining > 0 && SDL_SeekIO(src, (Sint64)remaining, SDL_IO_SEEK_CUR) < 0) {
+            error = "Failed to read WEBP";
+            goto error;
+        }
     }
 
-    if (!ret) {
+    if (!decoder->complete) {
         error = "Failed to decode WEBP";
         goto error;
     }
 
-    if (raw_data) {
-        SDL_free(raw_data);
-    }
+    surface = decoder->surface;
+    decoder->surface = NULL;
+    IMG_DestroyWEBPDecoder(decoder);
+    SDL_free(raw_data);
 
     return surface;
 
@@ -425,6 +771,10 @@ error:
         SDL_free(raw_data);
     }
 
+    if (decoder) {
+        IMG_DestroyWEBPDecoder(decoder);
+    }
+
     if (surface) {
         SDL_DestroySurface(surface);
     }
@@ -437,6 +787,11 @@ error:
     return NULL;
 }
 
+SDL_Surface *IMG_LoadWEBP_IO(SDL_IOStream *src)
+{
+    return IMG_LoadWEBPWithProperties(src, 0);
+}
+
 struct IMG_AnimationDecoderContext
 {
     WebPDemuxer *demuxer;
@@ -448,9 +803,33 @@ struct IMG_AnimationDecoderContext
     size_t raw_data_size;
     WebPDemuxState demux_state;
     SDL_Rect last_rect;
+    SDL_Rect crop;
     bool has_alpha;
 };
 
+/* Map a rectangle of the animation canvas to the cropped and scaled output */
+static void WEBP_MapCanvasRect(const IMG_AnimationDecoderContext *ctx, const SDL_Rect *rect, SDL_Rect *area, SDL_Rect *dst)
+{
+    const SDL_Rect *crop = &ctx->crop;
+    int x0, y0, x1, y1;
+
+    if (!SDL_GetRectIntersection(rect, crop, area)) {
+        SDL_zerop(area);
+        SDL_zerop(dst);
+        return;
+    }
+
+    /* Both edges are rounded the same way so neighboring frames don't leave gaps */
+    x0 = (int)((Sint64)(area->x - crop->x) * ctx->canvas->w / crop->w);
+    y0 = (int)((Sint64)(area->y - crop->y) * ctx->canvas->h / crop->h);
+    x1 = (int)((Sint64)(area->x + area->w - crop->x) * ctx->canvas->w / crop->w);
+    y1 = (int)((Sint64)(area->y + area->h - crop->y) * ctx->canvas->h / crop->h);
+    dst->x = x0;
+    dst->y = y0;
+    dst->w = x1 - x0;
+    dst->h = y1 - y0;
+}
+
 static bool IMG_AnimationDecoderReset_Internal(IMG_AnimationDecoder *decoder)
 {
     lib.WebPDemuxReleaseIterator(&decoder->ctx->iter);
@@ -496,50 +875,68 @@ static bool IMG_AnimationDecoderGetNextFrame_Internal(IMG_AnimationDecoder *deco
     bool has_alpha = decoder->ctx->has_alpha;
     SDL_Rect last_rect = decoder->ctx->last_rect;
 
-    SDL_Surface *curr = SDL_CreateSurface(iter->width, iter->height, SDL_PIXELFORMAT_RGBA32);
-    if (!curr) {
-        return false;
-    }
+    SDL_Surface *curr = NULL;
+    SDL_Rect frame_rect = { iter->x_offset, iter->y_offset, iter->width, iter->height };
+    SDL_Rect area, dst;
 
-    if (!lib.WebPDecodeRGBAInto(iter->fragment.bytes, iter->fragment.size,
-                                (uint8_t *)curr->pixels, curr->pitch * curr->h, curr->pitch)) {
-        SDL_DestroySurface(curr);
-        return SDL_SetError("Failed to decode frame");
+    /* Only decode the part of the frame that's visible in the output, at the output scale */
+    WEBP_MapCanvasRect(decoder->ctx, &frame_rect, &area, &dst);
+    if (!SDL_RectEmpty(&dst)) {
+        WebPDecoderConfig config;
+
+        curr = SDL_CreateSurface(dst.w, dst.h, SDL_PIXELFORMAT_RGBA32);
+        if (!curr) {
+            return false;
+        }
+
+        if (!lib.WebPInitDecoderConfigInternal(&config, WEBP_DECODER_ABI_VERSION)) {
+            SDL_DestroySurface(curr);
+            return SDL_SetError("Incompatible WEBP library version");
+        }
+        area.x -= iter->x_offset;
+        area.y -= iter->y_offset;
+        WEBP_SetupDecoderConfig(&config, iter->width, iter->height, &area, curr);
+
+        if (lib.WebPDecode(iter->fragment.bytes, iter->fragment.size, &config) != VP8_STATUS_OK) {
+            SDL_DestroySurface(curr);
+            return SDL_SetError("Failed to decode frame");
+        }
     }
 
-    SDL_Rect dst = { iter->x_offset, iter->y_offset, iter->width, iter->height };
     /* Correctly handle both Disposal and Blend modes to prevent ghosting */
     if (dispose_method == WEBP_MUX_DISPOSE_BACKGROUND || iter->blend_method == WEBP_MUX_NO_BLEND) {
         /* For alpha WebPs, we clear to transparency regardless of bad bgcolor metadata */
         uint32_t fill_color = has_alpha ? SDL_MapSurfaceRGBA(canvas, 0, 0, 0, 0) : bgcolor;
 
         /* If it's a disposal, clear the previous area; if it's NO_BLEND, clear the current area */
-        if (dispose_method == WEBP_MUX_DISPOSE_BACKGROUND) {
+        if (dispose_method == WEBP_MUX_DISPOSE_BACKGROUND && !SDL_RectEmpty(&last_rect)) {
             SDL_FillSurfaceRect(canvas, &last_rect, fill_color);
         }
 
-        if (iter->blend_method == WEBP_MUX_NO_BLEND) {
+        if (iter->blend_method == WEBP_MUX_NO_BLEND && curr) {
             SDL_FillSurfaceRect(canvas, &dst, fill_color);
         }
     }
 
-    if (iter->blend_method == WEBP_MUX_BLEND) {
-        if (!SDL_SetSurfaceBlendMode(curr, SDL_BLENDMODE_BLEND)) {
-            SDL_DestroySurface(curr);
-            return false;
+    if (curr) {
+        if (iter->blend_method == WEBP_MUX_BLEND) {
+            if (!SDL_SetSurfaceBlendMode(curr, SDL_BLENDMODE_BLEND)) {
+                SDL_DestroySurface(curr);
+                return false;
+            }
+        } else {
+            if (!SDL_SetSurfaceBlendMode(curr, SDL_BLENDMODE_NONE)) {
+                SDL_DestroySurface(curr);
+                return false;
+            }
         }
-    } else {
-        if (!SDL_SetSurfaceBlendMode(curr, SDL_BLENDMODE_NONE)) {
+
+        if (!SDL_BlitSurface(curr, NULL, canvas, &dst)) {
             SDL_DestroySurface(curr);
             return false;
         }
-    }
-
-    if (!SDL_BlitSurface(curr, NULL, canvas, &dst)) {
         SDL_DestroySurface(curr);
-        return false;
     }
-    SDL_DestroySurface(curr);
 
     retval = SDL_DuplicateSurface(canvas);
     if (!retval) {
@@ -666,7 +1063,21 @@ bool IMG_CreateWEBPAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_Propertie
     bool has_alpha = (flags & 0x10) != 0;
     decoder->ctx->has_alpha = has_alpha;
 
-    decoder->ctx->canvas = SDL_CreateSurface(width, height, has_alpha ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_RGBX32);
+    SDL_Rect crop;
+    int scaled_w, scaled_h;
+    crop.x = (int)SDL_GetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_CROP_X_NUMBER, 0);
+    crop.y = (int)SDL_GetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_CROP_Y_NUMBER, 0);
+    crop.w = (int)SDL_GetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_CROP_WIDTH_NUMBER, 0);
+    crop.h = (int)SDL_GetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_CROP_HEIGHT_NUMBER, 0);
+    if (!WEBP_GetDecodeArea((int)width, (int)height, &crop,
+                            (int)SDL_GetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_WIDTH_NUMBER, 0),
+                            (int)SDL_GetNumberProperty(props, IMG_PROP_ANIMATION_DECODER_CREATE_HEIGHT_NUMBER, 0),
+                            &decoder->ctx->crop, &scaled_w, &scaled_h)) {
+        IMG_AnimationDecoderClose_Internal(decoder);
+        return false;
+    }
+
+    decoder->ctx->canvas = SDL_CreateSurface(scaled_w, scaled_h, has_alpha ? SDL_PIXELFORMAT_RGBA32 : SDL_PIXELFORMAT_RGBX32);
     if (!decoder->ctx->canvas) {
         IMG_AnimationDecoderClose_Internal(decoder);
         return false;
@@ -696,8 +1107,8 @@ bool IMG_CreateWEBPAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_Propertie
     decoder->ctx->dispose_method = WEBP_MUX_DISPOSE_BACKGROUND;
     decoder->ctx->last_rect.x = 0;
     decoder->ctx->last_rect.y = 0;
-    decoder->ctx->last_rect.w = width;
-    decoder->ctx->last_rect.h = height;
+    decoder->ctx->last_rect.w = scaled_w;
+    decoder->ctx->last_rect.h = scaled_h;
 
     SDL_zero(decoder->ctx->iter);
 
@@ -1124,6 +1535,36 @@ SDL_Surface *IMG_LoadWEBP_IO(SDL_IOStream *src)
     return NULL;
 }
 
+SDL_Surface *IMG_LoadWEBPWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    SDL_SetError("SDL_image built without WEBP support");
+    return NULL;
+}
+
+IMG_WEBPDecoder *IMG_CreateWEBPDecoder(void)
+{
+    SDL_SetError("SDL_image built without WEBP support");
+    return NULL;
+}
+
+bool IMG_AppendWEBPDecoderData(IMG_WEBPDecoder *decoder, const void *data, size_t size)
+{
+    return SDL_SetError("SDL_image built without WEBP support");
+}
+
+SDL_Surface *IMG_GetWEBPDecoderSurface(IMG_WEBPDecoder *decoder, int *rows)
+{
+    if (rows) {
+        *rows = 0;
+    }
+    SDL_SetError("SDL_image built without WEBP support");
+    return NULL;
+}
+
+void IMG_DestroyWEBPDecoder(IMG_WEBPDecoder *decoder)
+{
+}
+
 bool IMG_CreateWEBPAnimationDecoder(IMG_AnimationDecoder *decoder, SDL_PropertiesID props)
 {
     return SDL_SetError("SDL_image built without WEBP support");
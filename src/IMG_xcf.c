@@ -23,6 +23,9 @@
 
 #include <SDL3/SDL_endian.h>
 #include <SDL3_image/SDL_image.h>
+#include <SDL3/SDL_intrin.h>
+
+#include "IMG.h"
 
 #ifdef LOAD_XCF
 
@@ -207,9 +210,39 @@ typedef struct {
     Uint64 *tile_file_offsets;
 } xcf_level;
 
-typedef unsigned char *xcf_tile;
+/* Tiles are 64x64 pixels of up to 4 bytes each */
+#define XCF_TILE_SIZE   64
+#define XCF_TILE_BYTES  (XCF_TILE_SIZE * XCF_TILE_SIZE * 4)
+
+/* Smaller layers aren't worth starting threads for */
+#define MIN_XCF_PARALLEL_PIXELS (256 * 1024)
 
-typedef unsigned char *(*load_tile_type)(SDL_IOStream *, size_t, int, int, int);
+/* Returns the decoded tile, either in place or in the buffer, or NULL if the data is bad */
+typedef const Uint8 *(*load_tile_type)(const Uint8 *, size_t, int, int, int, Uint8 *);
+
+typedef void (*blend_func_type)(Uint32 *, const Uint32 *, int);
+
+/* The tiles of one layer, decoded and blended into the image */
+typedef struct {
+    SDL_Surface *surface;
+    const xcf_header *head;
+    const xcf_level *level;
+    const Uint8 *data;
+    size_t size;
+    load_tile_type load_tile;
+    blend_func_type blend;
+    int bpp;
+    Sint64 offset_x;
+    Sint64 offset_y;
+    Uint32 width;
+    Uint32 height;
+    Uint64 max_tile_pixels;
+    int num_offsets;
+    int tiles_across;
+    int num_tiles;
+    SDL_AtomicInt next_tile;
+    SDL_AtomicInt failed;
+} xcf_tile_context;
 
 
 /* See if an image is contained in a data source */
@@ -633,74 +666,52 @@ static xcf_level *read_xcf_level(SDL_IOStream *src, const xcf_header *h)
     return l;
 }
 
-static void free_xcf_tile(unsigned char *t)
-{
-    SDL_free(t);
-}
-
-static unsigned char *load_xcf_tile_none (SDL_IOStream *src, size_t len, int bpp, int x, int y)
+static const Uint8 *load_xcf_tile_none(const Uint8 *src, size_t len, int bpp, int x, int y, Uint8 *buffer)
 {
-    unsigned char *load = NULL;
-
     if (len < (size_t)(x * y * bpp)) {
-        SDL_SetError("Gimp image invalid tile offsets");
         return NULL;
     }
-
-    load = (unsigned char *)SDL_malloc(len);
-    if (load != NULL) {
-        if (SDL_ReadIO(src, load, len) != len) {
-            SDL_free(load);
-            load = NULL;
-        }
-    }
-    return load;
+    return src;
 }
 
-static unsigned char *load_xcf_tile_rle(SDL_IOStream *src, size_t len, int bpp, int x, int y)
+static const Uint8 *load_xcf_tile_rle(const Uint8 *src, size_t len, int bpp, int x, int y, Uint8 *buffer)
 {
-    unsigned char *load, *t, *data, *d;
+    const Uint8 *t, *end;
+    Uint8 *data, *d;
     int i, size, j, length;
     unsigned char val;
-    size_t amount_read;
 
     if (len == 0) {    /* probably bogus data. */
         return NULL;
     }
 
-    t = load = (unsigned char *)SDL_calloc(1, len);
-    if (load == NULL) {
-        return NULL;
-    }
-
-    amount_read = SDL_ReadIO(src, load, len);
-    if (amount_read == 0) {
-        SDL_free(load);
-        return NULL;
-    }
-
-    data = (unsigned char *)SDL_calloc(1, x*y*bpp);
-    if (!data) {
-        SDL_free(load);
-        return NULL;
-    }
+    t = src;
+    end = src + len;
+    data = buffer;
+    SDL_memset(data, 0, x*y*bpp);
     unsigned char *data_end = data + x*y*bpp;
     for (i = 0; i < bpp; i++) {
         d = data + i;
         size = x*y;
 
         while (size > 0) {
+            if (t >= end) {
+                break;    /* bogus data */
+            }
             val = *t++;
 
             length = val;
             if (length >= 128) {
                 length = 255 - (length - 1);
                 if (length == 128) {
+                    if (end - t < 2) {
+                        break;    /* bogus data */
+                    }
                     length = (*t << 8) + t[1];
                     t += 2;
                 }
 
-                if (((size_t)(t - load) + length) >= amount_read) {
+                if (((size_t)(t - src) + length) > len) {
                     break;    /* bogus data */
                 } else if (length > size) {
                     break;    /* bogus data */
@@ -718,11 +729,14 @@ static unsigned char *load_xcf_tile_rle(SDL_IOStream *src, size_t len, int bpp,
             } else {
                 length += 1;
                 if (length == 128) {
+                    if (end - t < 2) {
+                        break;    /* bogus data */
+                    }
                     length = (*t << 8) + t[1];
                     t += 2;
                 }
 
-                if (((size_t)(t - load)) >= amount_read) {
+                if (((size_t)(t - src)) >= len) {
                     break;    /* bogus data */
                 } else if (length > size) {
                     break;    /* bogus data */
@@ -747,11 +761,257 @@ static unsigned char *load_xcf_tile_rle(SDL_IOStream *src, size_t len, int bpp,
         }
 
     }
-    SDL_free(load);
 
     return data;
 }
 
+#ifdef USE_STBIMAGE
+/* GIMP 2.10 and newer compress each tile as a zlib stream by default */
+static const Uint8 *load_xcf_tile_zlib(const Uint8 *src, size_t len, int bpp, int x, int y, Uint8 *buffer)
+{
+    if (!IMG_InflateZlib(src, len, buffer, (size_t)(x * y * bpp))) {
+        return NULL;
+    }
+    return buffer;
+}
+#endif
+
+/* Convert w x h pixels of a decoded tile to ARGB8888 */
+static void convert_xcf_tile(const xcf_header *head, int bpp, const Uint8 *p8, size_t pitch, int w, int h, Uint32 *pixels)
+{
+    const Uint8 *p;
+    Uint32 *row = pixels;
+    int x, y;
+
+    for (y = 0; y < h; y++) {
+        p = p8 + y * pitch;
+        switch (bpp) {
+        case 4:
+            for (x = 0; x < w; x++) {
+                *row++ = ((Uint32)p[3] << 24) |
+                         ((Uint32)p[0] << 16) |
+                         ((Uint32)p[1] << 8) |
+                         ((Uint32)p[2] << 0);
+                p += 4;
+            }
+            break;
+        case 3:
+            for (x = 0; x < w; x++) {
+                *row++ = 0xFF000000 |
+                         ((Uint32)p[0] << 16) |
+                         ((Uint32)p[1] << 8) |
+                         ((Uint32)p[2] << 0);
+                p += 3;
+            }
+            break;
+        case 2:
+            /* Indexed / Greyscale + Alpha */
+            if (head->image_type == IMAGE_INDEXED) {
+                for (x = 0; x < w; x++) {
+                    Uint8 c = *p++;
+                    Uint8 a = *p++;
+                    if (c < head->cm_num) {
+                        *row++ = ((Uint32)(head->cm_map[c * 3]) << 16) |
+                                 ((Uint32)(head->cm_map[c * 3 + 1]) << 8) |
+                                 ((Uint32)(head->cm_map[c * 3 + 2]) << 0) |
+                                 ((Uint32)a << 24);
+                    } else {
+                        *row++ = 0;
+                    }
+                }
+            } else {
+                for (x = 0; x < w; x++) {
+                    Uint8 c = *p++;
+                    Uint8 a = *p++;
+                    *row++ = ((Uint32)c << 16) |
+                             ((Uint32)c << 8) |
+                             ((Uint32)c << 0) |
+                             ((Uint32)a << 24);
+                }
+            }
+            break;
+        case 1:
+            /* Indexed / Greyscale */
+            if (head->image_type == IMAGE_INDEXED) {
+                for (x = 0; x < w; x++) {
+                    Uint8 c = *p++;
+                    if (c < head->cm_num) {
+                        *row++ = 0xFF000000 |
+                                 ((Uint32)(head->cm_map[c * 3]) << 16) |
+                                 ((Uint32)(head->cm_map[c * 3 + 1]) << 8) |
+                                 ((Uint32)(head->cm_map[c * 3 + 2]) << 0);
+                    } else {
+                        *row++ = 0;
+                    }
+                }
+            } else {
+                for (x = 0; x < w; x++) {
+                    Uint8 c = *p++;
+                    *row++ = 0xFF000000 |
+                             (((Uint32)c) << 16) |
+                             (((Uint32)c) << 8) |
+                             (((Uint32)c) << 0);
+                }
+            }
+            break;
+        }
+    }
+}
+
+/* Normal mode layer blending, the same as an SDL_BLENDMODE_BLEND blit:
+ *   dstRGB = srcRGB * srcA + dstRGB * (1 - srcA)
+ *   dstA = srcA + dstA * (1 - srcA)
+ * The alpha works out the same as the colors if the source alpha channel is
+ * taken as 255, so all four channels are x / 255, rounded, with x <= 255 * 255.
+ */
+static void blend_xcf_normal(Uint32 *dst, const Uint32 *src, int count)
+{
+    int i;
+
+    for (i = 0; i < count; i++) {
+        Uint32 s = src[i];
+        Uint32 a = s >> 24;
+
+        if (a == 0xFF) {
+            dst[i] = s;
+        } else if (a) {
+            Uint32 d = dst[i];
+            Uint32 ia = 0xFF - a;
+            Uint32 rb = (s & 0x00FF00FF) * a + (d & 0x00FF00FF) * ia + 0x00800080;
+            Uint32 ag = (((s >> 8) & 0x00FF00FF) | 0x00FF0000) * a + ((d >> 8) & 0x00FF00FF) * ia + 0x00800080;
+
+            rb = ((rb + ((rb >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+            ag = ((ag + ((ag >> 8) & 0x00FF00FF)) >> 8) & 0x00FF00FF;
+            dst[i] = (ag << 8) | rb;
+        }
+    }
+}
+
+#ifdef SDL_SSE2_INTRINSICS
+/* Blend two pixels widened to 16 bits per channel */
+static __m128i SDL_TARGETING("sse2") blend_xcf_normal2_SSE2(__m128i s, __m128i d)
+{
+    const __m128i amask = _mm_set_epi16(255, 0, 0, 0, 255, 0, 0, 0);
+    __m128i a = _mm_shufflehi_epi16(_mm_shufflelo_epi16(s, 0xFF), 0xFF);
+    __m128i x = _mm_add_epi16(_mm_mullo_epi16(_mm_or_si128(s, amask), a),
+                              _mm_mullo_epi16(d, _mm_sub_epi16(_mm_set1_epi16(255), a)));
+
+    x = _mm_add_epi16(x, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(x, _mm_srli_epi16(x, 8)), 8);
+}
+
+static void SDL_TARGETING("sse2") blend_xcf_normal_SSE2(Uint32 *dst, const Uint32 *src, int count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i amask = _mm_set1_epi32((int)0xFF000000);
+    int i;
+
+    for (i = 0; i + 4 <= count; i += 4) {
+        __m128i s = _mm_loadu_si128((const __m128i *)(src + i));
+        __m128i sa = _mm_and_si128(s, amask);
+        __m128i d;
+
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(sa, amask)) == 0xFFFF) {
+            _mm_storeu_si128((__m128i *)(dst + i), s);
+            continue;
+        }
+        if (_mm_movemask_epi8(_mm_cmpeq_epi32(sa, zero)) == 0xFFFF) {
+            continue;
+        }
+        d = _mm_loadu_si128((const __m128i *)(dst + i));
+        _mm_storeu_si128((__m128i *)(dst + i),
+                         _mm_packus_epi16(blend_xcf_normal2_SSE2(_mm_unpacklo_epi8(s, zero), _mm_unpacklo_epi8(d, zero)),
+                                          blend_xcf_normal2_SSE2(_mm_unpackhi_epi8(s, zero), _mm_unpackhi_epi8(d, zero))));
+    }
+    blend_xcf_normal(dst + i, src + i, count - i);
+}
+#endif
+
+#ifdef SDL_AVX2_INTRINSICS
+/* Blend four pixels widened to 16 bits per channel */
+static __m256i SDL_TARGETING("avx2") blend_xcf_normal4_AVX2(__m256i s, __m256i d)
+{
+    const __m256i amask = _mm256_set_epi16(255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0, 255, 0, 0, 0);
+    __m256i a = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(s, 0xFF), 0xFF);
+    __m256i x = _mm256_add_epi16(_mm256_mullo_epi16(_mm256_or_si256(s, amask), a),
+                                 _mm256_mullo_epi16(d, _mm256_sub_epi16(_mm256_set1_epi16(255), a)));
+
+    x = _mm256_add_epi16(x, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(x, _mm256_srli_epi16(x, 8)), 8);
+}
+
+static void SDL_TARGETING("avx2") blend_xcf_normal_AVX2(Uint32 *dst, const Uint32 *src, int count)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i amask = _mm256_set1_epi32((int)0xFF000000);
+    int i;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        __m256i s = _mm256_loadu_si256((const __m256i *)(src + i));
+        __m256i sa = _mm256_and_si256(s, amask);
+        __m256i d;
+
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(sa, amask)) == -1) {
+            _mm256_storeu_si256((__m256i *)(dst + i), s);
+            continue;
+        }
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(sa, zero)) == -1) {
+            continue;
+        }
+        d = _mm256_loadu_si256((const __m256i *)(dst + i));
+        _mm256_storeu_si256((__m256i *)(dst + i),
+                            _mm256_packus_epi16(blend_xcf_normal4_AVX2(_mm256_unpacklo_epi8(s, zero), _mm256_unpacklo_epi8(d, zero)),
+                                                blend_xcf_normal4_AVX2(_mm256_unpackhi_epi8(s, zero), _mm256_unpackhi_epi8(d, zero))));
+    }
+    blend_xcf_normal(dst + i, src + i, count - i);
+}
+#endif
+
+#if defined(SDL_NEON_INTRINSICS) && (SDL_BYTEORDER == SDL_LIL_ENDIAN)
+#define XCF_NEON_BLEND
+/* ARGB8888 pixels are B, G, R, A in memory */
+static void blend_xcf_normal_NEON(Uint32 *dst, const Uint32 *src, int count)
+{
+    int i, c;
+
+    for (i = 0; i + 8 <= count; i += 8) {
+        uint8x8x4_t s = vld4_u8((const uint8_t *)(src + i));
+        uint8x8x4_t d = vld4_u8((const uint8_t *)(dst + i));
+        uint8x8_t a = s.val[3];
+        uint8x8_t ia = vmvn_u8(a);
+
+        s.val[3] = vdup_n_u8(255);
+        for (c = 0; c < 4; c++) {
+            uint16x8_t x = vmlal_u8(vmull_u8(s.val[c], a), d.val[c], ia);
+            d.val[c] = vraddhn_u16(x, vrshrq_n_u16(x, 8));
+        }
+        vst4_u8((uint8_t *)(dst + i), d);
+    }
+    blend_xcf_normal(dst + i, src + i, count - i);
+}
+#endif
+
+static blend_func_type get_xcf_blend_func(void)
+{
+    /* Use the fastest kernels this CPU supports */
+#ifdef SDL_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        return blend_xcf_normal_AVX2;
+    }
+#endif
+#ifdef SDL_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        return blend_xcf_normal_SSE2;
+    }
+#endif
+#ifdef XCF_NEON_BLEND
+    if (SDL_HasNEON()) {
+        return blend_xcf_normal_NEON;
+    }
+#endif
+    return blend_xcf_normal;
+}
+
 static Uint32 rgb2grey(Uint32 a)
 {
     Uint8 l = (Uint8)(0.2990 * ((a & 0x00FF0000) >> 16)
@@ -776,18 +1036,106 @@ static void create_channel_surface(SDL_Surface *surf, xcf_image_type itype, Uint
     SDL_FillSurfaceRect(surf, NULL, c);
 }
 
+static int get_xcf_max_threads(SDL_PropertiesID props)
+{
+    int maxLCores = SDL_GetNumLogicalCPUCores();
+    int maxThreads = (int)SDL_GetNumberProperty(props, IMG_PROP_LOAD_MAX_THREADS_NUMBER, 0);
+
+    if (maxThreads <= 0) {
+        maxThreads = maxLCores / 2;
+    }
+    return SDL_clamp(maxThreads, 1, maxLCores);
+}
+
+/* Decode and blend tiles until there are none left, with buffers reused from tile to tile */
+static void do_layer_tiles(xcf_tile_context *ctx)
+{
+    const xcf_level *level = ctx->level;
+    SDL_Surface *surface = ctx->surface;
+    Uint8 *buffer;
+    Uint32 *pixels;
+    int j;
+
+    buffer = (Uint8 *)SDL_malloc(XCF_TILE_BYTES + XCF_TILE_SIZE * XCF_TILE_SIZE * sizeof(Uint32));
+    if (!buffer) {
+        SDL_SetAtomicInt(&ctx->failed, 1);
+        return;
+    }
+    pixels = (Uint32 *)(buffer + XCF_TILE_BYTES);
+
+    while ((j = SDL_AddAtomicInt(&ctx->next_tile, 1)) < ctx->num_tiles) {
+        Uint32 tx = (Uint32)(j % ctx->tiles_across) * XCF_TILE_SIZE;
+        Uint32 ty = (Uint32)(j / ctx->tiles_across) * XCF_TILE_SIZE;
+        Uint32 ox = SDL_min(XCF_TILE_SIZE, level->width - tx);
+        Uint32 oy = SDL_min(XCF_TILE_SIZE, level->height - ty);
+        Sint64 x0, y0, x1, y1;
+        Uint64 offset, length;
+        const Uint8 *tile;
+        int w, h, y;
+
+        if (SDL_GetAtomicInt(&ctx->failed)) {
+            break;
+        }
+
+        /* Bounds check: reject layer if tile data exceeds buffer */
+        if ((Uint64)ox * oy > ctx->max_tile_pixels) {
+            SDL_SetAtomicInt(&ctx->failed, 1);
+            break;
+        }
+
+        /* Only the part of the tile inside both the layer and the image is drawn */
+        if (tx >= ctx->width || ty >= ctx->height) {
+            continue;
+        }
+        x0 = SDL_max(ctx->offset_x + tx, 0);
+        y0 = SDL_max(ctx->offset_y + ty, 0);
+        x1 = SDL_min(ctx->offset_x + tx + SDL_min(ox, ctx->width - tx), surface->w);
+        y1 = SDL_min(ctx->offset_y + ty + SDL_min(oy, ctx->height - ty), surface->h);
+        if (x1 <= x0 || y1 <= y0) {
+            continue;
+        }
+
+        offset = level->tile_file_offsets[j];
+        if (offset >= ctx->size) {
+            SDL_SetAtomicInt(&ctx->failed, 1);
+            break;
+        }
+        length = ctx->size - offset;
+        if (j + 1 < ctx->num_offsets && level->tile_file_offsets[j + 1] > offset) {
+            length = SDL_min(length, level->tile_file_offsets[j + 1] - offset);
+        }
+        tile = ctx->load_tile(ctx->data + offset, (size_t)length, ctx->bpp, ox, oy, buffer);
+        if (!tile) {
+            SDL_SetAtomicInt(&ctx->failed, 1);
+            break;
+        }
+
+        w = (int)(x1 - x0);
+        h = (int)(y1 - y0);
+        tile += ((size_t)(y0 - ctx->offset_y - ty) * ox + (size_t)(x0 - ctx->offset_x - tx)) * ctx->bpp;
+        convert_xcf_tile(ctx->head, ctx->bpp, tile, (size_t)ox * ctx->bpp, w, h, pixels);
+        for (y = 0; y < h; y++) {
+            Uint32 *row = (Uint32 *)((Uint8 *)surface->pixels + (y0 + y) * surface->pitch) + x0;
+            ctx->blend(row, pixels + y * w, w);
+        }
+    }
+    SDL_free(buffer);
+}
+
+static int SDLCALL xcf_tile_thread(void *data)
+{
+    do_layer_tiles((xcf_tile_context *)data);
+    return 0;
+}
+
 static int
-do_layer_surface(SDL_Surface *surface, SDL_IOStream *src, xcf_header *head, xcf_layer *layer, load_tile_type load_tile)
+do_layer_surface(SDL_Surface *surface, SDL_IOStream *src, const Uint8 *data, size_t size, xcf_header *head, xcf_layer *layer, load_tile_type load_tile, blend_func_type blend, int max_threads)
 {
     xcf_hierarchy  *hierarchy;
     xcf_level      *level;
-    unsigned char  *tile;
-    Uint8          *p8;
-    Uint32         *p;
-    int            i, j;
-    Uint32         x, y, tx, ty, ox, oy;
-    Uint32         *row;
-    Uint64         length;
+    xcf_tile_context ctx;
+    SDL_Thread     **threads = NULL;
+    int            i, num_threads;
 
     if (SDL_SeekIO(src, layer->hierarchy_file_offset, SDL_IO_SEEK_SET) < 0) {
         return 1;
@@ -798,189 +1146,107 @@ do_layer_surface(SDL_Surface *surface, SDL_IOStream *src, xcf_header *head, xcf_
         return 1;
     }
 
-    if (hierarchy->bpp > 4) {  /* unsupported. */
+    if (hierarchy->bpp == 0 || hierarchy->bpp > 4) {  /* unsupported. */
         SDL_SetError("Unknown Gimp image bpp (%u)", (unsigned int) hierarchy->bpp);
         free_xcf_hierarchy(hierarchy);
         return 1;
     }
+    if (hierarchy->bpp <= 2 && head->image_type != IMAGE_INDEXED && head->image_type != IMAGE_GREYSCALE) {
+        SDL_SetError("Unknown Gimp image type (%" SDL_PRIu32 ")", head->image_type);
+        free_xcf_hierarchy(hierarchy);
+        return 1;
+    }
 
-    level = NULL;
-    for (i = 0; hierarchy->level_file_offsets[i]; i++) {
-        if (SDL_SeekIO(src, hierarchy->level_file_offsets[i], SDL_IO_SEEK_SET) < 0)
-            break;
+    /* skip levels except the 1st one, just like GIMP does */
+    if (!hierarchy->level_file_offsets[0]) {
+        free_xcf_hierarchy(hierarchy);
+        return 0;
+    }
+    if (SDL_SeekIO(src, hierarchy->level_file_offsets[0], SDL_IO_SEEK_SET) < 0) {
+        free_xcf_hierarchy(hierarchy);
+        return 0;
+    }
+    level = read_xcf_level(src, head);
+    if (!level) {
+        free_xcf_hierarchy(hierarchy);
+        return 1;
+    }
 
-        if (i > 0) /* skip level except the 1st one, just like GIMP does */
-            continue;
+    SDL_zero(ctx);
+    ctx.surface = surface;
+    ctx.head = head;
+    ctx.level = level;
+    ctx.data = data;
+    ctx.size = size;
+    ctx.load_tile = load_tile;
+    ctx.blend = blend;
+    ctx.bpp = (int)hierarchy->bpp;
+    ctx.offset_x = (Sint32)layer->offset_x;
+    ctx.offset_y = (Sint32)layer->offset_y;
+    ctx.width = layer->width;
+    ctx.height = layer->height;
+    ctx.max_tile_pixels = (Uint64)hierarchy->width * hierarchy->height;
+    while (level->tile_file_offsets[ctx.num_offsets]) {
+        ctx.num_offsets++;
+    }
+    ctx.tiles_across = (int)((level->width + XCF_TILE_SIZE - 1) / XCF_TILE_SIZE);
+    ctx.num_tiles = ctx.tiles_across * (int)((level->height + XCF_TILE_SIZE - 1) / XCF_TILE_SIZE);
+    ctx.num_tiles = SDL_min(ctx.num_tiles, ctx.num_offsets);
+
+    /* Tiles don't overlap, so they can be decoded and blended in any order */
+    num_threads = (int)SDL_min(max_threads, ((Sint64)layer->width * layer->height) / MIN_XCF_PARALLEL_PIXELS);
+    num_threads = SDL_min(num_threads, ctx.num_tiles);
+    if (num_threads >= 2) {
+        threads = (SDL_Thread **)SDL_calloc(num_threads, sizeof(*threads));
+    }
 
-        level = read_xcf_level(src, head);
-        if (!level) {
-            free_xcf_hierarchy(hierarchy);
-            return 1;
+    /* This thread decodes tiles too, and picks up any that other threads couldn't */
+    if (threads) {
+        for (i = 1; i < num_threads; ++i) {
+            threads[i] = SDL_CreateThread(xcf_tile_thread, "SDL_image XCF", &ctx);
         }
-
-        ty = tx = 0;
-        for (j = 0; level->tile_file_offsets[j]; j++) {
-            SDL_SeekIO(src, level->tile_file_offsets[j], SDL_IO_SEEK_SET);
-            ox = tx + 64 > level->width ? level->width % 64 : 64;
-            oy = ty + 64 > level->height ? level->height % 64 : 64;
-            length = ox*oy*6;
-
-            if (level->tile_file_offsets[j + 1] > level->tile_file_offsets[j]) {
-                length = level->tile_file_offsets[j + 1] - level->tile_file_offsets[j];
-            }
-            if (length <= SDL_SIZE_MAX) {
-                tile = load_tile(src, (size_t)length, hierarchy->bpp, ox, oy);
-            } else {
-                SDL_SetError("Gimp image invalid tile offsets");
-                tile = NULL;
-            }
-            if (!tile) {
-                if (hierarchy) {
-                    free_xcf_hierarchy(hierarchy);
-                }
-                if (level) {
-                    free_xcf_level(level);
-                }
-                return 1;
-            }
-
-            p8 = tile;
-            p = (Uint32 *) p8;
-
-            /* Bounds check: reject layer if tile data exceeds buffer */
-            if ((Uint64)ox * oy * hierarchy->bpp > (Uint64)(hierarchy->width * hierarchy->height * hierarchy->bpp)) {
-                SDL_SetError("Gimp image invalid tile");
-                free_xcf_tile(tile);
-                free_xcf_level(level);
-                free_xcf_hierarchy(hierarchy);
-                return 1;
-            }
-
-            for (y = ty; y < ty + oy; y++) {
-                if ((y >= (Uint32)surface->h) || ((tx+ox) > (Uint32)surface->w)) {
-                    break;
-                }
-                row = (Uint32 *) ((Uint8 *) surface->pixels + y * surface->pitch + tx * 4);
-                switch (hierarchy->bpp) {
-                case 4:
-                    for (x = tx; x < tx + ox; x++)
-                        *row++ = SDL_Swap32(*p++);
-                    break;
-                case 3:
-                    for (x = tx; x < tx + ox; x++) {
-                        *row = 0xFF000000;
-                        *row |= ((Uint32)*p8++ << 16);
-                        *row |= ((Uint32)*p8++ << 8);
-                        *row |= ((Uint32)*p8++ << 0);
-                        row++;
-                    }
-                    break;
-                case 2:
-                    /* Indexed / Greyscale + Alpha */
-                    switch (head->image_type) {
-                    case IMAGE_INDEXED:
-                        for (x = tx; x < tx + ox; x++) {
-                            Uint8 c = *p8++;
-                            Uint8 a = *p8++;
-                            if (c < head->cm_num) {
-                                *row++ = ((Uint32)(head->cm_map[c * 3]) << 16) |
-                                         ((Uint32)(head->cm_map[c * 3 + 1]) << 8) |
-                                         ((Uint32)(head->cm_map[c * 3 + 2]) << 0) |
-                                         ((Uint32)a << 24);
-                            } else {
-                                *row++ = 0;
-                            }
-                        }
-                        break;
-                    case IMAGE_GREYSCALE:
-                        for (x = tx; x < tx + ox; x++) {
-                            Uint8 c = *p8++;
-                            Uint8 a = *p8++;
-                            *row++ = ((Uint32)c << 16) |
-                                     ((Uint32)c << 8) |
-                                     ((Uint32)c << 0) |
-                                     ((Uint32)a << 24);
-                        }
-                        break;
-                    default:
-                        SDL_SetError("Unknown Gimp image type (%" SDL_PRIu32 ")", head->image_type);
-                        if (hierarchy) {
-                            free_xcf_hierarchy(hierarchy);
-                        }
-                        if (level)
-                            free_xcf_level(level);
-                        return 1;
-                    }
-                    break;
-                case 1:
-                    /* Indexed / Greyscale */
-                    switch (head->image_type) {
-                    case IMAGE_INDEXED:
-                        for (x = tx; x < tx + ox; x++) {
-                            Uint8 c = *p8++;
-                            if (c < head->cm_num) {
-                                *row++ = 0xFF000000 |
-                                         ((Uint32)(head->cm_map[c * 3]) << 16) |
-                                         ((Uint32)(head->cm_map[c * 3 + 1]) << 8) |
-                                         ((Uint32)(head->cm_map[c * 3 + 2]) << 0);
-                            } else {
-                                *row++ = 0;
-                            }
-                        }
-                        break;
-                    case IMAGE_GREYSCALE:
-                        for (x = tx; x < tx + ox; x++) {
-                            Uint8 c = *p8++;
-                            *row++ = 0xFF000000 |
-                                     (((Uint32)c) << 16) |
-                                     (((Uint32)c) << 8) |
-                                     (((Uint32)c) << 0);
-                        }
-                        break;
-                    default:
-                        SDL_SetError("Unknown Gimp image type (%" SDL_PRIu32 ")\n", head->image_type);
-                        if (tile)
-                            free_xcf_tile(tile);
-                        if (level)
-                            free_xcf_level(level);
-                        if (hierarchy)
-                            free_xcf_hierarchy(hierarchy);
-                        return 1;
-                    }
-                    break;
-                }
-            }
-            free_xcf_tile(tile);
-
-            tx += 64;
-            if (tx >= level->width) {
-                tx = 0;
-                ty += 64;
-            }
-            if (ty >= level->height) {
-                break;
+    }
+    do_layer_tiles(&ctx);
+    if (threads) {
+        for (i = 1; i < num_threads; ++i) {
+            if (threads[i]) {
+                SDL_WaitThread(threads[i], NULL);
             }
         }
-        free_xcf_level(level);
+        SDL_free(threads);
     }
 
+    free_xcf_level(level);
     free_xcf_hierarchy(hierarchy);
 
+    if (SDL_GetAtomicInt(&ctx.failed)) {
+        SDL_SetError("Gimp image invalid tile data");
+        return 1;
+    }
     return 0;
 }
 
-SDL_Surface *IMG_LoadXCF_IO(SDL_IOStream *src)
+SDL_Surface *IMG_LoadXCFWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
 {
     Sint64 start;
     const char *error = NULL;
-    SDL_Surface *surface, *lays;
-    xcf_header *head;
+    SDL_Surface *surface;
+    SDL_IOStream *io = NULL;
+    SDL_PropertiesID io_props;
+    const Uint8 *base;
+    Uint8 *buffer = NULL;
+    const Uint8 *data;
+    size_t size = 0;
+    Sint64 mem_size;
+    xcf_header *head = NULL;
     xcf_layer    *layer;
     xcf_channel **channel = NULL;
     int chnls = 0;
     int i, offsets;
     Sint64 offset, fp;
     load_tile_type load_tile;
+    blend_func_type blend;
+    int max_threads;
 
     if (!src) {
         /* The error message has been set in SDL_IOFromFile */
@@ -991,7 +1257,26 @@ SDL_Surface *IMG_LoadXCF_IO(SDL_IOStream *src)
     /* Initialize the data we will clean up when we're done */
     surface = NULL;
 
-    head = read_xcf_header(src);
+    /* Tiles are decoded straight from memory, so memory streams are used in place and anything else is read in */
+    io_props = SDL_GetIOProperties(src);
+    base = (const Uint8 *)SDL_GetPointerProperty(io_props, SDL_PROP_IOSTREAM_MEMORY_POINTER, NULL);
+    mem_size = SDL_GetNumberProperty(io_props, SDL_PROP_IOSTREAM_MEMORY_SIZE_NUMBER, 0);
+    if (base && start >= 0 && mem_size > start) {
+        data = base + start;
+        size = (size_t)(mem_size - start);
+    } else {
+        buffer = (Uint8 *)SDL_LoadFile_IO(src, &size, false);
+        data = buffer;
+    }
+    if (data) {
+        io = SDL_IOFromConstMem(data, size);
+    }
+    if (!io) {
+        error = "Couldn't read XCF file";
+        goto done;
+    }
+
+    head = read_xcf_header(io);
     if (!head) {
         error = "Couldn't read header";
         goto done;
@@ -1004,10 +1289,17 @@ SDL_Surface *IMG_LoadXCF_IO(SDL_IOStream *src)
     case COMPR_RLE:
         load_tile = load_xcf_tile_rle;
         break;
+#ifdef USE_STBIMAGE
+    case COMPR_ZLIB:
+        load_tile = load_xcf_tile_zlib;
+        break;
+#endif
     default:
         error = "Unsupported compression";
         goto done;
     }
+    blend = get_xcf_blend_func();
+    max_threads = get_xcf_max_threads(props);
 
     /* Create the surface of the appropriate type */
     surface = SDL_CreateSurface(head->width, head->height, SDL_PIXELFORMAT_ARGB8888);
@@ -1018,62 +1310,45 @@ SDL_Surface *IMG_LoadXCF_IO(SDL_IOStream *src)
 
     offsets = 0;
 
-    while ((offset = read_offset(src, head)) != 0) {
+    while ((offset = read_offset(io, head)) != 0) {
         head->layer_file_offsets = (Uint64 *)SDL_realloc(head->layer_file_offsets, sizeof(Uint64) * (offsets + 1));
         head->layer_file_offsets[offsets] = offset;
         offsets++;
     }
-    fp = SDL_TellIO (src);
+    fp = SDL_TellIO (io);
 
-    lays = SDL_CreateSurface(head->width, head->height, SDL_PIXELFORMAT_ARGB8888);
-    if (lays == NULL) {
-        error = "Out of memory";
-        goto done;
-    }
-
-    /* Blit layers backwards, because Gimp saves them highest first */
+    /* Blend layers backwards, because Gimp saves them highest first */
     for (i = offsets; i > 0; i--) {
-        SDL_Rect rs, rd;
-        SDL_SeekIO(src, head->layer_file_offsets[i-1], SDL_IO_SEEK_SET);
+        SDL_SeekIO(io, head->layer_file_offsets[i-1], SDL_IO_SEEK_SET);
 
-        layer = read_xcf_layer(src, head);
+        layer = read_xcf_layer(io, head);
         if (layer != NULL) {
             if (layer->visible) {
-                if (do_layer_surface(lays, src, head, layer, load_tile) != 0) {
+                if (do_layer_surface(surface, io, data, size, head, layer, load_tile, blend, max_threads) != 0) {
                     error = SDL_GetError();
+                    free_xcf_layer(layer);
                     goto done;
                 }
-                rs.x = 0;
-                rs.y = 0;
-                rs.w = layer->width;
-                rs.h = layer->height;
-                rd.x = layer->offset_x;
-                rd.y = layer->offset_y;
-                rd.w = layer->width;
-                rd.h = layer->height;
-
-                SDL_BlitSurface(lays, &rs, surface, &rd);
             }
             free_xcf_layer(layer);
         }
     }
-    SDL_DestroySurface(lays);
 
-    SDL_SeekIO(src, fp, SDL_IO_SEEK_SET);
+    SDL_SeekIO(io, fp, SDL_IO_SEEK_SET);
 
     /* read channels */
-    while ((offset = read_offset (src, head)) != 0) {
+    while ((offset = read_offset (io, head)) != 0) {
         channel = (xcf_channel **)SDL_realloc(channel, sizeof(xcf_channel *) * (chnls + 1));
-        fp = SDL_TellIO(src);
-        if (SDL_SeekIO(src, offset, SDL_IO_SEEK_SET) < 0) {
+        fp = SDL_TellIO(io);
+        if (SDL_SeekIO(io, offset, SDL_IO_SEEK_SET) < 0) {
             error = "invalid channel offset";
             goto done;
         }
-        channel[chnls] = read_xcf_channel(src, head);
+        channel[chnls] = read_xcf_channel(io, head);
         if (channel[chnls] != NULL) {
             chnls++;
         }
-        SDL_SeekIO(src, fp, SDL_IO_SEEK_SET);
+        SDL_SeekIO(io, fp, SDL_IO_SEEK_SET);
     }
 
     if (chnls) {
@@ -1109,10 +1384,22 @@ done:
             surface = NULL;
         }
         SDL_SetError("%s", error);
+    } else {
+        /* Leave the stream just past the data that was read, as if it had been read directly */
+        SDL_SeekIO(src, start + SDL_TellIO(io), SDL_IO_SEEK_SET);
+    }
+    if (io) {
+        SDL_CloseIO(io);
     }
+    SDL_free(buffer);
     return surface;
 }
 
+SDL_Surface *IMG_LoadXCF_IO(SDL_IOStream *src)
+{
+    return IMG_LoadXCFWithProperties(src, 0);
+}
+
 #else
 
 /* See if an image is contained in a data source */
@@ -1128,4 +1415,10 @@ SDL_Surface *IMG_LoadXCF_IO(SDL_IOStream *src)
     return NULL;
 }
 
+SDL_Surface *IMG_LoadXCFWithProperties(SDL_IOStream *src, SDL_PropertiesID props)
+{
+    SDL_SetError("SDL_image built without XCF support");
+    return NULL;
+}
+
 #endif /* LOAD_XCF */
@@ -168,6 +168,7 @@ typedef struct NSVGimage
 	float width;				// Width of the image.
 	float height;				// Height of the image.
 	NSVGshape* shapes;			// Linked list of shapes in the image.
+	struct NSVGarenaPage* arena;	// Memory of the shapes and paths, freed all at once.
 } NSVGimage;
 
 #ifdef HAVE_STDIO_H
@@ -175,9 +176,15 @@ typedef struct NSVGimage
 NSVG_EXPORT NSVGimage* nsvgParseFromFile(const char* filename, const char* units, float dpi);
 #endif
 
+#if 0
 // Parses SVG file from a null terminated string, returns SVG image as paths.
 // Important note: changes the string.
 NSVG_EXPORT NSVGimage* nsvgParse(char* input, const char* units, float dpi);
+#endif
+
+// Parses SVG file from the first size bytes of a buffer, which doesn't need to be null terminated.
+// Important note: changes the buffer.
+NSVG_EXPORT NSVGimage* nsvgParseBuffer(char* input, size_t size, const char* units, float dpi);
 
 #if 0
 // Duplicates a path.
@@ -229,7 +236,8 @@ NSVG_EXPORT void nsvgDelete(NSVGimage* image);
 
 static int nsvg__isspace(char c)
 {
-	return strchr(" \t\n\v\f\r", c) != NULL;
+	// SDL_image change: compare directly instead of calling strchr(" \t\n\v\f\r", c), which also matched '\0'
+	return c == ' ' || c == '\t' || c == '\n' || c == '\v' || c == '\f' || c == '\r' || c == '\0';
 }
 
 static int nsvg__isdigit(char c)
@@ -335,31 +343,31 @@ static void nsvg__parseElement(char* s,
 		(*endelCb)(ud, name);
 }
 
-static int nsvg__parseXML(char* input,
+// SDL_image change: the input is bounded by its size instead of a terminator.
+// Every string passed to the callbacks still ends with a '\0' written over a '<' or '>'.
+static int nsvg__parseXML(char* input, size_t size,
 				   void (*startelCb)(void* ud, const char* el, const char** attr),
 				   void (*endelCb)(void* ud, const char* el),
 				   void (*contentCb)(void* ud, const char* s),
 				   void* ud)
 {
 	char* s = input;
+	char* end = input + size;
 	char* mark = s;
-	int state = NSVG_XML_CONTENT;
-	while (*s) {
-		if (*s == '<' && state == NSVG_XML_CONTENT) {
-			// Start of a tag
-			*s++ = '\0';
-			nsvg__parseContent(mark, contentCb, ud);
-			mark = s;
-			state = NSVG_XML_TAG;
-		} else if (*s == '>' && state == NSVG_XML_TAG) {
-			// Start of a content or new tag.
-			*s++ = '\0';
-			nsvg__parseElement(mark, startelCb, endelCb, ud);
-			mark = s;
-			state = NSVG_XML_CONTENT;
-		} else {
-			s++;
-		}
+	while (s < end && *s) {
+		// Content runs to the start of a tag
+		while (s < end && *s && *s != '<') s++;
+		if (s == end || !*s) break;
+		*s++ = '\0';
+		nsvg__parseContent(mark, contentCb, ud);
+		mark = s;
+
+		// The tag runs to the start of the next content
+		while (s < end && *s && *s != '>') s++;
+		if (s == end || !*s) break;
+		*s++ = '\0';
+		nsvg__parseElement(mark, startelCb, endelCb, ud);
+		mark = s;
 	}
 
 	return 1;
@@ -476,6 +484,51 @@ typedef struct NSVGparser
 	char styleFlag;
 } NSVGparser;
 
+// SDL_image change: shapes, paths and their points are allocated from pages owned by the image
+#define NSVG_ARENA_PAGE_SIZE (64*1024)
+#define NSVG_ARENA_ALIGN(n) (((n) + 15) & ~(size_t)15)
+
+typedef struct NSVGarenaPage {
+	struct NSVGarenaPage* next;
+	size_t size;
+	size_t used;
+} NSVGarenaPage;
+
+static void* nsvg__arenaAlloc(NSVGimage* image, size_t size)
+{
+	NSVGarenaPage* page = image->arena;
+	size_t header = NSVG_ARENA_ALIGN(sizeof(NSVGarenaPage));
+
+	size = NSVG_ARENA_ALIGN(size);
+	if (page == NULL || page->used + size > page->size) {
+		// Large blocks get a page of their own, so the current page keeps being filled
+		int large = (size > NSVG_ARENA_PAGE_SIZE / 4);
+		size_t capacity = large ? size : NSVG_ARENA_PAGE_SIZE;
+		page = (NSVGarenaPage*)malloc(header + capacity);
+		if (page == NULL) return NULL;
+		page->size = capacity;
+		page->used = 0;
+		if (large && image->arena != NULL) {
+			page->next = image->arena->next;
+			image->arena->next = page;
+		} else {
+			page->next = image->arena;
+			image->arena = page;
+		}
+	}
+	page->used += size;
+	return (unsigned char*)page + header + page->used - size;
+}
+
+static void nsvg__deleteArena(NSVGarenaPage* page)
+{
+	while (page != NULL) {
+		NSVGarenaPage* next = page->next;
+		free(page);
+		page = next;
+	}
+}
+
 static void nsvg__xformIdentity(float* t)
 {
 	t[0] = 1.0f; t[1] = 0.0f;
@@ -680,17 +733,6 @@ static void nsvg__deleteStyles(NSVGstyleDeclaration* style) {
 	}
 }
 
-static void nsvg__deletePaths(NSVGpath* path)
-{
-	while (path) {
-		NSVGpath *next = path->next;
-		if (path->pts != NULL)
-			free(path->pts);
-		free(path);
-		path = next;
-	}
-}
-
 static void nsvg__deletePaint(NSVGpaint* paint)
 {
 	if (paint->type == NSVG_PAINT_LINEAR_GRADIENT || paint->type == NSVG_PAINT_RADIAL_GRADIENT)
@@ -712,7 +754,7 @@ static void nsvg__deleteParser(NSVGparser* p)
 {
 	if (p != NULL) {
 		nsvg__deleteStyles(p->styles);
-		nsvg__deletePaths(p->plist);
+		// Any paths left in plist belong to the image's arena
 		nsvg__deleteGradientData(p->gradients);
 		nsvgDelete(p->image);
 		free(p->pts);
@@ -982,8 +1024,8 @@ static void nsvg__addShape(NSVGparser* p)
 	if (p->plist == NULL)
 		return;
 
-	shape = (NSVGshape*)malloc(sizeof(NSVGshape));
-	if (shape == NULL) goto error;
+	shape = (NSVGshape*)nsvg__arenaAlloc(p->image, sizeof(NSVGshape));
+	if (shape == NULL) return;
 	memset(shape, 0, sizeof(NSVGshape));
 
 	memcpy(shape->id, attr->id, sizeof shape->id);
@@ -1048,11 +1090,6 @@ static void nsvg__addShape(NSVGparser* p)
 	else
 		p->shapesTail->next = shape;
 	p->shapesTail = shape;
-
-	return;
-
-error:
-	if (shape) free(shape);
 }
 
 static void nsvg__addPath(NSVGparser* p, char closed)
@@ -1073,12 +1110,12 @@ static void nsvg__addPath(NSVGparser* p, char closed)
 	if ((p->npts % 3) != 1)
 		return;
 
-	path = (NSVGpath*)malloc(sizeof(NSVGpath));
-	if (path == NULL) goto error;
+	path = (NSVGpath*)nsvg__arenaAlloc(p->image, sizeof(NSVGpath));
+	if (path == NULL) return;
 	memset(path, 0, sizeof(NSVGpath));
 
-	path->pts = (float*)malloc(p->npts*2*sizeof(float));
-	if (path->pts == NULL) goto error;
+	path->pts = (float*)nsvg__arenaAlloc(p->image, p->npts*2*sizeof(float));
+	if (path->pts == NULL) return;
 	path->closed = closed;
 	path->npts = p->npts;
 
@@ -1105,73 +1142,91 @@ static void nsvg__addPath(NSVGparser* p, char closed)
 
 	path->next = p->plist;
 	p->plist = path;
-
-	return;
-
-error:
-	if (path != NULL) {
-		if (path->pts != NULL) free(path->pts);
-		free(path);
-	}
 }
 
-// We roll our own string to float because the std library one uses locale and messes things up.
-static float nsvg__atof(const char* s)
+// SDL_image change: numbers are parsed in a single pass straight from the source,
+// with the syntax of nsvg__parseNumber(). Up to 19 significant digits are kept,
+// and values with a short mantissa and a small exponent are rounded only once.
+static const float nsvg__pow10f[] = {
+	1e0f, 1e1f, 1e2f, 1e3f, 1e4f, 1e5f, 1e6f, 1e7f, 1e8f, 1e9f, 1e10f
+};
+static const double nsvg__pow10[] = {
+	1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+	1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+static const char* nsvg__parseFloat(const char* s, float* value)
 {
-	char* cur = (char*)s;
-	char* end = NULL;
-	double res = 0.0, sign = 1.0;
-	long long intPart = 0, fracPart = 0;
-	char hasIntPart = 0, hasFracPart = 0;
-
-	// Parse optional sign
-	if (*cur == '+') {
-		cur++;
-	} else if (*cur == '-') {
-		sign = -1;
-		cur++;
-	}
-
-	// Parse integer part
-	if (nsvg__isdigit(*cur)) {
-		// Parse digit sequence
-		intPart = strtoll(cur, &end, 10);
-		if (cur != end) {
-			res = (double)intPart;
-			hasIntPart = 1;
-			cur = end;
+	unsigned long long mant = 0;
+	int digits = 0, exp10 = 0, neg = 0, valid = 0;
+	float res;
+
+	// sign
+	if (*s == '-' || *s == '+') {
+		neg = (*s == '-');
+		s++;
+	}
+	// integer part
+	while (nsvg__isdigit(*s)) {
+		if (digits < 19) {
+			mant = mant*10 + (unsigned int)(*s - '0');
+			if (mant) digits++;
+		} else {
+			exp10++;
 		}
+		valid = 1;
+		s++;
 	}
-
-	// Parse fractional part.
-	if (*cur == '.') {
-		cur++; // Skip '.'
-		if (nsvg__isdigit(*cur)) {
-			// Parse digit sequence
-			fracPart = strtoll(cur, &end, 10);
-			if (cur != end) {
-				res += (double)fracPart / pow(10.0, (double)(end - cur));
-				hasFracPart = 1;
-				cur = end;
+	if (*s == '.') {
+		// fraction part
+		s++;
+		while (nsvg__isdigit(*s)) {
+			if (digits < 19) {
+				mant = mant*10 + (unsigned int)(*s - '0');
+				if (mant) digits++;
+				exp10--;
 			}
+			valid = 1;
+			s++;
 		}
 	}
-
-	// A valid number should have integer or fractional part.
-	if (!hasIntPart && !hasFracPart)
-		return 0.0f;
-
-	// Parse optional exponent
-	if (*cur == 'e' || *cur == 'E') {
-		long expPart = 0;
-		cur++; // skip 'E'
-		expPart = strtol(cur, &end, 10); // Parse digit sequence with sign
-		if (cur != end) {
-			res *= pow(10.0, (double)expPart);
+	// exponent
+	if ((*s == 'e' || *s == 'E') && (s[1] != 'm' && s[1] != 'x')) {
+		int expNeg = 0, expPart = 0;
+		s++;
+		if (*s == '-' || *s == '+') {
+			expNeg = (*s == '-');
+			s++;
+		}
+		while (nsvg__isdigit(*s)) {
+			if (expPart < 100000)
+				expPart = expPart*10 + (*s - '0');
+			s++;
 		}
+		exp10 += expNeg ? -expPart : expPart;
+	}
+
+	if (!valid || mant == 0) {
+		res = 0.0f;
+	} else if (mant <= (1ull << 24) && exp10 >= -10 && exp10 <= 10) {
+		// Both operands are exact, so the result is correctly rounded
+		res = exp10 < 0 ? (float)mant / nsvg__pow10f[-exp10] : (float)mant * nsvg__pow10f[exp10];
+	} else if (mant <= (1ull << 53) && exp10 >= -22 && exp10 <= 22) {
+		res = (float)(exp10 < 0 ? (double)mant / nsvg__pow10[-exp10] : (double)mant * nsvg__pow10[exp10]);
+	} else {
+		res = (float)((double)mant * pow(10.0, (double)exp10));
 	}
+	*value = neg ? -res : res;
 
-	return (float)(res * sign);
+	return s;
+}
+
+// We roll our own string to float because the std library one uses locale and messes things up.
+static float nsvg__atof(const char* s)
+{
+	float value;
+	nsvg__parseFloat(s, &value);
+	return value;
 }
 
 
@@ -1218,6 +1273,15 @@ static const char* nsvg__parseNumber(const char* s, char* it, const int size)
 	return s;
 }
 
+static int nsvg__isCoordinate(const char* s)
+{
+	// optional sign
+	if (*s == '-' || *s == '+')
+		s++;
+	// must have at least one digit, or start by a dot
+	return (nsvg__isdigit(*s) || *s == '.');
+}
+
 static const char* nsvg__getNextPathItemWhenArcFlag(const char* s, char* it)
 {
 	it[0] = '\0';
@@ -1231,14 +1295,21 @@ static const char* nsvg__getNextPathItemWhenArcFlag(const char* s, char* it)
 	return s;
 }
 
-static const char* nsvg__getNextPathItem(const char* s, char* it)
+// SDL_image change: a number is returned in value, with its first character in it and
+// coord set if it's a valid coordinate, instead of being copied out for nsvg__atof().
+static const char* nsvg__getNextPathItem(const char* s, char* it, float* value, int* coord)
 {
 	it[0] = '\0';
+	*value = 0.0f;
+	*coord = 0;
 	// Skip white spaces and commas
 	while (*s && (nsvg__isspace(*s) || *s == ',')) s++;
 	if (!*s) return s;
 	if (*s == '-' || *s == '+' || *s == '.' || nsvg__isdigit(*s)) {
-		s = nsvg__parseNumber(s, it, 64);
+		it[0] = *s;
+		it[1] = '\0';
+		*coord = nsvg__isCoordinate(s);
+		s = nsvg__parseFloat(s, value);
 	} else {
 		// Parse command
 		it[0] = *s++;
@@ -1535,21 +1606,10 @@ static int nsvg__parseUnits(const char* units)
 	return NSVG_UNITS_USER;
 }
 
-static int nsvg__isCoordinate(const char* s)
-{
-	// optional sign
-	if (*s == '-' || *s == '+')
-		s++;
-	// must have at least one digit, or start by a dot
-	return (nsvg__isdigit(*s) || *s == '.');
-}
-
 static NSVGcoordinate nsvg__parseCoordinateRaw(const char* str)
 {
 	NSVGcoordinate coord = {0, NSVG_UNITS_USER};
-	char buf[64];
-	coord.units = nsvg__parseUnits(nsvg__parseNumber(str, buf, 64));
-	coord.value = nsvg__atof(buf);
+	coord.units = nsvg__parseUnits(nsvg__parseFloat(str, &coord.value));
 	return coord;
 }
 
@@ -1571,7 +1631,6 @@ static int nsvg__parseTransformArgs(const char* str, float* args, int maxNa, int
 {
 	const char* end;
 	const char* ptr;
-	char it[64];
 
 	*na = 0;
 	ptr = str;
@@ -1586,8 +1645,7 @@ static int nsvg__parseTransformArgs(const char* str, float* args, int maxNa, int
 	while (ptr < end) {
 		if (*ptr == '-' || *ptr == '+' || *ptr == '.' || nsvg__isdigit(*ptr)) {
 			if (*na >= maxNa) return 0;
-			ptr = nsvg__parseNumber(ptr, it, 64);
-			args[(*na)++] = (float)nsvg__atof(it);
+			ptr = nsvg__parseFloat(ptr, &args[(*na)++]);
 		} else {
 			++ptr;
 		}
@@ -2326,6 +2384,8 @@ static void nsvg__parsePath(NSVGparser* p, const char** attr)
 	char closedFlag;
 	int i;
 	char item[64];
+	float value;
+	int coord;
 
 	for (i = 0; attr[i]; i += 2) {
 		if (strcmp(attr[i], "d") == 0) {
@@ -2349,14 +2409,17 @@ static void nsvg__parsePath(NSVGparser* p, const char** attr)
 
 		while (*s) {
 			item[0] = '\0';
-			if ((cmd == 'A' || cmd == 'a') && (nargs == 3 || nargs == 4))
+			if ((cmd == 'A' || cmd == 'a') && (nargs == 3 || nargs == 4)) {
 				s = nsvg__getNextPathItemWhenArcFlag(s, item);
+				value = (item[0] == '1') ? 1.0f : 0.0f;
+				coord = 1;
+			}
 			if (!*item)
-				s = nsvg__getNextPathItem(s, item);
+				s = nsvg__getNextPathItem(s, item, &value, &coord);
 			if (!*item) break;
-			if (cmd != '\0' && nsvg__isCoordinate(item)) {
+			if (cmd != '\0' && coord) {
 				if (nargs < 10)
-					args[nargs++] = (float)nsvg__atof(item);
+					args[nargs++] = value;
 				if (nargs >= rargs) {
 					switch (cmd) {
 						case 'm':
@@ -2613,6 +2676,8 @@ static void nsvg__parsePoly(NSVGparser* p, const char** attr, int closeFlag)
 	float args[2];
 	int nargs, npts = 0;
 	char item[64];
+	float value;
+	int coord;
 
 	nsvg__resetPath(p);
 
@@ -2622,8 +2687,8 @@ static void nsvg__parsePoly(NSVGparser* p, const char** attr, int closeFlag)
 				s = attr[i + 1];
 				nargs = 0;
 				while (*s) {
-					s = nsvg__getNextPathItem(s, item);
-					args[nargs++] = (float)nsvg__atof(item);
+					s = nsvg__getNextPathItem(s, item, &value, &coord);
+					args[nargs++] = value;
 					if (nargs >= 2) {
 						if (npts == 0)
 							nsvg__moveTo(p, args[0], args[1]);
@@ -3146,7 +3211,14 @@ static void nsvg__createGradients(NSVGparser* p)
 	}
 }
 
+#if 0
 NSVG_EXPORT NSVGimage* nsvgParse(char* input, const char* units, float dpi)
+{
+	return nsvgParseBuffer(input, strlen(input), units, dpi);
+}
+#endif
+
+NSVG_EXPORT NSVGimage* nsvgParseBuffer(char* input, size_t size, const char* units, float dpi)
 {
 	NSVGparser* p;
 	NSVGimage* ret = NULL;
@@ -3157,7 +3229,7 @@ NSVG_EXPORT NSVGimage* nsvgParse(char* input, const char* units, float dpi)
 	}
 	p->dpi = dpi;
 
-	nsvg__parseXML(input, nsvg__startElement, nsvg__endElement, nsvg__content, p);
+	nsvg__parseXML(input, size, nsvg__startElement, nsvg__endElement, nsvg__content, p);
 
 	// Create gradients after all definitions have been parsed
 	nsvg__createGradients(p);
@@ -3191,7 +3263,7 @@ NSVG_EXPORT NSVGimage* nsvgParseFromFile(const char* filename, const char* units
 	if (fread(data, 1, size, fp) != size) goto error;
 	data[size] = '\0';	// Must be null terminated.
 	fclose(fp);
-	image = nsvgParse(data, units, dpi);
+	image = nsvgParseBuffer(data, size, units, dpi);
 	free(data);
 
 	return image;
@@ -3243,12 +3315,11 @@ NSVG_EXPORT void nsvgDelete(NSVGimage* image)
 	shape = image->shapes;
 	while (shape != NULL) {
 		snext = shape->next;
-		nsvg__deletePaths(shape->paths);
 		nsvg__deletePaint(&shape->fill);
 		nsvg__deletePaint(&shape->stroke);
-		free(shape);
 		shape = snext;
 	}
+	nsvg__deleteArena(image->arena);
 	free(image);
 }
 
@@ -66,6 +66,20 @@ NSVG_EXPORT void nsvgRasterize(NSVGrasterizer* r,
 		               NSVGimage* image, float tx, float ty, float scale,
 		               unsigned char* dst, int w, int h, int stride);
 
+// Rasterizes rows y0 to y1-1 of the image, so that separate rasterizers can
+// render disjoint bands of the same destination on different threads.
+// The rows are unpremultiplied, but not defringed, since that needs the rows
+// on either side. Once every band is done, call nsvgDefringeRows() over all
+// rows to get the same result as nsvgRasterize().
+NSVG_EXPORT void nsvgRasterizeRows(NSVGrasterizer* r,
+		               NSVGimage* image, float tx, float ty, float scale,
+		               unsigned char* dst, int w, int h, int stride, int y0, int y1);
+
+// Fills the color of transparent pixels in rows y0 to y1-1 from their opaque
+// neighbours. Rows may be defringed in any order, as long as the rows next to
+// them have been rasterized.
+NSVG_EXPORT void nsvgDefringeRows(unsigned char* dst, int w, int h, int stride, int y0, int y1);
+
 // Deletes rasterizer context.
 NSVG_EXPORT void nsvgDeleteRasterizer(NSVGrasterizer*);
 
@@ -122,6 +136,12 @@ typedef struct NSVGcachedPaint {
 	unsigned int colors[256];
 } NSVGcachedPaint;
 
+// SDL_image change: span kernels, picked for the CPU when the rasterizer is created
+typedef void (*NSVGfillSpanFunc)(unsigned char* scanline, int count, int weight);
+typedef void (*NSVGblendSolidFunc)(unsigned char* dst, int count, const unsigned char* cover, unsigned int color);
+typedef void (*NSVGblendColorsFunc)(unsigned char* dst, int count, const unsigned char* cover, const unsigned int* colors);
+typedef void (*NSVGgradientColorsFunc)(unsigned int* colors, int count, float* fx, float fy, float dx, const float* t, const unsigned int* lut, int radial);
+
 struct NSVGrasterizer
 {
 	float px, py;
@@ -150,8 +170,15 @@ struct NSVGrasterizer
 
 	unsigned char* bitmap;
 	int width, height, stride;
+
+	NSVGfillSpanFunc fillSpan;
+	NSVGblendSolidFunc blendSolid;
+	NSVGblendColorsFunc blendColors;
+	NSVGgradientColorsFunc gradientColors;
 };
 
+static void nsvg__initKernels(NSVGrasterizer* r);
+
 NSVG_EXPORT NSVGrasterizer* nsvgCreateRasterizer(void)
 {
 	NSVGrasterizer* r = (NSVGrasterizer*)malloc(sizeof(NSVGrasterizer));
@@ -161,6 +188,8 @@ NSVG_EXPORT NSVGrasterizer* nsvgCreateRasterizer(void)
 	r->tessTol = 0.25f;
 	r->distTol = 0.01f;
 
+	nsvg__initKernels(r);
+
 	return r;
 
 error:
@@ -900,7 +929,7 @@ static void nsvg__freeActive(NSVGrasterizer* r, NSVGactiveEdge* z)
 	r->freelist = z;
 }
 
-static void nsvg__fillScanline(unsigned char* scanline, int len, int x0, int x1, int maxWeight, int* xmin, int* xmax)
+static void nsvg__fillScanline(unsigned char* scanline, int len, int x0, int x1, int maxWeight, int* xmin, int* xmax, NSVGfillSpanFunc fillSpan)
 {
 	int i = x0 >> NSVG__FIXSHIFT;
 	int j = x1 >> NSVG__FIXSHIFT;
@@ -921,8 +950,8 @@ static void nsvg__fillScanline(unsigned char* scanline, int len, int x0, int x1,
 			else
 				j = len; // clip
 
-			for (++i; i < j; ++i) // fill pixels between x0 and x1
-				scanline[i] = (unsigned char)(scanline[i] + maxWeight);
+			if (j > i + 1) // fill pixels between x0 and x1
+				fillSpan(&scanline[i + 1], j - i - 1, maxWeight);
 		}
 	}
 }
@@ -930,7 +959,7 @@ static void nsvg__fillScanline(unsigned char* scanline, int len, int x0, int x1,
 // note: this routine clips fills that extend off the edges... ideally this
 // wouldn't happen, but it could happen if the truetype glyph bounding boxes
 // are wrong, or if the user supplies a too-small bitmap
-static void nsvg__fillActiveEdges(unsigned char* scanline, int len, NSVGactiveEdge* e, int maxWeight, int* xmin, int* xmax, char fillRule)
+static void nsvg__fillActiveEdges(unsigned char* scanline, int len, NSVGactiveEdge* e, int maxWeight, int* xmin, int* xmax, char fillRule, NSVGfillSpanFunc fillSpan)
 {
 	// non-zero winding fill
 	int x0 = 0, w = 0;
@@ -945,7 +974,7 @@ static void nsvg__fillActiveEdges(unsigned char* scanline, int len, NSVGactiveEd
 				int x1 = e->x; w += e->dir;
 				// if we went to zero, we need to draw
 				if (w == 0)
-					nsvg__fillScanline(scanline, len, x0, x1, maxWeight, xmin, xmax);
+					nsvg__fillScanline(scanline, len, x0, x1, maxWeight, xmin, xmax, fillSpan);
 			}
 			e = e->next;
 		}
@@ -957,7 +986,7 @@ static void nsvg__fillActiveEdges(unsigned char* scanline, int len, NSVGactiveEd
 				x0 = e->x; w = 1;
 			} else {
 				int x1 = e->x; w = 0;
-				nsvg__fillScanline(scanline, len, x0, x1, maxWeight, xmin, xmax);
+				nsvg__fillScanline(scanline, len, x0, x1, maxWeight, xmin, xmax, fillSpan);
 			}
 			e = e->next;
 		}
@@ -1000,135 +1029,412 @@ static int nsvg__div255(int x)
     return ((x+1) * 257) >> 16;
 }
 
-static void nsvg__scanlineSolid(unsigned char* dst, int count, unsigned char* cover, int x, int y,
-								float tx, float ty, float scale, NSVGcachedPaint* cache)
+// SDL_image change: the span loops are kernels with SSE2, AVX2 and NEON versions.
+// They give the same pixels as the scalar code; the gradient kernels keep its
+// order of floating point operations and step fx one pixel at a time.
+
+#define NSVG__SPAN_CHUNK	64
+
+static void nsvg__fillSpan(unsigned char* scanline, int count, int weight)
 {
+	int i;
+	for (i = 0; i < count; i++)
+		scanline[i] = (unsigned char)(scanline[i] + weight);
+}
 
-	if (cache->type == NSVG_PAINT_COLOR) {
-		int i, cr, cg, cb, ca;
-		cr = cache->colors[0] & 0xff;
-		cg = (cache->colors[0] >> 8) & 0xff;
-		cb = (cache->colors[0] >> 16) & 0xff;
-		ca = (cache->colors[0] >> 24) & 0xff;
-
-		for (i = 0; i < count; i++) {
-			int r,g,b;
-			int a = nsvg__div255((int)cover[0] * ca);
-			int ia = 255 - a;
-			// Premultiply
-			r = nsvg__div255(cr * a);
-			g = nsvg__div255(cg * a);
-			b = nsvg__div255(cb * a);
-
-			// Blend over
-			r += nsvg__div255(ia * (int)dst[0]);
-			g += nsvg__div255(ia * (int)dst[1]);
-			b += nsvg__div255(ia * (int)dst[2]);
-			a += nsvg__div255(ia * (int)dst[3]);
-
-			dst[0] = (unsigned char)r;
-			dst[1] = (unsigned char)g;
-			dst[2] = (unsigned char)b;
-			dst[3] = (unsigned char)a;
-
-			cover++;
-			dst += 4;
+static void nsvg__blendPixel(unsigned char* dst, int cover, unsigned int c)
+{
+	int r,g,b,a,ia;
+	int cr = (c) & 0xff;
+	int cg = (c >> 8) & 0xff;
+	int cb = (c >> 16) & 0xff;
+	int ca = (c >> 24) & 0xff;
+
+	a = nsvg__div255(cover * ca);
+	ia = 255 - a;
+
+	// Premultiply
+	r = nsvg__div255(cr * a);
+	g = nsvg__div255(cg * a);
+	b = nsvg__div255(cb * a);
+
+	// Blend over
+	r += nsvg__div255(ia * (int)dst[0]);
+	g += nsvg__div255(ia * (int)dst[1]);
+	b += nsvg__div255(ia * (int)dst[2]);
+	a += nsvg__div255(ia * (int)dst[3]);
+
+	dst[0] = (unsigned char)r;
+	dst[1] = (unsigned char)g;
+	dst[2] = (unsigned char)b;
+	dst[3] = (unsigned char)a;
+}
+
+static void nsvg__blendSolid(unsigned char* dst, int count, const unsigned char* cover, unsigned int color)
+{
+	int i;
+	for (i = 0; i < count; i++)
+		nsvg__blendPixel(&dst[i*4], cover[i], color);
+}
+
+static void nsvg__blendColors(unsigned char* dst, int count, const unsigned char* cover, const unsigned int* colors)
+{
+	int i;
+	for (i = 0; i < count; i++)
+		nsvg__blendPixel(&dst[i*4], cover[i], colors[i]);
+}
+
+static void nsvg__gradientColors(unsigned int* colors, int count, float* pfx, float fy, float dx, const float* t, const unsigned int* lut, int radial)
+{
+	float fx = *pfx, gx, gy, gd;
+	int i;
+
+	for (i = 0; i < count; i++) {
+		gy = fx*t[1] + fy*t[3] + t[5];
+		if (radial) {
+			gx = fx*t[0] + fy*t[2] + t[4];
+			gd = sqrtf(gx*gx + gy*gy);
+			colors[i] = lut[(int)nsvg__clampf(gd*255.0f, 0, 255.0f)];
+		} else {
+			colors[i] = lut[(int)nsvg__clampf(gy*255.0f, 0, 255.0f)];
 		}
-	} else if (cache->type == NSVG_PAINT_LINEAR_GRADIENT) {
-		// TODO: spread modes.
-		// TODO: plenty of opportunities to optimize.
-		float fx, fy, dx, gy;
-		float* t = cache->xform;
-		int i, cr, cg, cb, ca;
-		unsigned int c;
+		fx += dx;
+	}
+	*pfx = fx;
+}
 
-		fx = ((float)x - tx) / scale;
-		fy = ((float)y - ty) / scale;
-		dx = 1.0f / scale;
+#ifdef SDL_SSE2_INTRINSICS
+// div255() on 16-bit lanes: ((x+1)*257)>>16 == (y + (y>>8)) >> 8 with y = x+1
+static __m128i SDL_TARGETING("sse2") nsvg__div255_sse2(__m128i x)
+{
+	__m128i y = _mm_add_epi16(x, _mm_set1_epi16(1));
+	return _mm_srli_epi16(_mm_add_epi16(y, _mm_srli_epi16(y, 8)), 8);
+}
+
+// Blends two pixels, as 16-bit lanes. The color has 255 in its alpha lane, so premultiplying it yields the coverage alpha there.
+static __m128i SDL_TARGETING("sse2") nsvg__blend2_sse2(__m128i dst, __m128i cover, __m128i color, __m128i ca)
+{
+	__m128i a = nsvg__div255_sse2(_mm_mullo_epi16(cover, ca));
+	__m128i ia = _mm_sub_epi16(_mm_set1_epi16(255), a);
+	return _mm_add_epi16(nsvg__div255_sse2(_mm_mullo_epi16(color, a)), nsvg__div255_sse2(_mm_mullo_epi16(dst, ia)));
+}
+
+// Blends four pixels; color and ca hold pixels 0-1 in lo and 2-3 in hi
+static void SDL_TARGETING("sse2") nsvg__blend4_sse2(unsigned char* dst, const unsigned char* cover, __m128i colorlo, __m128i colorhi, __m128i calo, __m128i cahi)
+{
+	const __m128i zero = _mm_setzero_si128();
+	__m128i c = _mm_cvtsi32_si128((int)((unsigned int)cover[0] | ((unsigned int)cover[1] << 8) | ((unsigned int)cover[2] << 16) | ((unsigned int)cover[3] << 24)));
+	__m128i d = _mm_loadu_si128((const __m128i*)dst);
+	__m128i lo, hi;
+
+	c = _mm_unpacklo_epi16(_mm_unpacklo_epi8(c, zero), zero);
+	c = _mm_or_si128(c, _mm_slli_epi32(c, 16));
+	lo = nsvg__blend2_sse2(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi32(c, c), colorlo, calo);
+	hi = nsvg__blend2_sse2(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi32(c, c), colorhi, cahi);
+	_mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(lo, hi));
+}
+
+static void SDL_TARGETING("sse2") nsvg__fillSpan_sse2(unsigned char* scanline, int count, int weight)
+{
+	const __m128i w = _mm_set1_epi8((char)weight);
+	int i = 0;
+
+	for (; i + 16 <= count; i += 16) {
+		__m128i v = _mm_loadu_si128((const __m128i*)&scanline[i]);
+		_mm_storeu_si128((__m128i*)&scanline[i], _mm_add_epi8(v, w));
+	}
+	nsvg__fillSpan(&scanline[i], count - i, weight);
+}
+
+static void SDL_TARGETING("sse2") nsvg__blendSolid_sse2(unsigned char* dst, int count, const unsigned char* cover, unsigned int color)
+{
+	const __m128i c = _mm_unpacklo_epi8(_mm_set1_epi32((int)(color | 0xff000000u)), _mm_setzero_si128());
+	const __m128i ca = _mm_set1_epi16((short)(color >> 24));
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4)
+		nsvg__blend4_sse2(&dst[i*4], &cover[i], c, c, ca, ca);
+	nsvg__blendSolid(&dst[i*4], count - i, &cover[i], color);
+}
+
+static void SDL_TARGETING("sse2") nsvg__blendColors_sse2(unsigned char* dst, int count, const unsigned char* cover, const unsigned int* colors)
+{
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i opaque = _mm_set1_epi32((int)0xff000000u);
+	int i = 0;
+
+	for (; i + 4 <= count; i += 4) {
+		__m128i c = _mm_loadu_si128((const __m128i*)&colors[i]);
+		__m128i clo = _mm_unpacklo_epi8(c, zero);
+		__m128i chi = _mm_unpackhi_epi8(c, zero);
+		__m128i calo = _mm_shufflehi_epi16(_mm_shufflelo_epi16(clo, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+		__m128i cahi = _mm_shufflehi_epi16(_mm_shufflelo_epi16(chi, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+		c = _mm_or_si128(c, opaque);
+		nsvg__blend4_sse2(&dst[i*4], &cover[i], _mm_unpacklo_epi8(c, zero), _mm_unpackhi_epi8(c, zero), calo, cahi);
+	}
+	nsvg__blendColors(&dst[i*4], count - i, &cover[i], &colors[i]);
+}
+
+static void SDL_TARGETING("sse2") nsvg__gradientColors_sse2(unsigned int* colors, int count, float* pfx, float fy, float dx, const float* t, const unsigned int* lut, int radial)
+{
+	const __m128 t0 = _mm_set1_ps(t[0]), t1 = _mm_set1_ps(t[1]);
+	const __m128 t4 = _mm_set1_ps(t[4]), t5 = _mm_set1_ps(t[5]);
+	const __m128 fyt2 = _mm_set1_ps(fy*t[2]), fyt3 = _mm_set1_ps(fy*t[3]);
+	float fx = *pfx, xs[4];
+	int i = 0, k, idx[4];
+
+	for (; i + 4 <= count; i += 4) {
+		__m128 v, gx, gy, g;
+		for (k = 0; k < 4; k++) {
+			xs[k] = fx;
+			fx += dx;
+		}
+		v = _mm_loadu_ps(xs);
+		gy = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v, t1), fyt3), t5);
+		if (radial) {
+			gx = _mm_add_ps(_mm_add_ps(_mm_mul_ps(v, t0), fyt2), t4);
+			g = _mm_sqrt_ps(_mm_add_ps(_mm_mul_ps(gx, gx), _mm_mul_ps(gy, gy)));
+		} else {
+			g = gy;
+		}
+		// max() returns its second operand for NaN, which clamps NaN to 0 like nsvg__clampf()
+		g = _mm_min_ps(_mm_max_ps(_mm_mul_ps(g, _mm_set1_ps(255.0f)), _mm_setzero_ps()), _mm_set1_ps(255.0f));
+		_mm_storeu_si128((__m128i*)idx, _mm_cvttps_epi32(g));
+		for (k = 0; k < 4; k++)
+			colors[i + k] = lut[idx[k]];
+	}
+	nsvg__gradientColors(&colors[i], count - i, &fx, fy, dx, t, lut, radial);
+	*pfx = fx;
+}
+#endif
+
+#ifdef SDL_AVX2_INTRINSICS
+// The kernels clear the upper halves of the AVX registers before the scalar tails,
+// otherwise the SSE code that runs afterwards is slowed down by the dirty state.
+static __m256i SDL_TARGETING("avx2") nsvg__div255_avx2(__m256i x)
+{
+	__m256i y = _mm256_add_epi16(x, _mm256_set1_epi16(1));
+	return _mm256_srli_epi16(_mm256_add_epi16(y, _mm256_srli_epi16(y, 8)), 8);
+}
+
+static __m256i SDL_TARGETING("avx2") nsvg__blend4_avx2(__m256i dst, __m256i cover, __m256i color, __m256i ca)
+{
+	__m256i a = nsvg__div255_avx2(_mm256_mullo_epi16(cover, ca));
+	__m256i ia = _mm256_sub_epi16(_mm256_set1_epi16(255), a);
+	return _mm256_add_epi16(nsvg__div255_avx2(_mm256_mullo_epi16(color, a)), nsvg__div255_avx2(_mm256_mullo_epi16(dst, ia)));
+}
+
+// Blends eight pixels. The unpacks work within 128-bit lanes, so lo holds pixels 0-1 and 4-5,
+// hi holds 2-3 and 6-7, and the final pack puts them back in order.
+static void SDL_TARGETING("avx2") nsvg__blend8_avx2(unsigned char* dst, const unsigned char* cover, __m256i colorlo, __m256i colorhi, __m256i calo, __m256i cahi)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i c = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)cover));
+	__m256i d = _mm256_loadu_si256((const __m256i*)dst);
+	__m256i lo, hi;
+
+	c = _mm256_or_si256(c, _mm256_slli_epi32(c, 16));
+	lo = nsvg__blend4_avx2(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi32(c, c), colorlo, calo);
+	hi = nsvg__blend4_avx2(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi32(c, c), colorhi, cahi);
+	_mm256_storeu_si256((__m256i*)dst, _mm256_packus_epi16(lo, hi));
+}
+
+static void SDL_TARGETING("avx2") nsvg__fillSpan_avx2(unsigned char* scanline, int count, int weight)
+{
+	const __m256i w = _mm256_set1_epi8((char)weight);
+	int i = 0;
+
+	for (; i + 32 <= count; i += 32) {
+		__m256i v = _mm256_loadu_si256((const __m256i*)&scanline[i]);
+		_mm256_storeu_si256((__m256i*)&scanline[i], _mm256_add_epi8(v, w));
+	}
+	_mm256_zeroupper();
+	nsvg__fillSpan(&scanline[i], count - i, weight);
+}
+
+static void SDL_TARGETING("avx2") nsvg__blendSolid_avx2(unsigned char* dst, int count, const unsigned char* cover, unsigned int color)
+{
+	const __m256i c = _mm256_unpacklo_epi8(_mm256_set1_epi32((int)(color | 0xff000000u)), _mm256_setzero_si256());
+	const __m256i ca = _mm256_set1_epi16((short)(color >> 24));
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8)
+		nsvg__blend8_avx2(&dst[i*4], &cover[i], c, c, ca, ca);
+	_mm256_zeroupper();
+	nsvg__blendSolid(&dst[i*4], count - i, &cover[i], color);
+}
 
-		for (i = 0; i < count; i++) {
-			int r,g,b,a,ia;
-			gy = fx*t[1] + fy*t[3] + t[5];
-			c = cache->colors[(int)nsvg__clampf(gy*255.0f, 0, 255.0f)];
-			cr = (c) & 0xff;
-			cg = (c >> 8) & 0xff;
-			cb = (c >> 16) & 0xff;
-			ca = (c >> 24) & 0xff;
-
-			a = nsvg__div255((int)cover[0] * ca);
-			ia = 255 - a;
-
-			// Premultiply
-			r = nsvg__div255(cr * a);
-			g = nsvg__div255(cg * a);
-			b = nsvg__div255(cb * a);
-
-			// Blend over
-			r += nsvg__div255(ia * (int)dst[0]);
-			g += nsvg__div255(ia * (int)dst[1]);
-			b += nsvg__div255(ia * (int)dst[2]);
-			a += nsvg__div255(ia * (int)dst[3]);
-
-			dst[0] = (unsigned char)r;
-			dst[1] = (unsigned char)g;
-			dst[2] = (unsigned char)b;
-			dst[3] = (unsigned char)a;
-
-			cover++;
-			dst += 4;
+static void SDL_TARGETING("avx2") nsvg__blendColors_avx2(unsigned char* dst, int count, const unsigned char* cover, const unsigned int* colors)
+{
+	const __m256i zero = _mm256_setzero_si256();
+	const __m256i opaque = _mm256_set1_epi32((int)0xff000000u);
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8) {
+		__m256i c = _mm256_loadu_si256((const __m256i*)&colors[i]);
+		__m256i clo = _mm256_unpacklo_epi8(c, zero);
+		__m256i chi = _mm256_unpackhi_epi8(c, zero);
+		__m256i calo = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(clo, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+		__m256i cahi = _mm256_shufflehi_epi16(_mm256_shufflelo_epi16(chi, _MM_SHUFFLE(3,3,3,3)), _MM_SHUFFLE(3,3,3,3));
+		c = _mm256_or_si256(c, opaque);
+		nsvg__blend8_avx2(&dst[i*4], &cover[i], _mm256_unpacklo_epi8(c, zero), _mm256_unpackhi_epi8(c, zero), calo, cahi);
+	}
+	_mm256_zeroupper();
+	nsvg__blendColors(&dst[i*4], count - i, &cover[i], &colors[i]);
+}
+
+static void SDL_TARGETING("avx2") nsvg__gradientColors_avx2(unsigned int* colors, int count, float* pfx, float fy, float dx, const float* t, const unsigned int* lut, int radial)
+{
+	const __m256 t0 = _mm256_set1_ps(t[0]), t1 = _mm256_set1_ps(t[1]);
+	const __m256 t4 = _mm256_set1_ps(t[4]), t5 = _mm256_set1_ps(t[5]);
+	const __m256 fyt2 = _mm256_set1_ps(fy*t[2]), fyt3 = _mm256_set1_ps(fy*t[3]);
+	float fx = *pfx, xs[8];
+	int i = 0, k;
+
+	for (; i + 8 <= count; i += 8) {
+		__m256 v, gx, gy, g;
+		for (k = 0; k < 8; k++) {
+			xs[k] = fx;
 			fx += dx;
 		}
-	} else if (cache->type == NSVG_PAINT_RADIAL_GRADIENT) {
+		v = _mm256_loadu_ps(xs);
+		gy = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(v, t1), fyt3), t5);
+		if (radial) {
+			gx = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(v, t0), fyt2), t4);
+			g = _mm256_sqrt_ps(_mm256_add_ps(_mm256_mul_ps(gx, gx), _mm256_mul_ps(gy, gy)));
+		} else {
+			g = gy;
+		}
+		g = _mm256_min_ps(_mm256_max_ps(_mm256_mul_ps(g, _mm256_set1_ps(255.0f)), _mm256_setzero_ps()), _mm256_set1_ps(255.0f));
+		_mm256_storeu_si256((__m256i*)&colors[i], _mm256_i32gather_epi32((const int*)lut, _mm256_cvttps_epi32(g), 4));
+	}
+	_mm256_zeroupper();
+	nsvg__gradientColors(&colors[i], count - i, &fx, fy, dx, t, lut, radial);
+	*pfx = fx;
+}
+#endif
+
+#ifdef SDL_NEON_INTRINSICS
+static uint8x8_t nsvg__div255_neon(uint16x8_t x)
+{
+	uint16x8_t y = vaddq_u16(x, vdupq_n_u16(1));
+	return vshrn_n_u16(vaddq_u16(y, vshrq_n_u16(y, 8)), 8);
+}
+
+// Blends eight pixels, split into planes
+static void nsvg__blend8_neon(unsigned char* dst, const unsigned char* cover, uint8x8x4_t c)
+{
+	uint8x8x4_t d = vld4_u8(dst);
+	uint8x8_t a = nsvg__div255_neon(vmull_u8(vld1_u8(cover), c.val[3]));
+	uint8x8_t ia = vmvn_u8(a);
+	int k;
+
+	for (k = 0; k < 3; k++)
+		d.val[k] = vadd_u8(nsvg__div255_neon(vmull_u8(c.val[k], a)), nsvg__div255_neon(vmull_u8(d.val[k], ia)));
+	d.val[3] = vadd_u8(a, nsvg__div255_neon(vmull_u8(d.val[3], ia)));
+	vst4_u8(dst, d);
+}
+
+static void nsvg__fillSpan_neon(unsigned char* scanline, int count, int weight)
+{
+	const uint8x16_t w = vdupq_n_u8((uint8_t)weight);
+	int i = 0;
+
+	for (; i + 16 <= count; i += 16)
+		vst1q_u8(&scanline[i], vaddq_u8(vld1q_u8(&scanline[i]), w));
+	nsvg__fillSpan(&scanline[i], count - i, weight);
+}
+
+static void nsvg__blendSolid_neon(unsigned char* dst, int count, const unsigned char* cover, unsigned int color)
+{
+	uint8x8x4_t c;
+	int i = 0;
+
+	c.val[0] = vdup_n_u8((uint8_t)(color & 0xff));
+	c.val[1] = vdup_n_u8((uint8_t)((color >> 8) & 0xff));
+	c.val[2] = vdup_n_u8((uint8_t)((color >> 16) & 0xff));
+	c.val[3] = vdup_n_u8((uint8_t)((color >> 24) & 0xff));
+	for (; i + 8 <= count; i += 8)
+		nsvg__blend8_neon(&dst[i*4], &cover[i], c);
+	nsvg__blendSolid(&dst[i*4], count - i, &cover[i], color);
+}
+
+static void nsvg__blendColors_neon(unsigned char* dst, int count, const unsigned char* cover, const unsigned int* colors)
+{
+	int i = 0;
+
+	for (; i + 8 <= count; i += 8)
+		nsvg__blend8_neon(&dst[i*4], &cover[i], vld4_u8((const uint8_t*)&colors[i]));
+	nsvg__blendColors(&dst[i*4], count - i, &cover[i], &colors[i]);
+}
+#endif
+
+static void nsvg__initKernels(NSVGrasterizer* r)
+{
+	r->fillSpan = nsvg__fillSpan;
+	r->blendSolid = nsvg__blendSolid;
+	r->blendColors = nsvg__blendColors;
+	r->gradientColors = nsvg__gradientColors;
+
+	// SDL_image change: use the fastest kernels this CPU supports
+#ifdef SDL_AVX2_INTRINSICS
+	if (SDL_HasAVX2()) {
+		r->fillSpan = nsvg__fillSpan_avx2;
+		r->blendSolid = nsvg__blendSolid_avx2;
+		r->blendColors = nsvg__blendColors_avx2;
+		r->gradientColors = nsvg__gradientColors_avx2;
+	} else
+#endif
+#ifdef SDL_SSE2_INTRINSICS
+	if (SDL_HasSSE2()) {
+		r->fillSpan = nsvg__fillSpan_sse2;
+		r->blendSolid = nsvg__blendSolid_sse2;
+		r->blendColors = nsvg__blendColors_sse2;
+		r->gradientColors = nsvg__gradientColors_sse2;
+	} else
+#endif
+#ifdef SDL_NEON_INTRINSICS
+	if (SDL_HasNEON()) {
+		// The gradients stay scalar, since the compiler may fuse their multiply-adds on ARM
+		r->fillSpan = nsvg__fillSpan_neon;
+		r->blendSolid = nsvg__blendSolid_neon;
+		r->blendColors = nsvg__blendColors_neon;
+	} else
+#endif
+	{
+		// Scalar code
+	}
+}
+
+static void nsvg__scanlineSolid(NSVGrasterizer* r, unsigned char* dst, int count, unsigned char* cover, int x, int y,
+								float tx, float ty, float scale, NSVGcachedPaint* cache)
+{
+
+	if (cache->type == NSVG_PAINT_COLOR) {
+		r->blendSolid(dst, count, cover, cache->colors[0]);
+	} else if (cache->type == NSVG_PAINT_LINEAR_GRADIENT || cache->type == NSVG_PAINT_RADIAL_GRADIENT) {
 		// TODO: spread modes.
-		// TODO: plenty of opportunities to optimize.
 		// TODO: focus (fx,fy)
-		float fx, fy, dx, gx, gy, gd;
-		float* t = cache->xform;
-		int i, cr, cg, cb, ca;
-		unsigned int c;
+		unsigned int colors[NSVG__SPAN_CHUNK];
+		float fx, fy, dx;
+		int radial = (cache->type == NSVG_PAINT_RADIAL_GRADIENT);
 
 		fx = ((float)x - tx) / scale;
 		fy = ((float)y - ty) / scale;
 		dx = 1.0f / scale;
 
-		for (i = 0; i < count; i++) {
-			int r,g,b,a,ia;
-			gx = fx*t[0] + fy*t[2] + t[4];
-			gy = fx*t[1] + fy*t[3] + t[5];
-			gd = sqrtf(gx*gx + gy*gy);
-			c = cache->colors[(int)nsvg__clampf(gd*255.0f, 0, 255.0f)];
-			cr = (c) & 0xff;
-			cg = (c >> 8) & 0xff;
-			cb = (c >> 16) & 0xff;
-			ca = (c >> 24) & 0xff;
-
-			a = nsvg__div255((int)cover[0] * ca);
-			ia = 255 - a;
-
-			// Premultiply
-			r = nsvg__div255(cr * a);
-			g = nsvg__div255(cg * a);
-			b = nsvg__div255(cb * a);
-
-			// Blend over
-			r += nsvg__div255(ia * (int)dst[0]);
-			g += nsvg__div255(ia * (int)dst[1]);
-			b += nsvg__div255(ia * (int)dst[2]);
-			a += nsvg__div255(ia * (int)dst[3]);
-
-			dst[0] = (unsigned char)r;
-			dst[1] = (unsigned char)g;
-			dst[2] = (unsigned char)b;
-			dst[3] = (unsigned char)a;
-
-			cover++;
-			dst += 4;
-			fx += dx;
+		while (count > 0) {
+			int n = count < NSVG__SPAN_CHUNK ? count : NSVG__SPAN_CHUNK;
+			r->gradientColors(colors, n, &fx, fy, dx, cache->xform, cache->colors, radial);
+			r->blendColors(dst, n, cover, colors);
+			dst += n*4;
+			cover += n;
+			count -= n;
 		}
 	}
 }
 
-static void nsvg__rasterizeSortedEdges(NSVGrasterizer *r, float tx, float ty, float scale, NSVGcachedPaint* cache, char fillRule)
+static void nsvg__rasterizeSortedEdges(NSVGrasterizer *r, float tx, float ty, float scale, NSVGcachedPaint* cache, char fillRule, int ystart, int yend)
 {
 	NSVGactiveEdge *active = NULL;
 	int y, s;
@@ -1136,8 +1442,17 @@ static void nsvg__rasterizeSortedEdges(NSVGrasterizer *r, float tx, float ty, fl
 	int maxWeight = (255 / NSVG__SUBSAMPLES);  // weight per vertical scanline
 	int xmin, xmax;
 
-	for (y = 0; y < r->height; y++) {
-		memset(r->scanline, 0, r->width);
+	for (y = 0; y < yend; y++) {
+		if (active == NULL) {
+			// Nothing covers the rows until the next edge starts, so skip ahead to it
+			float next;
+			if (e >= r->nedges) break;
+			next = r->edges[e].y0 / NSVG__SUBSAMPLES - 1;
+			if (!(next < (float)yend)) break;
+			if (next > (float)y) y = (int)next;
+		}
+		if (y >= ystart)
+			memset(r->scanline, 0, r->width);
 		xmin = r->width;
 		xmax = 0;
 		for (s = 0; s < NSVG__SUBSAMPLES; ++s) {
@@ -1203,25 +1518,26 @@ static void nsvg__rasterizeSortedEdges(NSVGrasterizer *r, float tx, float ty, fl
 			}
 
 			// now process all active edges in non-zero fashion
-			if (active != NULL)
-				nsvg__fillActiveEdges(r->scanline, r->width, active, maxWeight, &xmin, &xmax, fillRule);
+			// Rows above the band only track the active edges, so they are in the same order as a full pass
+			if (active != NULL && y >= ystart)
+				nsvg__fillActiveEdges(r->scanline, r->width, active, maxWeight, &xmin, &xmax, fillRule, r->fillSpan);
 		}
 		// Blit
 		if (xmin < 0) xmin = 0;
 		if (xmax > r->width-1) xmax = r->width-1;
 		if (xmin <= xmax) {
-			nsvg__scanlineSolid(&r->bitmap[y * r->stride] + xmin*4, xmax-xmin+1, &r->scanline[xmin], xmin, y, tx,ty, scale, cache);
+			nsvg__scanlineSolid(r, &r->bitmap[y * r->stride] + xmin*4, xmax-xmin+1, &r->scanline[xmin], xmin, y, tx,ty, scale, cache);
 		}
 	}
 
 }
 
-static void nsvg__unpremultiplyAlpha(unsigned char* image, int w, int h, int stride)
+static void nsvg__unpremultiplyAlpha(unsigned char* image, int w, int stride, int y0, int y1)
 {
 	int x,y;
 
 	// Unpremultiply
-	for (y = 0; y < h; y++) {
+	for (y = y0; y < y1; y++) {
 		unsigned char *row = &image[y*stride];
 		for (x = 0; x < w; x++) {
 			int r = row[0], g = row[1], b = row[2], a = row[3];
@@ -1233,9 +1549,14 @@ static void nsvg__unpremultiplyAlpha(unsigned char* image, int w, int h, int str
 			row += 4;
 		}
 	}
+}
 
-	// Defringe
-	for (y = 0; y < h; y++) {
+// Defringing only changes transparent pixels and only reads opaque ones, so rows can be done in any order
+static void nsvg__defringe(unsigned char* image, int w, int h, int stride, int y0, int y1)
+{
+	int x,y;
+
+	for (y = y0; y < y1; y++) {
 		unsigned char *row = &image[y*stride];
 		for (x = 0; x < w; x++) {
 			int r = 0, g = 0, b = 0, a = row[3], n = 0;
@@ -1379,15 +1700,30 @@ static void dumpEdges(NSVGrasterizer* r, const char* name)
 }
 */
 
-NSVG_EXPORT void nsvgRasterize(NSVGrasterizer* r,
+// SDL_image change: shapes that can't touch rows y0 to y1-1 are skipped before
+// their edges are built. pad is how far, in pixels, the shape may reach past its
+// bounds; NaN bounds never compare as outside, so those shapes are kept.
+static int nsvg__isShapeCulled(NSVGshape* shape, float pad, float tx, float ty, float scale, int w, int y0, int y1)
+{
+	return (shape->bounds[2]*scale + tx + pad < 0.0f ||
+			shape->bounds[0]*scale + tx - pad > (float)w ||
+			shape->bounds[3]*scale + ty + pad < (float)y0 ||
+			shape->bounds[1]*scale + ty - pad > (float)y1);
+}
+
+NSVG_EXPORT void nsvgRasterizeRows(NSVGrasterizer* r,
 				   NSVGimage* image, float tx, float ty, float scale,
-				   unsigned char* dst, int w, int h, int stride)
+				   unsigned char* dst, int w, int h, int stride, int y0, int y1)
 {
 	NSVGshape *shape = NULL;
 	NSVGedge *e = NULL;
 	NSVGcachedPaint cache;
 	int i;
 
+	if (y0 < 0) y0 = 0;
+	if (y1 > h) y1 = h;
+	if (y0 >= y1) return;
+
 	r->bitmap = dst;
 	r->width = w;
 	r->height = h;
@@ -1399,14 +1735,15 @@ NSVG_EXPORT void nsvgRasterize(NSVGrasterizer* r,
 		if (r->scanline == NULL) return;
 	}
 
-	for (i = 0; i < h; i++)
+	for (i = y0; i < y1; i++)
 		memset(&dst[i*stride], 0, w*4);
 
 	for (shape = image->shapes; shape != NULL; shape = shape->next) {
 		if (!(shape->flags & NSVG_FLAGS_VISIBLE))
 			continue;
 
-		if (shape->fill.type != NSVG_PAINT_NONE) {
+		// Antialiasing reaches into the next pixel
+		if (shape->fill.type != NSVG_PAINT_NONE && !nsvg__isShapeCulled(shape, 2.0f, tx, ty, scale, w, y0, y1)) {
 			nsvg__resetPool(r);
 			r->freelist = NULL;
 			r->nedges = 0;
@@ -1429,9 +1766,11 @@ NSVG_EXPORT void nsvgRasterize(NSVGrasterizer* r,
 			// now, traverse the scanlines and find the intersections on each scanline, use non-zero rule
 			nsvg__initPaint(&cache, &shape->fill, shape->opacity);
 
-			nsvg__rasterizeSortedEdges(r, tx,ty,scale, &cache, shape->fillRule);
+			nsvg__rasterizeSortedEdges(r, tx,ty,scale, &cache, shape->fillRule, y0, y1);
 		}
-		if (shape->stroke.type != NSVG_PAINT_NONE && (shape->strokeWidth * scale) > 0.01f) {
+		// Joins are extruded at most about 24.5 half widths, the limit set in nsvg__prepareStroke()
+		if (shape->stroke.type != NSVG_PAINT_NONE && (shape->strokeWidth * scale) > 0.01f &&
+			!nsvg__isShapeCulled(shape, shape->strokeWidth * scale * 12.5f + 2.0f, tx, ty, scale, w, y0, y1)) {
 			nsvg__resetPool(r);
 			r->freelist = NULL;
 			r->nedges = 0;
@@ -1456,11 +1795,11 @@ NSVG_EXPORT void nsvgRasterize(NSVGrasterizer* r,
 			// now, traverse the scanlines and find the intersections on each scanline, use non-zero rule
 			nsvg__initPaint(&cache, &shape->stroke, shape->opacity);
 
-			nsvg__rasterizeSortedEdges(r, tx,ty,scale, &cache, NSVG_FILLRULE_NONZERO);
+			nsvg__rasterizeSortedEdges(r, tx,ty,scale, &cache, NSVG_FILLRULE_NONZERO, y0, y1);
 		}
 	}
 
-	nsvg__unpremultiplyAlpha(dst, w, h, stride);
+	nsvg__unpremultiplyAlpha(dst, w, stride, y0, y1);
 
 	r->bitmap = NULL;
 	r->width = 0;
@@ -1468,6 +1807,21 @@ NSVG_EXPORT void nsvgRasterize(NSVGrasterizer* r,
 	r->stride = 0;
 }
 
+NSVG_EXPORT void nsvgDefringeRows(unsigned char* dst, int w, int h, int stride, int y0, int y1)
+{
+	if (y0 < 0) y0 = 0;
+	if (y1 > h) y1 = h;
+	nsvg__defringe(dst, w, h, stride, y0, y1);
+}
+
+NSVG_EXPORT void nsvgRasterize(NSVGrasterizer* r,
+				   NSVGimage* image, float tx, float ty, float scale,
+				   unsigned char* dst, int w, int h, int stride)
+{
+	nsvgRasterizeRows(r, image, tx, ty, scale, dst, w, h, stride, 0, h);
+	nsvgDefringeRows(dst, w, h, stride, 0, h);
+}
+
 #endif // NANOSVGRAST_IMPLEMENTATION
 
 #endif // NANOSVGRAST_H
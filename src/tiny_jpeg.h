@@ -155,6 +155,24 @@ int tje_encode_with_func(tje_write_func* func,
                          const unsigned char* src_data,
                          const int pitch);
 
+// - tje_encode_with_func_ex - (SDL_image change)
+//
+// Usage
+//  Same as tje_encode_with_func, but `quality` goes from 1 (lowest) to 100
+//  (highest) and scales the example quantization tables of the JPEG spec the
+//  way libjpeg does. `rgb_offsets` are the byte offsets of the red, green and
+//  blue channels in each pixel of `num_components` (3 or 4) bytes.
+
+int tje_encode_with_func_ex(tje_write_func* func,
+                            void* context,
+                            const int quality,
+                            const int width,
+                            const int height,
+                            const int num_components,
+                            const int rgb_offsets[3],
+                            const unsigned char* src_data,
+                            const int pitch);
+
 #endif // TJE_HEADER_GUARD
 
 
@@ -277,8 +295,6 @@ static const uint8_t tjei_default_qt_luma_from_spec[] =
    72,92,95,98,112,100,103, 99,
 };
 
-// Unused
-#if 0
 static const uint8_t tjei_default_qt_chroma_from_spec[] =
 {
     // K.1 - suggested chrominance QT
@@ -291,7 +307,6 @@ static const uint8_t tjei_default_qt_chroma_from_spec[] =
    99,99,99,99,99,99,99,99,
    99,99,99,99,99,99,99,99,
 };
-#endif
 
 static const uint8_t tjei_default_qt_chroma_from_paper[] =
 {
@@ -634,11 +649,19 @@ TJEI_FORCE_INLINE void tjei_write_bits(TJEState* state,
         // Grab the most significant byte.
         uint8_t c = (uint8_t)((*bitbuffer) >> 24);
         // Write it to file.
-        tjei_write(state, &c, 1, 1);
-        if ( c == 0xff )  {
-            // Special case: tell JPEG this is not a marker.
-            char z = 0;
-            tjei_write(state, &z, 1, 1);
+        if ( state->output_buffer_count + 2 < TJEI_BUFFER_SIZE - 1 ) {
+            // SDL_image change: append directly while there is room for a stuffed byte
+            state->output_buffer[state->output_buffer_count++] = c;
+            if ( c == 0xff ) {
+                state->output_buffer[state->output_buffer_count++] = 0;
+            }
+        } else {
+            tjei_write(state, &c, 1, 1);
+            if ( c == 0xff )  {
+                // Special case: tell JPEG this is not a marker.
+                char z = 0;
+                tjei_write(state, &z, 1, 1);
+            }
         }
         // Pop the stack.
         *bitbuffer <<= 8;
@@ -791,37 +814,28 @@ static float slow_fdct(int u, int v, float* data)
 
 #define ABS(x) ((x) < 0 ? -(x) : (x))
 
-static void tjei_encode_and_write_MCU(TJEState* state,
-                                      float* mcu,
-#if TJE_USE_FAST_DCT
-                                      float* qt,  // Pre-processed quantization matrix.
-#else
-                                      uint8_t* qt,
-#endif
-                                      uint8_t* huff_dc_len, uint16_t* huff_dc_code, // Huffman tables
-                                      uint8_t* huff_ac_len, uint16_t* huff_ac_code,
-                                      int* pred,  // Previous DC coefficient
-                                      uint32_t* bitbuffer,  // Bitstack.
-                                      uint32_t* location)
-{
-    int du[64];  // Data unit in zig-zag order
+// SDL_image change: the DCT and the color conversion are split out of
+// tjei_encode_and_write_MCU so that they can have SIMD versions.
 
-    float dct_mcu[64];
+// DCT and quantize one 8x8 block, leaving the result in zig-zag order.
+typedef void tjei_fdct_quantize_func(float* mcu, const float* qt, int* du);
+
+// Convert a full 8x8 block of pixels to level shifted Y, Cb and Cr.
+typedef void tjei_rgb_to_ycbcr_func(const uint8_t* src, int pitch, int bpp, const int* rgb,
+                                    float* du_y, float* du_b, float* du_r);
+
+static void tjei_fdct_quantize(float* mcu, const float* qt, int* du)
+{
     int i;
 #if !TJE_USE_FAST_DCT
     int u, v;
+    float dct_mcu[64];
 #endif
 
-    int last_non_zero_i;
-    int diff;
-    uint16_t vli[2];
-
-    memcpy(dct_mcu, mcu, 64 * sizeof(float));
-
 #if TJE_USE_FAST_DCT
-    tjei_fdct(dct_mcu);
+    tjei_fdct(mcu);
     for ( i = 0; i < 64; ++i ) {
-        float fval = dct_mcu[i];
+        float fval = mcu[i];
         int val;
         fval *= qt[i];
 #if 0
@@ -840,11 +854,349 @@ static void tjei_encode_and_write_MCU(TJEState* state,
         }
     }
     for ( i = 0; i < 64; ++i ) {
-        float fval = dct_mcu[i] / (qt[i]);
+        float fval = dct_mcu[i] * qt[i];
         int val = (int)((fval > 0) ? floorf(fval + 0.5f) : ceilf(fval - 0.5f));
         du[tjei_zig_zag[i]] = val;
     }
 #endif
+}
+
+TJEI_FORCE_INLINE void tjei_rgb_to_ycbcr(uint8_t r, uint8_t g, uint8_t b, float* luma, float* cb, float* cr)
+{
+    *luma = 0.299f   * r + 0.587f    * g + 0.114f    * b - 128;
+    *cb   = -0.1687f * r - 0.3313f   * g + 0.5f      * b;
+    *cr   = 0.5f     * r - 0.4187f   * g - 0.0813f   * b;
+}
+
+static void tjei_rgb_to_ycbcr_block(const uint8_t* src, int pitch, int bpp, const int* rgb,
+                                    float* du_y, float* du_b, float* du_r)
+{
+    int off_x, off_y;
+    for ( off_y = 0; off_y < 8; ++off_y ) {
+        const uint8_t* p = src + off_y * pitch;
+        for ( off_x = 0; off_x < 8; ++off_x, p += bpp ) {
+            int block_index = (off_y * 8 + off_x);
+            tjei_rgb_to_ycbcr(p[rgb[0]], p[rgb[1]], p[rgb[2]],
+                              &du_y[block_index], &du_b[block_index], &du_r[block_index]);
+        }
+    }
+}
+
+#if TJE_USE_FAST_DCT
+// One pass of the AA&N DCT above, over eight vectors of rows or columns.
+#define TJEI_FDCT_PASS(T, v, ADD, SUB, MUL, SET1) do {                  \
+    T tmp0 = ADD(v[0], v[7]), tmp7 = SUB(v[0], v[7]);                   \
+    T tmp1 = ADD(v[1], v[6]), tmp6 = SUB(v[1], v[6]);                   \
+    T tmp2 = ADD(v[2], v[5]), tmp5 = SUB(v[2], v[5]);                   \
+    T tmp3 = ADD(v[3], v[4]), tmp4 = SUB(v[3], v[4]);                   \
+    T tmp10 = ADD(tmp0, tmp3), tmp13 = SUB(tmp0, tmp3);                 \
+    T tmp11 = ADD(tmp1, tmp2), tmp12 = SUB(tmp1, tmp2);                 \
+    T z1, z2, z3, z4, z5, z11, z13;                                     \
+    v[0] = ADD(tmp10, tmp11);                                           \
+    v[4] = SUB(tmp10, tmp11);                                           \
+    z1 = MUL(ADD(tmp12, tmp13), SET1(0.707106781f));                    \
+    v[2] = ADD(tmp13, z1);                                              \
+    v[6] = SUB(tmp13, z1);                                              \
+    tmp10 = ADD(tmp4, tmp5);                                            \
+    tmp11 = ADD(tmp5, tmp6);                                            \
+    tmp12 = ADD(tmp6, tmp7);                                            \
+    z5 = MUL(SUB(tmp10, tmp12), SET1(0.382683433f));                    \
+    z2 = ADD(MUL(SET1(0.541196100f), tmp10), z5);                       \
+    z4 = ADD(MUL(SET1(1.306562965f), tmp12), z5);                       \
+    z3 = MUL(tmp11, SET1(0.707106781f));                                \
+    z11 = ADD(tmp7, z3);                                                \
+    z13 = SUB(tmp7, z3);                                                \
+    v[5] = ADD(z13, z2);                                                \
+    v[3] = SUB(z13, z2);                                                \
+    v[1] = ADD(z11, z4);                                                \
+    v[7] = SUB(z11, z4);                                                \
+} while (0)
+
+// Luma and chroma weights, in the same order of operations as tjei_rgb_to_ycbcr()
+#define TJEI_RGB_TO_YCBCR(T, r, g, b, luma, cb, cr, ADD, SUB, MUL, SET1) do {                      \
+    luma = SUB(ADD(ADD(MUL(SET1(0.299f), r), MUL(SET1(0.587f), g)), MUL(SET1(0.114f), b)), SET1(128.0f)); \
+    cb = ADD(SUB(MUL(SET1(-0.1687f), r), MUL(SET1(0.3313f), g)), MUL(SET1(0.5f), b));                \
+    cr = SUB(SUB(MUL(SET1(0.5f), r), MUL(SET1(0.4187f), g)), MUL(SET1(0.0813f), b));                 \
+} while (0)
+
+#ifdef SDL_SSE2_INTRINSICS
+static void SDL_TARGETING("sse2") tjei_transpose_sse2(__m128* a, __m128* b, int a_stride, int b_stride)
+{
+    // Transposes the 4x4 block at a[0], a[s], ... into b[0], b[s], ...
+    __m128 r0 = a[0], r1 = a[a_stride], r2 = a[2 * a_stride], r3 = a[3 * a_stride];
+    _MM_TRANSPOSE4_PS(r0, r1, r2, r3);
+    b[0] = r0;
+    b[b_stride] = r1;
+    b[2 * b_stride] = r2;
+    b[3 * b_stride] = r3;
+}
+
+static void SDL_TARGETING("sse2") tjei_fdct_quantize_sse2(float* mcu, const float* qt, int* du)
+{
+    // rows[2 * y + 0] holds columns 0-3 of row y, rows[2 * y + 1] columns 4-7.
+    __m128 rows[16], cols_lo[8], cols_hi[8], lo[8], hi[8];
+    int values[64];
+    int i;
+
+    for ( i = 0; i < 16; ++i ) {
+        rows[i] = _mm_loadu_ps(mcu + i * 4);
+    }
+
+    // Pass 1: process rows, as columns of the transposed block.
+    tjei_transpose_sse2(&rows[0], &cols_lo[0], 2, 1);
+    tjei_transpose_sse2(&rows[1], &cols_lo[4], 2, 1);
+    tjei_transpose_sse2(&rows[8], &cols_hi[0], 2, 1);
+    tjei_transpose_sse2(&rows[9], &cols_hi[4], 2, 1);
+    TJEI_FDCT_PASS(__m128, cols_lo, _mm_add_ps, _mm_sub_ps, _mm_mul_ps, _mm_set1_ps);
+    TJEI_FDCT_PASS(__m128, cols_hi, _mm_add_ps, _mm_sub_ps, _mm_mul_ps, _mm_set1_ps);
+
+    // Pass 2: process columns.
+    tjei_transpose_sse2(&cols_lo[0], &lo[0], 1, 1);
+    tjei_transpose_sse2(&cols_lo[4], &hi[0], 1, 1);
+    tjei_transpose_sse2(&cols_hi[0], &lo[4], 1, 1);
+    tjei_transpose_sse2(&cols_hi[4], &hi[4], 1, 1);
+    TJEI_FDCT_PASS(__m128, lo, _mm_add_ps, _mm_sub_ps, _mm_mul_ps, _mm_set1_ps);
+    TJEI_FDCT_PASS(__m128, hi, _mm_add_ps, _mm_sub_ps, _mm_mul_ps, _mm_set1_ps);
+
+    for ( i = 0; i < 16; ++i ) {
+        __m128 fval = _mm_mul_ps((i & 1) ? hi[i / 2] : lo[i / 2], _mm_loadu_ps(qt + i * 4));
+        __m128i val;
+        fval = _mm_add_ps(_mm_add_ps(fval, _mm_set1_ps(1024.0f)), _mm_set1_ps(0.5f));
+        // floorf(), truncating and then stepping down where that rounded up
+        val = _mm_cvttps_epi32(fval);
+        val = _mm_add_epi32(val, _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(val), fval)));
+        _mm_storeu_si128((__m128i*)(values + i * 4), _mm_sub_epi32(val, _mm_set1_epi32(1024)));
+    }
+    for ( i = 0; i < 64; ++i ) {
+        du[tjei_zig_zag[i]] = values[i];
+    }
+}
+
+static void SDL_TARGETING("sse2") tjei_rgb_to_ycbcr_block_sse2(const uint8_t* src, int pitch, int bpp, const int* rgb,
+                                                               float* du_y, float* du_b, float* du_r)
+{
+    const __m128i mask = _mm_set1_epi32(0xFF);
+    const __m128i shift_r = _mm_cvtsi32_si128(rgb[0] * 8);
+    const __m128i shift_g = _mm_cvtsi32_si128(rgb[1] * 8);
+    const __m128i shift_b = _mm_cvtsi32_si128(rgb[2] * 8);
+    int i;
+
+    for ( i = 0; i < 16; ++i ) {
+        const uint8_t* p = src + (i / 2) * pitch + (i & 1) * 4 * bpp;
+        __m128 r, g, b, luma, cb, cr;
+
+        if ( bpp == 4 ) {
+            __m128i v = _mm_loadu_si128((const __m128i*)p);
+            r = _mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(v, shift_r), mask));
+            g = _mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(v, shift_g), mask));
+            b = _mm_cvtepi32_ps(_mm_and_si128(_mm_srl_epi32(v, shift_b), mask));
+        } else {
+            r = _mm_cvtepi32_ps(_mm_setr_epi32(p[rgb[0]], p[rgb[0] + 3], p[rgb[0] + 6], p[rgb[0] + 9]));
+            g = _mm_cvtepi32_ps(_mm_setr_epi32(p[rgb[1]], p[rgb[1] + 3], p[rgb[1] + 6], p[rgb[1] + 9]));
+            b = _mm_cvtepi32_ps(_mm_setr_epi32(p[rgb[2]], p[rgb[2] + 3], p[rgb[2] + 6], p[rgb[2] + 9]));
+        }
+        TJEI_RGB_TO_YCBCR(__m128, r, g, b, luma, cb, cr, _mm_add_ps, _mm_sub_ps, _mm_mul_ps, _mm_set1_ps);
+        _mm_storeu_ps(du_y + i * 4, luma);
+        _mm_storeu_ps(du_b + i * 4, cb);
+        _mm_storeu_ps(du_r + i * 4, cr);
+    }
+}
+#endif // SDL_SSE2_INTRINSICS
+
+#ifdef SDL_AVX2_INTRINSICS
+static void SDL_TARGETING("avx2") tjei_transpose_avx2(__m256* v)
+{
+    __m256 t0 = _mm256_unpacklo_ps(v[0], v[1]);
+    __m256 t1 = _mm256_unpackhi_ps(v[0], v[1]);
+    __m256 t2 = _mm256_unpacklo_ps(v[2], v[3]);
+    __m256 t3 = _mm256_unpackhi_ps(v[2], v[3]);
+    __m256 t4 = _mm256_unpacklo_ps(v[4], v[5]);
+    __m256 t5 = _mm256_unpackhi_ps(v[4], v[5]);
+    __m256 t6 = _mm256_unpacklo_ps(v[6], v[7]);
+    __m256 t7 = _mm256_unpackhi_ps(v[6], v[7]);
+    __m256 s0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s4 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s5 = _mm256_shuffle_ps(t4, t6, _MM_SHUFFLE(3, 2, 3, 2));
+    __m256 s6 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(1, 0, 1, 0));
+    __m256 s7 = _mm256_shuffle_ps(t5, t7, _MM_SHUFFLE(3, 2, 3, 2));
+    v[0] = _mm256_permute2f128_ps(s0, s4, 0x20);
+    v[1] = _mm256_permute2f128_ps(s1, s5, 0x20);
+    v[2] = _mm256_permute2f128_ps(s2, s6, 0x20);
+    v[3] = _mm256_permute2f128_ps(s3, s7, 0x20);
+    v[4] = _mm256_permute2f128_ps(s0, s4, 0x31);
+    v[5] = _mm256_permute2f128_ps(s1, s5, 0x31);
+    v[6] = _mm256_permute2f128_ps(s2, s6, 0x31);
+    v[7] = _mm256_permute2f128_ps(s3, s7, 0x31);
+}
+
+static void SDL_TARGETING("avx2") tjei_fdct_quantize_avx2(float* mcu, const float* qt, int* du)
+{
+    __m256 v[8];
+    int values[64];
+    int i;
+
+    for ( i = 0; i < 8; ++i ) {
+        v[i] = _mm256_loadu_ps(mcu + i * 8);
+    }
+    tjei_transpose_avx2(v);
+    TJEI_FDCT_PASS(__m256, v, _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps, _mm256_set1_ps);
+    tjei_transpose_avx2(v);
+    TJEI_FDCT_PASS(__m256, v, _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps, _mm256_set1_ps);
+
+    for ( i = 0; i < 8; ++i ) {
+        __m256 fval = _mm256_mul_ps(v[i], _mm256_loadu_ps(qt + i * 8));
+        fval = _mm256_floor_ps(_mm256_add_ps(_mm256_add_ps(fval, _mm256_set1_ps(1024.0f)), _mm256_set1_ps(0.5f)));
+        _mm256_storeu_si256((__m256i*)(values + i * 8),
+                            _mm256_sub_epi32(_mm256_cvttps_epi32(fval), _mm256_set1_epi32(1024)));
+    }
+    for ( i = 0; i < 64; ++i ) {
+        du[tjei_zig_zag[i]] = values[i];
+    }
+}
+
+static void SDL_TARGETING("avx2") tjei_rgb_to_ycbcr_block_avx2(const uint8_t* src, int pitch, int bpp, const int* rgb,
+                                                               float* du_y, float* du_b, float* du_r)
+{
+    const __m256i mask = _mm256_set1_epi32(0xFF);
+    const __m128i shift_r = _mm_cvtsi32_si128(rgb[0] * 8);
+    const __m128i shift_g = _mm_cvtsi32_si128(rgb[1] * 8);
+    const __m128i shift_b = _mm_cvtsi32_si128(rgb[2] * 8);
+    int i;
+
+    for ( i = 0; i < 8; ++i ) {
+        const uint8_t* p = src + i * pitch;
+        __m256 r, g, b, luma, cb, cr;
+
+        if ( bpp == 4 ) {
+            __m256i v = _mm256_loadu_si256((const __m256i*)p);
+            r = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srl_epi32(v, shift_r), mask));
+            g = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srl_epi32(v, shift_g), mask));
+            b = _mm256_cvtepi32_ps(_mm256_and_si256(_mm256_srl_epi32(v, shift_b), mask));
+        } else {
+            const uint8_t* q = p + rgb[0];
+            r = _mm256_cvtepi32_ps(_mm256_setr_epi32(q[0], q[3], q[6], q[9], q[12], q[15], q[18], q[21]));
+            q = p + rgb[1];
+            g = _mm256_cvtepi32_ps(_mm256_setr_epi32(q[0], q[3], q[6], q[9], q[12], q[15], q[18], q[21]));
+            q = p + rgb[2];
+            b = _mm256_cvtepi32_ps(_mm256_setr_epi32(q[0], q[3], q[6], q[9], q[12], q[15], q[18], q[21]));
+        }
+        TJEI_RGB_TO_YCBCR(__m256, r, g, b, luma, cb, cr, _mm256_add_ps, _mm256_sub_ps, _mm256_mul_ps, _mm256_set1_ps);
+        _mm256_storeu_ps(du_y + i * 8, luma);
+        _mm256_storeu_ps(du_b + i * 8, cb);
+        _mm256_storeu_ps(du_r + i * 8, cr);
+    }
+}
+#endif // SDL_AVX2_INTRINSICS
+
+#ifdef SDL_NEON_INTRINSICS
+static void tjei_transpose_neon(float32x4_t* a, float32x4_t* b, int a_stride, int b_stride)
+{
+    // Transposes the 4x4 block at a[0], a[s], ... into b[0], b[s], ...
+    float32x4x2_t t0 = vtrnq_f32(a[0], a[a_stride]);
+    float32x4x2_t t1 = vtrnq_f32(a[2 * a_stride], a[3 * a_stride]);
+    b[0] = vcombine_f32(vget_low_f32(t0.val[0]), vget_low_f32(t1.val[0]));
+    b[b_stride] = vcombine_f32(vget_low_f32(t0.val[1]), vget_low_f32(t1.val[1]));
+    b[2 * b_stride] = vcombine_f32(vget_high_f32(t0.val[0]), vget_high_f32(t1.val[0]));
+    b[3 * b_stride] = vcombine_f32(vget_high_f32(t0.val[1]), vget_high_f32(t1.val[1]));
+}
+
+static void tjei_fdct_quantize_neon(float* mcu, const float* qt, int* du)
+{
+    // rows[2 * y + 0] holds columns 0-3 of row y, rows[2 * y + 1] columns 4-7.
+    float32x4_t rows[16], cols_lo[8], cols_hi[8], lo[8], hi[8];
+    int values[64];
+    int i;
+
+    for ( i = 0; i < 16; ++i ) {
+        rows[i] = vld1q_f32(mcu + i * 4);
+    }
+
+    // Pass 1: process rows, as columns of the transposed block.
+    tjei_transpose_neon(&rows[0], &cols_lo[0], 2, 1);
+    tjei_transpose_neon(&rows[1], &cols_lo[4], 2, 1);
+    tjei_transpose_neon(&rows[8], &cols_hi[0], 2, 1);
+    tjei_transpose_neon(&rows[9], &cols_hi[4], 2, 1);
+    TJEI_FDCT_PASS(float32x4_t, cols_lo, vaddq_f32, vsubq_f32, vmulq_f32, vdupq_n_f32);
+    TJEI_FDCT_PASS(float32x4_t, cols_hi, vaddq_f32, vsubq_f32, vmulq_f32, vdupq_n_f32);
+
+    // Pass 2: process columns.
+    tjei_transpose_neon(&cols_lo[0], &lo[0], 1, 1);
+    tjei_transpose_neon(&cols_lo[4], &hi[0], 1, 1);
+    tjei_transpose_neon(&cols_hi[0], &lo[4], 1, 1);
+    tjei_transpose_neon(&cols_hi[4], &hi[4], 1, 1);
+    TJEI_FDCT_PASS(float32x4_t, lo, vaddq_f32, vsubq_f32, vmulq_f32, vdupq_n_f32);
+    TJEI_FDCT_PASS(float32x4_t, hi, vaddq_f32, vsubq_f32, vmulq_f32, vdupq_n_f32);
+
+    for ( i = 0; i < 16; ++i ) {
+        float32x4_t fval = vmulq_f32((i & 1) ? hi[i / 2] : lo[i / 2], vld1q_f32(qt + i * 4));
+        int32x4_t val;
+        fval = vaddq_f32(vaddq_f32(fval, vdupq_n_f32(1024.0f)), vdupq_n_f32(0.5f));
+        // floorf(), truncating and then stepping down where that rounded up
+        val = vcvtq_s32_f32(fval);
+        val = vaddq_s32(val, vreinterpretq_s32_u32(vcgtq_f32(vcvtq_f32_s32(val), fval)));
+        vst1q_s32(values + i * 4, vsubq_s32(val, vdupq_n_s32(1024)));
+    }
+    for ( i = 0; i < 64; ++i ) {
+        du[tjei_zig_zag[i]] = values[i];
+    }
+}
+
+static void tjei_rgb_to_ycbcr_block_neon(const uint8_t* src, int pitch, int bpp, const int* rgb,
+                                         float* du_y, float* du_b, float* du_r)
+{
+    int i, half;
+
+    for ( i = 0; i < 8; ++i ) {
+        const uint8_t* p = src + i * pitch;
+        uint16x8_t r16, g16, b16;
+
+        if ( bpp == 4 ) {
+            uint8x8x4_t v = vld4_u8(p);
+            r16 = vmovl_u8(v.val[rgb[0]]);
+            g16 = vmovl_u8(v.val[rgb[1]]);
+            b16 = vmovl_u8(v.val[rgb[2]]);
+        } else {
+            uint8x8x3_t v = vld3_u8(p);
+            r16 = vmovl_u8(v.val[rgb[0]]);
+            g16 = vmovl_u8(v.val[rgb[1]]);
+            b16 = vmovl_u8(v.val[rgb[2]]);
+        }
+        for ( half = 0; half < 2; ++half ) {
+            float32x4_t r, g, b, luma, cb, cr;
+            if ( half == 0 ) {
+                r = vcvtq_f32_u32(vmovl_u16(vget_low_u16(r16)));
+                g = vcvtq_f32_u32(vmovl_u16(vget_low_u16(g16)));
+                b = vcvtq_f32_u32(vmovl_u16(vget_low_u16(b16)));
+            } else {
+                r = vcvtq_f32_u32(vmovl_u16(vget_high_u16(r16)));
+                g = vcvtq_f32_u32(vmovl_u16(vget_high_u16(g16)));
+                b = vcvtq_f32_u32(vmovl_u16(vget_high_u16(b16)));
+            }
+            TJEI_RGB_TO_YCBCR(float32x4_t, r, g, b, luma, cb, cr, vaddq_f32, vsubq_f32, vmulq_f32, vdupq_n_f32);
+            vst1q_f32(du_y + i * 8 + half * 4, luma);
+            vst1q_f32(du_b + i * 8 + half * 4, cb);
+            vst1q_f32(du_r + i * 8 + half * 4, cr);
+        }
+    }
+}
+#endif // SDL_NEON_INTRINSICS
+#endif // TJE_USE_FAST_DCT
+
+static void tjei_encode_and_write_MCU(TJEState* state,
+                                      const int* du,  // Quantized data unit in zig-zag order
+                                      uint8_t* huff_dc_len, uint16_t* huff_dc_code, // Huffman tables
+                                      uint8_t* huff_ac_len, uint16_t* huff_ac_code,
+                                      int* pred,  // Previous DC coefficient
+                                      uint32_t* bitbuffer,  // Bitstack.
+                                      uint32_t* location)
+{
+    int i;
+    int last_non_zero_i;
+    int diff;
+    uint16_t vli[2];
 
     // Encode DC coefficient.
     diff = du[0] - *pred;
@@ -912,13 +1264,11 @@ enum {
     TJEI_CHROMA_AC,
 };
 
-#if TJE_USE_FAST_DCT
 struct TJEProcessedQT
 {
     float chroma[64];
     float luma[64];
 };
-#endif
 
 // Set up huffman tables in state.
 static void tjei_huff_expand(TJEState* state)
@@ -972,6 +1322,7 @@ static int tjei_encode_main(TJEState* state,
                             const int width,
                             const int height,
                             const int src_num_components,
+                            const int* rgb,
                             const int pitch)
 {
 #if TJE_USE_FAST_DCT
@@ -989,12 +1340,16 @@ static int tjei_encode_main(TJEState* state,
         1.0f, 1.387039845f, 1.306562965f, 1.175875602f,
         1.0f, 0.785694958f, 0.541196100f, 0.275899379f
     };
-    struct TJEProcessedQT pqt;
 #endif
+    struct TJEProcessedQT pqt;
+
+    tjei_fdct_quantize_func* fdct_quantize = tjei_fdct_quantize;
+    tjei_rgb_to_ycbcr_func* rgb_to_ycbcr = tjei_rgb_to_ycbcr_block;
 
     float du_y[64];
     float du_b[64];
     float du_r[64];
+    int du[64];
 
     int pred_y;
     int pred_b;
@@ -1024,6 +1379,34 @@ static int tjei_encode_main(TJEState* state,
             pqt.chroma[y*8+x] = 1.0f / (8 * aan_scales[x] * aan_scales[y] * state->qt_chroma[tjei_zig_zag[i]]);
         }
     }
+
+    // SDL_image change: use the fastest kernels this CPU supports
+#ifdef SDL_AVX2_INTRINSICS
+    if (SDL_HasAVX2()) {
+        fdct_quantize = tjei_fdct_quantize_avx2;
+        rgb_to_ycbcr = tjei_rgb_to_ycbcr_block_avx2;
+    } else
+#endif
+#ifdef SDL_SSE2_INTRINSICS
+    if (SDL_HasSSE2()) {
+        fdct_quantize = tjei_fdct_quantize_sse2;
+        rgb_to_ycbcr = tjei_rgb_to_ycbcr_block_sse2;
+    } else
+#endif
+#ifdef SDL_NEON_INTRINSICS
+    if (SDL_HasNEON()) {
+        fdct_quantize = tjei_fdct_quantize_neon;
+        rgb_to_ycbcr = tjei_rgb_to_ycbcr_block_neon;
+    } else
+#endif
+    {
+        // Scalar code
+    }
+#else
+    for ( y = 0; y < 64; ++y ) {
+        pqt.luma[y] = 1.0f / state->qt_luma[tjei_zig_zag[y]];
+        pqt.chroma[y] = 1.0f / state->qt_chroma[tjei_zig_zag[y]];
+    }
 #endif
 
     { // Write header
@@ -1134,78 +1517,50 @@ static int tjei_encode_main(TJEState* state,
 
     for ( y = 0; y < height; y += 8 ) {
         for ( x = 0; x < width; x += 8 ) {
-            // Block loop: ====
-            for ( off_y = 0; off_y < 8; ++off_y ) {
-                for ( off_x = 0; off_x < 8; ++off_x ) {
-                    int block_index = (off_y * 8 + off_x);
-
-                    int src_index = (((y + off_y) * pitch) + ((x + off_x) * src_num_components));
-
-                    int col = x + off_x;
-                    int row = y + off_y;
-
-                    float luma, cb, cr;
-
-                    uint8_t r, g, b;
-
-                    if(row >= height) {
-                        src_index -= (pitch * (row - height + 1));
+            if ( x + 8 <= width && y + 8 <= height ) {
+                rgb_to_ycbcr(src_data + (size_t)y * pitch + (size_t)x * src_num_components, pitch,
+                             src_num_components, rgb, du_y, du_b, du_r);
+            } else {
+                // Partial block at the edge of the image.
+                for ( off_y = 0; off_y < 8; ++off_y ) {
+                    for ( off_x = 0; off_x < 8; ++off_x ) {
+                        int block_index = (off_y * 8 + off_x);
+
+                        // Replicate the last row and column into the padding.
+                        int col = tjei_min(x + off_x, width - 1);
+                        int row = tjei_min(y + off_y, height - 1);
+
+                        const uint8_t* p = src_data + (size_t)row * pitch + (size_t)col * src_num_components;
+
+                        tjei_rgb_to_ycbcr(p[rgb[0]], p[rgb[1]], p[rgb[2]],
+                                          &du_y[block_index], &du_b[block_index], &du_r[block_index]);
                     }
-                    if(col >= width) {
-                        src_index -= (col - width + 1) * src_num_components;
-                    }
-                    assert(src_index < height * pitch);
-
-                    r = src_data[src_index + 0];
-                    g = src_data[src_index + 1];
-                    b = src_data[src_index + 2];
-
-                    luma = 0.299f   * r + 0.587f    * g + 0.114f    * b - 128;
-                    cb   = -0.1687f * r - 0.3313f   * g + 0.5f      * b;
-                    cr   = 0.5f     * r - 0.4187f   * g - 0.0813f   * b;
-
-                    du_y[block_index] = luma;
-                    du_b[block_index] = cb;
-                    du_r[block_index] = cr;
                 }
             }
 
-            tjei_encode_and_write_MCU(state, du_y,
-#if TJE_USE_FAST_DCT
-                                     pqt.luma,
-#else
-                                     state->qt_luma,
-#endif
+            fdct_quantize(du_y, pqt.luma, du);
+            tjei_encode_and_write_MCU(state, du,
                                      state->ehuffsize[TJEI_LUMA_DC], state->ehuffcode[TJEI_LUMA_DC],
                                      state->ehuffsize[TJEI_LUMA_AC], state->ehuffcode[TJEI_LUMA_AC],
                                      &pred_y, &bitbuffer, &location);
-            tjei_encode_and_write_MCU(state, du_b,
-#if TJE_USE_FAST_DCT
-                                     pqt.chroma,
-#else
-                                     state->qt_chroma,
-#endif
+            fdct_quantize(du_b, pqt.chroma, du);
+            tjei_encode_and_write_MCU(state, du,
                                      state->ehuffsize[TJEI_CHROMA_DC], state->ehuffcode[TJEI_CHROMA_DC],
                                      state->ehuffsize[TJEI_CHROMA_AC], state->ehuffcode[TJEI_CHROMA_AC],
                                      &pred_b, &bitbuffer, &location);
-            tjei_encode_and_write_MCU(state, du_r,
-#if TJE_USE_FAST_DCT
-                                     pqt.chroma,
-#else
-                                     state->qt_chroma,
-#endif
+            fdct_quantize(du_r, pqt.chroma, du);
+            tjei_encode_and_write_MCU(state, du,
                                      state->ehuffsize[TJEI_CHROMA_DC], state->ehuffcode[TJEI_CHROMA_DC],
                                      state->ehuffsize[TJEI_CHROMA_AC], state->ehuffcode[TJEI_CHROMA_AC],
                                      &pred_r, &bitbuffer, &location);
-
-
         }
     }
 
     // Finish the image.
     { // Flush
         if (location > 0 && location < 8) {
-            tjei_write_bits(state, &bitbuffer, &location, (uint16_t)(8 - location), 0);
+            /* SDL_image change: pad with 1 bits, as the spec requires before a marker */
+            tjei_write_bits(state, &bitbuffer, &location, (uint16_t)(8 - location), (uint16_t)((1 << (8 - location)) - 1));
         }
     }
     EOI = tjei_be_word(0xffd9);
@@ -1261,6 +1616,29 @@ int tje_encode_to_file_at_quality(const char* dest_path,
 }
 #endif
 
+static int tjei_encode_with_state(TJEState* state,
+                                  tje_write_func* func,
+                                  void* context,
+                                  const int width,
+                                  const int height,
+                                  const int num_components,
+                                  const int* rgb,
+                                  const unsigned char* src_data,
+                                  const int pitch)
+{
+    TJEWriteContext wc;
+
+    memset(&wc, 0, sizeof(wc));
+    wc.context = context;
+    wc.func = func;
+
+    state->write_context = wc;
+
+    tjei_huff_expand(state);
+
+    return tjei_encode_main(state, src_data, width, height, num_components, rgb, pitch);
+}
+
 int tje_encode_with_func(tje_write_func* func,
                          void* context,
                          const int quality,
@@ -1270,8 +1648,8 @@ int tje_encode_with_func(tje_write_func* func,
                          const unsigned char* src_data,
                          const int pitch)
 {
+    static const int rgb[3] = { 0, 1, 2 };
     TJEState state;
-    TJEWriteContext wc;
     uint8_t qt_factor;
     int i;
 
@@ -1282,7 +1660,6 @@ int tje_encode_with_func(tje_write_func* func,
 
     qt_factor = 1;
     memset(&state, 0, sizeof(state));
-    memset(&wc, 0, sizeof(wc));
 
     switch(quality) {
     case 3:
@@ -1311,14 +1688,55 @@ int tje_encode_with_func(tje_write_func* func,
         break;
     }
 
-    wc.context = context;
-    wc.func = func;
+    return tjei_encode_with_state(&state, func, context, width, height, num_components, rgb, src_data, pitch);
+}
+
+// SDL_image change: scale a table from the spec the way libjpeg's jpeg_quality_scaling() does.
+static void tjei_scale_qt(uint8_t* qt, const uint8_t* qt_from_spec, const int quality)
+{
+    int scale = (quality < 50) ? (5000 / quality) : (200 - quality * 2);
+    int i;
+
+    for ( i = 0; i < 64; ++i ) {
+        int value = (qt_from_spec[i] * scale + 50) / 100;
+        if (value < 1) {
+            value = 1;
+        } else if (value > 255) {
+            value = 255;
+        }
+        // The spec tables are in natural order, ours are in zig-zag order.
+        qt[tjei_zig_zag[i]] = (uint8_t)value;
+    }
+}
+
+int tje_encode_with_func_ex(tje_write_func* func,
+                            void* context,
+                            const int quality,
+                            const int width,
+                            const int height,
+                            const int num_components,
+                            const int rgb_offsets[3],
+                            const unsigned char* src_data,
+                            const int pitch)
+{
+    TJEState state;
+    int i;
 
-    state.write_context = wc;
+    if (quality < 1 || quality > 100) {
+        tje_log("[ERROR] -- Valid 'quality' values are 1 (lowest) to 100 (highest)\n");
+        return 0;
+    }
+    for ( i = 0; i < 3; ++i ) {
+        if (rgb_offsets[i] < 0 || rgb_offsets[i] >= num_components) {
+            return 0;
+        }
+    }
 
-    tjei_huff_expand(&state);
+    memset(&state, 0, sizeof(state));
+    tjei_scale_qt(state.qt_luma, tjei_default_qt_luma_from_spec, quality);
+    tjei_scale_qt(state.qt_chroma, tjei_default_qt_chroma_from_spec, quality);
 
-    return tjei_encode_main(&state, src_data, width, height, num_components, pitch);
+    return tjei_encode_with_state(&state, func, context, width, height, num_components, rgb_offsets, src_data, pitch);
 }
 // ============================================================
 #endif // TJE_IMPLEMENTATION
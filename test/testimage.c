@@ -232,6 +232,38 @@ static const Format formats[] =
         IMG_isJPG,
         IMG_LoadJPG_IO,
     },
+    {
+        "JPG-rotated",
+        "sample-rotated.jpg",
+        "sample-rotated.bmp",
+        42,
+        23,
+        100,
+#if (USING_IMAGEIO && defined(JPG_USES_IMAGEIO)) || (defined(LOAD_JPG) && !defined(SDL_IMAGE_USE_WIC_BACKEND))
+        true,
+#else
+        false,
+#endif
+        false,      /* can save */
+        IMG_isJPG,
+        IMG_LoadJPG_IO,
+    },
+    {
+        "JPG-sized",
+        "sample.jpg",
+        "sample-half.bmp",
+        12,
+        21,
+        100,
+#if defined(LOAD_JPG) && !defined(USE_STBIMAGE) && !defined(SDL_IMAGE_USE_WIC_BACKEND) && !(USING_IMAGEIO && defined(JPG_USES_IMAGEIO))
+        true,
+#else
+        false,
+#endif
+        false,      /* can save */
+        IMG_isJPG,
+        IMG_LoadJPG_IO,
+    },
 #if 0 /* Different versions of JXL yield different output images */
     {
         "JXL",
@@ -451,6 +483,22 @@ static const Format formats[] =
         true,
 #else
         false,
+#endif
+        false,      /* can save */
+        IMG_isXCF,
+        IMG_LoadXCF_IO,
+    },
+    {
+        "XCF-zlib",
+        "sample-zlib.xcf",
+        "sample.bmp",
+        23,
+        42,
+        0,              /* lossless */
+#if defined(LOAD_XCF) && defined(USE_STBIMAGE)
+        true,
+#else
+        false,
 #endif
         false,      /* can save */
         IMG_isXCF,
@@ -738,6 +786,15 @@ FormatLoadTest(const Format *format,
         case LOAD_SIZED:
             if (SDL_strcmp(format->name, "SVG-sized") == 0) {
                 surface = IMG_LoadSizedSVG_IO(src, 64, 64);
+            } else if (SDL_strcmp(format->name, "JPG-sized") == 0) {
+                SDL_PropertiesID props = SDL_CreateProperties();
+
+                SDL_SetPointerProperty(props, IMG_PROP_LOAD_IOSTREAM_POINTER, src);
+                SDL_SetNumberProperty(props, IMG_PROP_LOAD_WIDTH_NUMBER, format->w);
+                SDL_SetNumberProperty(props, IMG_PROP_LOAD_HEIGHT_NUMBER, format->h);
+                SDLTest_AssertPass("About to call IMG_LoadWithProperties(<src>, %dx%d)", format->w, format->h);
+                surface = IMG_LoadWithProperties(props);
+                SDL_DestroyProperties(props);
             }
             break;
     }
@@ -927,7 +984,8 @@ FormatTest(const Format *format)
     if (format->canLoad || forced) {
         SDLTest_Log("Testing ability to load format %s", format->name);
 
-        if (SDL_strcmp(format->name, "SVG-sized") == 0) {
+        if (SDL_strcmp(format->name, "SVG-sized") == 0 ||
+            SDL_strcmp(format->name, "JPG-sized") == 0) {
             FormatLoadTest(format, LOAD_SIZED);
         } else {
             FormatLoadTest(format, LOAD_CONVENIENCE);
@@ -979,12 +1037,576 @@ TestFormats(void *arg)
     return TEST_COMPLETED;
 }
 
+#if defined(LOAD_JXL) && defined(SAVE_JXL) && SAVE_JXL
+/* Save the surface losslessly as JXL, load it back and compare it exactly */
+static void
+JXLLosslessRoundTrip(SDL_Surface *reference, SDL_PropertiesID props, const char *how)
+{
+    SDL_IOStream *dyn_io;
+    SDL_Surface *surface = NULL;
+    bool result;
+    int diff;
+
+    dyn_io = SDL_IOFromDynamicMem();
+    if (!SDLTest_AssertCheck(dyn_io != NULL,
+                             "SDL_IOFromDynamicMem() should succeed (%s)",
+                             SDL_GetError())) {
+        return;
+    }
+
+    SDL_ClearError();
+    if (props) {
+        SDL_SetPointerProperty(props, IMG_PROP_SAVE_IOSTREAM_POINTER, dyn_io);
+        SDL_SetStringProperty(props, IMG_PROP_SAVE_TYPE_STRING, "jxl");
+        SDLTest_AssertPass("About to call IMG_SaveWithProperties(%s)", how);
+        result = IMG_SaveWithProperties(reference, props);
+    } else {
+        SDLTest_AssertPass("About to call IMG_SaveJXL_IO(%s)", how);
+        result = IMG_SaveJXL_IO(reference, dyn_io, false, 100);
+    }
+    if (!SDLTest_AssertCheck(result, "Save JXL %s (%s)", how, SDL_GetError())) {
+        goto out;
+    }
+
+    SDL_SeekIO(dyn_io, 0, SDL_IO_SEEK_SET);
+    SDL_ClearError();
+    SDLTest_AssertPass("About to call IMG_LoadJXL_IO(<saved data>)");
+    surface = IMG_LoadJXL_IO(dyn_io);
+    if (!SDLTest_AssertCheck(surface != NULL,
+                             "Load saved JXL %s (%s)", how, SDL_GetError())) {
+        goto out;
+    }
+    if (!ConvertToRgba32(&surface)) {
+        goto out;
+    }
+
+    SDLTest_AssertCheck(surface->w == reference->w && surface->h == reference->h,
+                        "Expected %dx%d px, got %dx%d",
+                        reference->w, reference->h, surface->w, surface->h);
+    diff = SDLTest_CompareSurfaces(surface, reference, 0);
+    SDLTest_AssertCheck(diff == 0,
+                        "Lossless JXL %s should match exactly, %d pixels differed",
+                        how, diff);
+    if (diff != 0 || GetStringBoolean(SDL_getenv("SDL_IMAGE_TEST_DEBUG"), false)) {
+        DumpPixels("saved JXL", surface);
+    }
+
+out:
+    if (surface != NULL) {
+        SDL_DestroySurface(surface);
+    }
+    SDL_CloseIO(dyn_io);
+}
+#endif
+
+/* Lossy JXL output differs between libjxl versions, but lossless output must
+ * decode to exactly the pixels that were saved, so no reference image is needed.
+ */
+static int SDLCALL
+TestJXLLosslessSave(void *arg)
+{
+    SDL_Surface *reference = NULL;
+    SDL_PropertiesID props;
+    char *refFilename;
+    (void)arg;
+
+#if defined(LOAD_JXL) && defined(SAVE_JXL) && SAVE_JXL
+    refFilename = GetTestFilename(TEST_FILE_DIST, "sample.bmp");
+    if (!SDLTest_AssertCheck(refFilename != NULL,
+                             "Building ref filename should succeed (%s)",
+                             SDL_GetError())) {
+        return TEST_ABORTED;
+    }
+    reference = SDL_LoadBMP(refFilename);
+    SDL_free(refFilename);
+    if (!SDLTest_AssertCheck(reference != NULL,
+                             "Loading reference should succeed (%s)",
+                             SDL_GetError())) {
+        return TEST_ABORTED;
+    }
+    if (!ConvertToRgba32(&reference)) {
+        SDL_DestroySurface(reference);
+        return TEST_ABORTED;
+    }
+
+    JXLLosslessRoundTrip(reference, 0, "at quality 100");
+
+    props = SDL_CreateProperties();
+    SDL_SetBooleanProperty(props, IMG_PROP_SAVE_JXL_LOSSLESS_BOOLEAN, true);
+    JXLLosslessRoundTrip(reference, props, "with IMG_PROP_SAVE_JXL_LOSSLESS_BOOLEAN");
+    SDL_DestroyProperties(props);
+
+    props = SDL_CreateProperties();
+    SDL_SetBooleanProperty(props, IMG_PROP_SAVE_JXL_LOSSLESS_BOOLEAN, true);
+    SDL_SetNumberProperty(props, IMG_PROP_SAVE_JXL_EFFORT_NUMBER, 1);
+    JXLLosslessRoundTrip(reference, props, "at effort 1");
+    SDL_DestroyProperties(props);
+
+    SDL_DestroySurface(reference);
+    return TEST_COMPLETED;
+#else
+    (void)reference;
+    (void)props;
+    (void)refFilename;
+    SDLTest_Log("Saving JXL is not supported");
+    return TEST_SKIPPED;
+#endif
+}
+
+/* Feed a WEBP image to the incremental decoder in small chunks, and check
+ * that the result is the same as loading it in one go.
+ */
+static int SDLCALL
+TestWEBPIncremental(void *arg)
+{
+    IMG_WEBPDecoder *decoder = NULL;
+    SDL_Surface *decoded;
+    SDL_Surface *surface = NULL;
+    SDL_IOStream *src;
+    SDL_Surface *reference = NULL;
+    char *filename;
+    Uint8 *data = NULL;
+    size_t size = 0;
+    size_t offset;
+    int rows = 0;
+    int last_rows = 0;
+    bool ok;
+    int result = TEST_ABORTED;
+    (void)arg;
+
+#ifdef LOAD_WEBP
+    filename = GetTestFilename(TEST_FILE_DIST, "sample.webp");
+    if (!SDLTest_AssertCheck(filename != NULL,
+                             "Building filename should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+    data = (Uint8 *)SDL_LoadFile(filename, &size);
+    SDL_free(filename);
+    if (!SDLTest_AssertCheck(data != NULL,
+                             "Reading sample.webp should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+    src = SDL_IOFromConstMem(data, size);
+    reference = IMG_LoadWEBP_IO(src);
+    SDL_CloseIO(src);
+    if (!SDLTest_AssertCheck(reference != NULL,
+                             "IMG_LoadWEBP_IO should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+
+    decoder = IMG_CreateWEBPDecoder();
+    if (!SDLTest_AssertCheck(decoder != NULL,
+                             "IMG_CreateWEBPDecoder should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+
+    /* Not enough data for the header yet, so there's no surface */
+    ok = IMG_AppendWEBPDecoderData(decoder, data, 8);
+    SDLTest_AssertCheck(ok,
+                        "Appending a partial header should succeed (%s)",
+                        SDL_GetError());
+    decoded = IMG_GetWEBPDecoderSurface(decoder, &rows);
+    SDLTest_AssertCheck(decoded == NULL && rows == 0,
+                        "There should be no surface before the header is complete");
+
+    for (offset = 8; offset < size; offset += 64) {
+        ok = IMG_AppendWEBPDecoderData(decoder, data + offset, SDL_min(size - offset, 64));
+        if (!SDLTest_AssertCheck(ok,
+                                 "Appending bytes %u-%u should succeed (%s)",
+                                 (unsigned int)offset, (unsigned int)SDL_min(size, offset + 64),
+                                 SDL_GetError())) {
+            goto done;
+        }
+        decoded = IMG_GetWEBPDecoderSurface(decoder, &rows);
+        if (decoded) {
+            SDLTest_AssertCheck(rows >= last_rows && rows <= decoded->h,
+                                "Decoded rows should grow from %d up to %d, got %d",
+                                last_rows, decoded->h, rows);
+            last_rows = rows;
+        }
+    }
+
+    decoded = IMG_GetWEBPDecoderSurface(decoder, &rows);
+    if (!SDLTest_AssertCheck(decoded != NULL,
+                             "IMG_GetWEBPDecoderSurface should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+    SDLTest_AssertCheck(rows == decoded->h,
+                        "All %d rows should be decoded, got %d",
+                        decoded->h, rows);
+
+    /* The decoder owns its surface, so compare a copy */
+    surface = SDL_DuplicateSurface(decoded);
+    if (!surface || !ConvertToRgba32(&surface) || !ConvertToRgba32(&reference)) {
+        goto done;
+    }
+    SDLTest_AssertCheck(surface->w == reference->w && surface->h == reference->h,
+                        "Size should be %dx%d, got %dx%d",
+                        reference->w, reference->h, surface->w, surface->h);
+    SDLTest_AssertCheck(SDLTest_CompareSurfaces(surface, reference, 0) == 0,
+                        "Incremental decoding should match IMG_LoadWEBP_IO");
+    result = TEST_COMPLETED;
+
+done:
+    SDL_DestroySurface(surface);
+    SDL_DestroySurface(reference);
+    IMG_DestroyWEBPDecoder(decoder);
+    SDL_free(data);
+    return result;
+#else
+    (void)filename;
+    (void)decoder;
+    (void)decoded;
+    (void)surface;
+    (void)src;
+    (void)reference;
+    (void)data;
+    (void)size;
+    (void)offset;
+    (void)rows;
+    (void)last_rows;
+    (void)ok;
+    (void)result;
+    SDLTest_Log("WEBP loading is not supported");
+    return TEST_SKIPPED;
+#endif
+}
+
+/* Load the EXIF thumbnail of a JPEG image, which is smaller than the image itself */
+static int SDLCALL
+TestJPGThumbnail(void *arg)
+{
+    SDL_Surface *image = NULL;
+    SDL_Surface *thumbnail = NULL;
+    SDL_IOStream *src;
+    char *filename;
+    int result = TEST_ABORTED;
+    (void)arg;
+
+#ifdef LOAD_JPG
+    filename = GetTestFilename(TEST_FILE_DIST, "sample-thumbnail.jpg");
+    if (!SDLTest_AssertCheck(filename != NULL,
+                             "Building filename should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+    src = SDL_IOFromFile(filename, "rb");
+    SDL_free(filename);
+    if (!SDLTest_AssertCheck(src != NULL,
+                             "Opening sample-thumbnail.jpg should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+    thumbnail = IMG_LoadJPGThumbnail_IO(src);
+    SDL_SeekIO(src, 0, SDL_IO_SEEK_SET);
+    image = IMG_LoadJPG_IO(src);
+    SDL_CloseIO(src);
+    if (!SDLTest_AssertCheck(thumbnail != NULL,
+                             "IMG_LoadJPGThumbnail_IO should succeed (%s)",
+                             SDL_GetError()) ||
+        !SDLTest_AssertCheck(image != NULL,
+                             "IMG_LoadJPG_IO should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+    SDLTest_AssertCheck(thumbnail->w < image->w && thumbnail->h < image->h,
+                        "Thumbnail should be smaller than the %dx%d image, got %dx%d",
+                        image->w, image->h, thumbnail->w, thumbnail->h);
+
+    /* sample.jpg doesn't have any EXIF data */
+    SDL_DestroySurface(thumbnail);
+    filename = GetTestFilename(TEST_FILE_DIST, "sample.jpg");
+    src = SDL_IOFromFile(filename, "rb");
+    SDL_free(filename);
+    thumbnail = src ? IMG_LoadJPGThumbnail_IO(src) : NULL;
+    SDLTest_AssertCheck(src != NULL && thumbnail == NULL,
+                        "Loading a missing thumbnail should fail");
+    if (src) {
+        SDL_CloseIO(src);
+    }
+
+    SDL_ClearError();
+    SDLTest_AssertCheck(IMG_LoadJPGThumbnail_IO(NULL) == NULL && *SDL_GetError() != '\0',
+                        "Loading a thumbnail from a NULL stream should fail with an error");
+    result = TEST_COMPLETED;
+
+done:
+    SDL_DestroySurface(thumbnail);
+    SDL_DestroySurface(image);
+    return result;
+#else
+    (void)image;
+    (void)thumbnail;
+    (void)src;
+    (void)filename;
+    (void)result;
+    SDLTest_Log("JPG loading is not supported");
+    return TEST_SKIPPED;
+#endif
+}
+
+/* Count the pages of a TIFF image and load them by index */
+static int SDLCALL
+TestTIFPages(void *arg)
+{
+    SDL_IOStream *src = NULL;
+    SDL_Surface *surface;
+    char *filename;
+    Sint64 start;
+    int count;
+    (void)arg;
+
+#if USING_IMAGEIO || defined(SDL_IMAGE_USE_WIC_BACKEND) || defined(LOAD_TIF)
+    filename = GetTestFilename(TEST_FILE_DIST, "sample.tif");
+    if (!SDLTest_AssertCheck(filename != NULL,
+                             "Building filename should succeed (%s)",
+                             SDL_GetError())) {
+        return TEST_ABORTED;
+    }
+    src = SDL_IOFromFile(filename, "rb");
+    SDL_free(filename);
+    if (!SDLTest_AssertCheck(src != NULL,
+                             "Opening sample.tif should succeed (%s)",
+                             SDL_GetError())) {
+        return TEST_ABORTED;
+    }
+    start = SDL_TellIO(src);
+
+    count = IMG_GetTIFPageCount_IO(src);
+    SDLTest_AssertCheck(count == 1,
+                        "sample.tif should have 1 page, got %d (%s)",
+                        count, SDL_GetError());
+    SDLTest_AssertCheck(SDL_TellIO(src) == start,
+                        "Counting pages should leave the stream position unchanged");
+
+    surface = IMG_LoadTIFPage_IO(src, 0);
+    if (SDLTest_AssertCheck(surface != NULL,
+                            "Loading page 0 should succeed (%s)",
+                            SDL_GetError())) {
+        SDLTest_AssertCheck(surface->w == 23 && surface->h == 42,
+                            "Page 0 should be 23x42, got %dx%d",
+                            surface->w, surface->h);
+        SDL_DestroySurface(surface);
+    }
+
+    SDL_SeekIO(src, start, SDL_IO_SEEK_SET);
+    SDL_ClearError();
+    surface = IMG_LoadTIFPage_IO(src, count);
+    SDLTest_AssertCheck(surface == NULL,
+                        "Loading page %d should fail", count);
+    SDLTest_AssertCheck(*SDL_GetError() != '\0',
+                        "Loading page %d should set an error", count);
+    SDL_DestroySurface(surface);
+
+    SDL_CloseIO(src);
+    return TEST_COMPLETED;
+#else
+    (void)src;
+    (void)surface;
+    (void)filename;
+    (void)start;
+    (void)count;
+    SDLTest_Log("TIFF loading is not supported");
+    return TEST_SKIPPED;
+#endif
+}
+
+/* Parse an SVG image once and rasterize it at two sizes */
+static int SDLCALL
+TestSVGDocument(void *arg)
+{
+    IMG_SVGDocument *document = NULL;
+    SDL_Surface *small = NULL;
+    SDL_Surface *large = NULL;
+    SDL_Surface *loaded = NULL;
+    char *filename;
+    float width = 0.0f;
+    float height = 0.0f;
+    int result = TEST_ABORTED;
+    (void)arg;
+
+#ifdef LOAD_SVG
+    filename = GetTestFilename(TEST_FILE_DIST, "svg.svg");
+    if (!SDLTest_AssertCheck(filename != NULL,
+                             "Building filename should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+    document = IMG_LoadSVGDocument_IO(SDL_IOFromFile(filename, "rb"), true);
+    loaded = IMG_LoadSizedSVG_IO(SDL_IOFromFile(filename, "rb"), 64, 64);
+    SDL_free(filename);
+    if (!SDLTest_AssertCheck(document != NULL,
+                             "IMG_LoadSVGDocument_IO should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+    SDLTest_AssertCheck(IMG_GetSVGDocumentSize(document, &width, &height) && width == 32.0f && height == 32.0f,
+                        "Document size should be 32x32, got %gx%g", width, height);
+
+    small = IMG_RasterizeSVG(document, 32, 32);
+    if (SDLTest_AssertCheck(small != NULL,
+                            "IMG_RasterizeSVG at 32x32 should succeed (%s)",
+                            SDL_GetError())) {
+        SDLTest_AssertCheck(small->w == 32 && small->h == 32,
+                            "Surface should be 32x32, got %dx%d", small->w, small->h);
+    }
+
+    /* The height follows the aspect ratio of the image */
+    large = IMG_RasterizeSVG(document, 64, 0);
+    if (SDLTest_AssertCheck(large != NULL,
+                            "IMG_RasterizeSVG at 64x0 should succeed (%s)",
+                            SDL_GetError())) {
+        SDLTest_AssertCheck(large->w == 64 && large->h == 64,
+                            "Surface should be 64x64, got %dx%d", large->w, large->h);
+        if (SDLTest_AssertCheck(loaded != NULL,
+                                "IMG_LoadSizedSVG_IO should succeed (%s)",
+                                SDL_GetError())) {
+            SDLTest_AssertCheck(SDLTest_CompareSurfaces(large, loaded, 0) == 0,
+                                "Rasterizing the document should match IMG_LoadSizedSVG_IO");
+        }
+    }
+    result = TEST_COMPLETED;
+
+done:
+    SDL_DestroySurface(loaded);
+    SDL_DestroySurface(large);
+    SDL_DestroySurface(small);
+    IMG_FreeSVGDocument(document);
+    return result;
+#else
+    (void)document;
+    (void)small;
+    (void)large;
+    (void)loaded;
+    (void)filename;
+    (void)width;
+    (void)height;
+    (void)result;
+    SDLTest_Log("SVG loading is not supported");
+    return TEST_SKIPPED;
+#endif
+}
+
+/* Rasterize part of an SVG image and compare it with the same part of the
+ * whole image, rasterized at the same scale.
+ */
+static int SDLCALL
+TestSVGRegion(void *arg)
+{
+    IMG_SVGDocument *document = NULL;
+    SDL_Surface *full = NULL;
+    SDL_Surface *region = NULL;
+    SDL_Surface *crop = NULL;
+    char *filename;
+    int result = TEST_ABORTED;
+    (void)arg;
+
+#ifdef LOAD_SVG
+    filename = GetTestFilename(TEST_FILE_DIST, "svg.svg");
+    if (!SDLTest_AssertCheck(filename != NULL,
+                             "Building filename should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+    document = IMG_LoadSVGDocument_IO(SDL_IOFromFile(filename, "rb"), true);
+    SDL_free(filename);
+    if (!SDLTest_AssertCheck(document != NULL,
+                             "IMG_LoadSVGDocument_IO should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+
+    /* The image is 32x32 units, so this is a 2x scale */
+    full = IMG_RasterizeSVG(document, 64, 64);
+    if (!SDLTest_AssertCheck(full != NULL,
+                             "IMG_RasterizeSVG should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+    region = IMG_RasterizeSVGRegion(document, 4.0f, 8.0f, 2.0f, 40, 24);
+    if (!SDLTest_AssertCheck(region != NULL,
+                             "IMG_RasterizeSVGRegion should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+    if (!SDLTest_AssertCheck(region->w == 40 && region->h == 24 && region->format == full->format,
+                             "Region should be 40x24 %s, got %dx%d %s",
+                             SDL_GetPixelFormatName(full->format),
+                             region->w, region->h, SDL_GetPixelFormatName(region->format))) {
+        goto done;
+    }
+
+    crop = SDL_CreateSurfaceFrom(40, 24, full->format,
+                                 (Uint8 *)full->pixels + 16 * full->pitch + 8 * SDL_BYTESPERPIXEL(full->format),
+                                 full->pitch);
+    if (!SDLTest_AssertCheck(crop != NULL,
+                             "Cropping the full image should succeed (%s)",
+                             SDL_GetError())) {
+        goto done;
+    }
+    SDLTest_AssertCheck(SDLTest_CompareSurfaces(region, crop, 0) == 0,
+                        "The region should match the same part of the full image");
+    result = TEST_COMPLETED;
+
+done:
+    SDL_DestroySurface(crop);
+    SDL_DestroySurface(region);
+    SDL_DestroySurface(full);
+    IMG_FreeSVGDocument(document);
+    return result;
+#else
+    (void)document;
+    (void)full;
+    (void)region;
+    (void)crop;
+    (void)filename;
+    (void)result;
+    SDLTest_Log("SVG loading is not supported");
+    return TEST_SKIPPED;
+#endif
+}
+
 static const SDLTest_TestCaseReference formatsTestCase = {
     TestFormats, "Images", "Load and save various image formats", TEST_ENABLED
 };
 
+static const SDLTest_TestCaseReference jxlLosslessSaveTestCase = {
+    TestJXLLosslessSave, "JXLLosslessSave", "Save JXL images losslessly and load them back", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference webpIncrementalTestCase = {
+    TestWEBPIncremental, "WEBPIncremental", "Decode a WEBP image from small chunks of data", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference jpgThumbnailTestCase = {
+    TestJPGThumbnail, "JPGThumbnail", "Load the EXIF thumbnail of a JPEG image", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference tifPagesTestCase = {
+    TestTIFPages, "TIFPages", "Count and load the pages of a TIFF image", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference svgDocumentTestCase = {
+    TestSVGDocument, "SVGDocument", "Rasterize a parsed SVG image at several sizes", TEST_ENABLED
+};
+
+static const SDLTest_TestCaseReference svgRegionTestCase = {
+    TestSVGRegion, "SVGRegion", "Rasterize part of an SVG image", TEST_ENABLED
+};
+
 static const SDLTest_TestCaseReference *testCases[] =  {
     &formatsTestCase,
+    &jxlLosslessSaveTestCase,
+    &webpIncrementalTestCase,
+    &jpgThumbnailTestCase,
+    &tifPagesTestCase,
+    &svgDocumentTestCase,
+    &svgRegionTestCase,
     NULL
 };
 static SDLTest_TestSuiteReference testSuite = {